@@ -887,4 +887,97 @@ int32_t store_i64i64i64( AccountName scope, TableName table, const void* data, u
 int32_t update_i64i64i64( AccountName scope, TableName table, const void* data, uint32_t len );
 
 ///@}  dbi64i64i64
+
+/**
+ *  @defgroup dbcursor Table Cursors
+ *  @brief Walk a table in index order without searching for each record again
+ *  @ingroup databaseC
+ *
+ *  The next and previous functions of each table type look up the record passed to them before stepping from it,
+ *  so a scan over a table costs one search of the whole database index per record. A cursor remembers where it is
+ *  and steps to the neighbouring record directly.
+ *
+ *  A cursor is opened with one of the cursor_lower_bound functions, which take the same arguments as the
+ *  matching lower_bound function, and stays valid until it is closed or the message handler returns. If the
+ *  record under a cursor is removed, the next step moves to the record which followed or preceded it.
+ *
+ *  Example:
+ *  @code
+ *  Order order;
+ *  order.id = 0;
+ *  int32_t cursor = cursor_lower_bound_i64( currentCode(), currentCode(), N(orders), &order, sizeof(Order) );
+ *  if( cursor >= 0 ) {
+ *     int32_t len = cursor_read( cursor, &order, sizeof(Order) );
+ *     while( len >= 0 ) {
+ *        // ... use order
+ *        len = cursor_next( cursor, &order, sizeof(Order) );
+ *     }
+ *     cursor_close( cursor );
+ *  }
+ *  @endcode
+ *  @{
+ */
+
+/**
+ *  @param scope - the account scope that will be read, must exist in the transaction scopes list
+ *  @param code  - identifies the code that controls write-access to the data
+ *  @param table - the ID/name of the table within the scope/code context to query
+ *  @param data  - must be initialized with the key to find the lower bound of
+ *  @param datalen - the length of data, must be at least sizeof(uint64_t)
+ *
+ *  @return a cursor on the lower bound, or -1 if there is no record at or after the key
+ */
+int32_t cursor_lower_bound_i64( AccountName scope, AccountName code, TableName table, void* data, uint32_t datalen );
+
+/// Opens a cursor on the lower bound of the primary key; see @ref cursor_lower_bound_i64
+int32_t cursor_lower_bound_primary_i128i128( AccountName scope, AccountName code, TableName table, void* data, uint32_t len );
+/// Opens a cursor on the lower bound of the secondary key; see @ref cursor_lower_bound_i64
+int32_t cursor_lower_bound_secondary_i128i128( AccountName scope, AccountName code, TableName table, void* data, uint32_t len );
+/// Opens a cursor on the lower bound of the primary key; see @ref cursor_lower_bound_i64
+int32_t cursor_lower_bound_primary_i64i64i64( AccountName scope, AccountName code, TableName table, void* data, uint32_t len );
+/// Opens a cursor on the lower bound of the secondary key; see @ref cursor_lower_bound_i64
+int32_t cursor_lower_bound_secondary_i64i64i64( AccountName scope, AccountName code, TableName table, void* data, uint32_t len );
+/// Opens a cursor on the lower bound of the tertiary key; see @ref cursor_lower_bound_i64
+int32_t cursor_lower_bound_tertiary_i64i64i64( AccountName scope, AccountName code, TableName table, void* data, uint32_t len );
+
+/**
+ *  @param cursor - a cursor returned by one of the cursor_lower_bound functions
+ *  @param data - location to copy the record the cursor is on
+ *  @param datalen - the maximum length of data to read, must be at least the size of the table's keys
+ *
+ *  @return the number of bytes read, -1 if the cursor has stepped out of the table, or -2 if the record the cursor
+ *  is on was removed; after -2, cursor_next and cursor_previous move to the records on either side of it
+ */
+int32_t cursor_read( int32_t cursor, void* data, uint32_t datalen );
+
+/**
+ *  Moves the cursor to the next record and reads it.
+ *
+ *  @param cursor - a cursor returned by one of the cursor_lower_bound functions
+ *  @param data - location to copy the next record
+ *  @param datalen - the maximum length of data to read, must be at least the size of the table's keys
+ *
+ *  @return the number of bytes read or -1 if there is no next record
+ */
+int32_t cursor_next( int32_t cursor, void* data, uint32_t datalen );
+
+/**
+ *  Moves the cursor to the previous record and reads it.
+ *
+ *  @param cursor - a cursor returned by one of the cursor_lower_bound functions
+ *  @param data - location to copy the previous record
+ *  @param datalen - the maximum length of data to read, must be at least the size of the table's keys
+ *
+ *  @return the number of bytes read or -1 if there is no previous record
+ */
+int32_t cursor_previous( int32_t cursor, void* data, uint32_t datalen );
+
+/**
+ *  Releases a cursor so its handle may be reused.
+ *
+ *  @param cursor - a cursor returned by one of the cursor_lower_bound functions
+ */
+void cursor_close( int32_t cursor );
+
+///@}  dbcursor
 }
@@ -44,7 +44,7 @@ extern "C" {
 
   /**
    * Get the result of addition between two double interpreted as 64 bit unsigned integer
-   * This function will first reinterpret_cast both inputs to double (50 decimal digit precision), add them together, and reinterpret_cast the result back to 64 bit unsigned integer.
+   * This function will first reinterpret_cast both inputs to double, add them together with IEEE-754 round to nearest even, and reinterpret_cast the result back to 64 bit unsigned integer.
    * @brief Addition between two double
    * @param a Value in double interpreted as 64 bit unsigned integer
    * @param b Value in double interpreted as 64 bit unsigned integer
@@ -60,9 +60,24 @@ extern "C" {
    */
   uint64_t double_add(uint64_t a, uint64_t b);
 
+  /**
+   * Get the result of subtraction between two double interpreted as 64 bit unsigned integer
+   * @brief Subtraction between two double
+   * @param a Value in double interpreted as 64 bit unsigned integer
+   * @param b Value in double interpreted as 64 bit unsigned integer, subtracted from a
+   * @return Result of subtraction reinterpret_cast to 64 bit unsigned integers
+   *
+   * Example:
+   * @code
+   * uint64_t res = double_sub( i64_to_double(5), i64_to_double(2) );
+   * printd(res); // Output: 3
+   * @endcode
+   */
+  uint64_t double_sub(uint64_t a, uint64_t b);
+
   /**
    * Get the result of multiplication between two double interpreted as 64 bit unsigned integer
-   * This function will first reinterpret_cast both inputs to double (50 decimal digit precision), multiply them together, and reinterpret_cast the result back to 64 bit unsigned integer.
+   * This function will first reinterpret_cast both inputs to double, multiply them together with IEEE-754 round to nearest even, and reinterpret_cast the result back to 64 bit unsigned integer.
    * @brief Multiplication between two double
    * @param a Value in double interpreted as 64 bit unsigned integer
    * @param b Value in double interpreted as 64 bit unsigned integer
@@ -80,7 +95,7 @@ extern "C" {
 
   /**
    * Get the result of division between two double interpreted as 64 bit unsigned integer
-   * This function will first reinterpret_cast both inputs to double (50 decimal digit precision), divide numerator with denominator, and reinterpret_cast the result back to 64 bit unsigned integer.
+   * This function will first reinterpret_cast both inputs to double, divide numerator with denominator with IEEE-754 round to nearest even, and reinterpret_cast the result back to 64 bit unsigned integer.
    * Throws an error if b is zero (after it is reinterpret_cast to double)
    * @brief Division between two double
    * @param a Numerator in double interpreted as 64 bit unsigned integer
@@ -95,9 +110,41 @@ extern "C" {
    */
   uint64_t double_div(uint64_t a, uint64_t b);
 
+  /**
+   * Get the square root of a double interpreted as 64 bit unsigned integer
+   * The square root of a negative number is NaN, and the square root of -0 is -0.
+   * @brief Square root of a double
+   * @param a Value in double interpreted as 64 bit unsigned integer
+   * @return Square root reinterpret_cast to 64 bit unsigned integers
+   *
+   * Example:
+   * @code
+   * uint64_t res = double_sqrt( i64_to_double(9) );
+   * printd(res); // Output: 3
+   * @endcode
+   */
+  uint64_t double_sqrt(uint64_t a);
+
+  /**
+   * Get the result of a * b + c for doubles interpreted as 64 bit unsigned integer, rounded only once
+   * Negate c by flipping its sign bit to get a fused multiply-subtract.
+   * @brief Fused multiply-add of three double
+   * @param a Value in double interpreted as 64 bit unsigned integer
+   * @param b Value in double interpreted as 64 bit unsigned integer
+   * @param c Value in double interpreted as 64 bit unsigned integer
+   * @return Result of a * b + c reinterpret_cast to 64 bit unsigned integers
+   *
+   * Example:
+   * @code
+   * uint64_t res = double_fma( i64_to_double(2), i64_to_double(3), i64_to_double(4) );
+   * printd(res); // Output: 10
+   * @endcode
+   */
+  uint64_t double_fma(uint64_t a, uint64_t b, uint64_t c);
+
   /**
    * Get the result of less than comparison between two double
-   * This function will first reinterpret_cast both inputs to double (50 decimal digit precision) before doing the less than comparison.
+   * This function will first reinterpret_cast both inputs to double before doing the less than comparison. Comparisons involving NaN are false.
    * @brief Less than comparison between two double
    * @param a Value in double interpreted as 64 bit unsigned integer
    * @param b Value in double interpreted as 64 bit unsigned integer
@@ -113,9 +160,18 @@ extern "C" {
    */
   uint32_t double_lt(uint64_t a, uint64_t b);
 
+  /**
+   * Get the result of less than or equal comparison between two double
+   * @brief Less than or equal comparison between two double
+   * @param a Value in double interpreted as 64 bit unsigned integer
+   * @param b Value in double interpreted as 64 bit unsigned integer
+   * @return 1 if first input is smaller than or equal to second input, 0 otherwise
+   */
+  uint32_t double_le(uint64_t a, uint64_t b);
+
   /**
    * Get the result of equality check between two double
-   * This function will first reinterpret_cast both inputs to double (50 decimal digit precision) before doing equality check.
+   * This function will first reinterpret_cast both inputs to double before doing equality check. NaN is not equal to anything, and -0 is equal to 0.
    * @brief Equality check between two double
    * @param a Value in double interpreted as 64 bit unsigned integer
    * @param b Value in double interpreted as 64 bit unsigned integer
@@ -133,7 +189,7 @@ extern "C" {
 
   /**
    * Get the result of greater than comparison between two double
-   * This function will first reinterpret_cast both inputs to double (50 decimal digit precision) before doing the greater than comparison.
+   * This function will first reinterpret_cast both inputs to double before doing the greater than comparison. Comparisons involving NaN are false.
    * @brief Greater than comparison between two double
    * @param a Value in double interpreted as 64 bit unsigned integer
    * @param b Value in double interpreted as 64 bit unsigned integer
@@ -149,9 +205,18 @@ extern "C" {
    */
   uint32_t double_gt(uint64_t a, uint64_t b);
 
+  /**
+   * Get the result of greater than or equal comparison between two double
+   * @brief Greater than or equal comparison between two double
+   * @param a Value in double interpreted as 64 bit unsigned integer
+   * @param b Value in double interpreted as 64 bit unsigned integer
+   * @return 1 if first input is greater than or equal to second input, 0 otherwise
+   */
+  uint32_t double_ge(uint64_t a, uint64_t b);
+
   /**
    * Convert double (interpreted as 64 bit unsigned  integer) to 64 bit unsigned integer.
-   * This function will first reinterpret_cast the input to double (50 decimal digit precision) then convert it to double, then reinterpret_cast it to 64 bit unsigned integer.
+   * This function will first reinterpret_cast the input to double, then truncate its magnitude to a 64 bit unsigned integer, modulo 2^64. Infinities and magnitudes of 2^168 or more give the largest 64 bit unsigned integer, and NaN throws.
    * @brief Convert double to 64 bit unsigned integer
    * @param self Value in double interpreted as 64 bit unsigned integer
    * @return Result of conversion in 64 bit unsigned integer
@@ -167,7 +232,7 @@ extern "C" {
 
   /**
    * Convert 64 bit unsigned integer to double (interpreted as 64 bit unsigned integer).
-   * This function will convert the input to double (50 decimal digit precision) then reinterpret_cast it to 64 bit unsigned integer.
+   * This function will convert the input to the nearest double then reinterpret_cast it to 64 bit unsigned integer.
    * @brief Convert 64 bit unsigned integer to double (interpreted as 64 bit unsigned  integer)
    * @param self Value to be converted
    * @return Result of conversion in double (interpreted as 64 bit unsigned integer)
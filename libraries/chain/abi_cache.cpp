@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/abi_cache.hpp>
+
+namespace eos { namespace chain {
+
+abi_cache::abi_cache(uint32_t max_size)
+   : _max_size(max_size) {}
+
+std::shared_ptr<const abi_cache::cached_abi> abi_cache::get(const account_object& account) {
+   if (account.abi.size() <= 4) /// 4 == packsize of empty Abi
+      return nullptr;
+
+   {
+      std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+      const auto& by_account = _entries.get<by_name>();
+      auto itr = by_account.find(account.name);
+      if (itr != by_account.end() && itr->abi_version == account.abi_version)
+         return itr->value;
+   }
+
+   // Build outside of the lock; if two threads race on the same account they build the same serializer
+   types::Abi abi;
+   fc::datastream<const char*> ds(account.abi.data(), account.abi.size());
+   fc::raw::unpack(ds, abi);
+   auto value = std::make_shared<const cached_abi>(std::move(abi));
+
+   std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+   auto& by_account = _entries.get<by_name>();
+   auto itr = by_account.find(account.name);
+   if (itr != by_account.end())
+      by_account.erase(itr);
+
+   _entries.emplace_back(entry{account.name, account.abi_version, value});
+   while (_entries.size() > _max_size)
+      _entries.pop_front();
+   return value;
+}
+
+size_t abi_cache::size()const {
+   std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+   return _entries.size();
+}
+
+void abi_cache::clear() {
+   std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+   _entries.clear();
+}
+
+} } // eos::chain
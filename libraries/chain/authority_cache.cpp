@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/authority_cache.hpp>
+
+namespace eos { namespace chain {
+
+std::shared_ptr<const resolved_authority> authority_cache::get(const chainbase::database& db,
+                                                               const types::AccountPermission& permission) {
+   permission_key key(permission.account, permission.permission);
+   {
+      std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+      auto itr = _entries.find(key);
+      if (itr != _entries.end())
+         return itr->second;
+   }
+
+   // Resolve outside of the lock; if two threads race on the same permission they resolve the same authority
+   const auto& object = db.get<permission_object, by_owner>(boost::make_tuple(permission.account,
+                                                                               permission.permission));
+   auto value = std::make_shared<const resolved_authority>(object.auth);
+
+   std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+   _entries[key] = value;
+   return value;
+}
+
+void authority_cache::invalidate(const types::AccountPermission& permission) {
+   std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+   _entries.erase(permission_key(permission.account, permission.permission));
+}
+
+size_t authority_cache::size()const {
+   std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+   return _entries.size();
+}
+
+void authority_cache::clear() {
+   std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+   _entries.clear();
+}
+
+} } // eos::chain
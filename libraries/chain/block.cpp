@@ -60,55 +60,30 @@ namespace eos { namespace chain {
       return signee() == expected_signee;
    }
 
-   digest_type merkle(vector<digest_type> ids) {
-      while (ids.size() > 1) {
-         if (ids.size() % 2)
-            ids.push_back(ids.back());
-         for (int i = 0; i < ids.size() / 2; ++i)
-            ids[i/2] = digest_type::hash(std::make_pair(ids[i], ids[i+1]));
-         ids.resize(ids.size() / 2);
-      }
-
-      return ids.front();
-   }
-
    checksum_type signed_block::calculate_merkle_root()const
    {
-      if(cycles.empty())
-         return checksum_type();
-
-      vector<digest_type> ids;
+      incremental_merkle transactions;
       for (const auto& cycle : cycles)
          for (const auto& thread : cycle)
-            ids.emplace_back(thread.merkle_digest());
-
-/**
- *  Suggest moving thread::merkle_digest code to return vector of ids which get added to ids above and then calculating root over all
- */
-#warning TODO  The merkle root needs to be over all transactions, but this is currently hashing all threads merkle roots which will make proofs O(N) rather than O( LOG(N) )
-
-      /**
-       *  This may require passing 
-       */
-#warning TODO  Add global incremental block header merkle   https://github.com/EOSIO/eos/issues/8
+            thread.append_merkle_leaves(transactions);
 
-      return checksum_type::hash(merkle(ids));
+      return merkle_root_of(transactions);
    }
 
-   digest_type thread::merkle_digest() const {
-      vector<digest_type> ids;// = generated_input;
-      /*
-      ids.reserve( ids.size() + user_input.size() + output_transactions.size() );
-      */
-
-      for( const auto& trx : user_input )
-         ids.push_back( transaction_digest(trx) );
+   checksum_type signed_block::merkle_root_of(const incremental_merkle& transactions)
+   {
+      if (transactions.leaf_count() == 0)
+         return checksum_type();
 
-      for( const auto& trx : generated_input )
-         ids.push_back( trx.id );
+      return checksum_type::hash(transactions.get_root());
+   }
 
+   void thread::append_merkle_leaves(incremental_merkle& merkle) const {
+      for (const auto& trx : user_input)
+         merkle.append(transaction_digest(trx));
 
-      return merkle(ids);
+      for (const auto& trx : generated_input)
+         merkle.append(trx.id);
    }
 
 } }
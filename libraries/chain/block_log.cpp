@@ -1,61 +1,119 @@
 #include <eos/chain/block_log.hpp>
+#include <atomic>
 #include <fstream>
+#include <mutex>
 #include <fc/io/raw.hpp>
 
-#define LOG_READ  (std::ios::in | std::ios::binary)
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #define LOG_WRITE (std::ios::out | std::ios::binary | std::ios::app)
 
 namespace eos { namespace chain {
 
    namespace detail {
+      namespace bip = boost::interprocess;
+
+      /**
+       * A read only mapping of a whole file, as large as the file was when the mapping was made. Later appends to
+       * the file do not affect an existing mapping, they are picked up by mapping the file again.
+       */
+      struct mapped_file {
+         explicit mapped_file(const fc::path& path)
+            : file(path.generic_string().c_str(), bip::read_only), region(file, bip::read_only) {}
+
+         const char* data()const { return static_cast<const char*>(region.get_address()); }
+         uint64_t    size()const { return region.get_size(); }
+
+         uint64_t read_position(uint64_t offset)const {
+            FC_ASSERT(offset + sizeof(uint64_t) <= size(), "Read past the end of the block log",
+                      ("offset", offset)("size", size()));
+            uint64_t pos;
+            memcpy(&pos, data() + offset, sizeof(pos));
+            return pos;
+         }
+
+         bip::file_mapping  file;
+         bip::mapped_region region;
+      };
+      using mapped_file_ptr = std::shared_ptr<const mapped_file>;
+
       class block_log_impl {
          public:
             optional<signed_block>   head;
             block_id_type            head_id;
-            std::fstream             block_stream;
-            std::fstream             index_stream;
+            std::ofstream            block_stream;
+            std::ofstream            index_stream;
             fc::path                 block_file;
             fc::path                 index_file;
-            bool                     block_write;
-            bool                     index_write;
-
-            inline void check_block_read() {
-               if (block_write) {
-                  block_stream.close();
-                  block_stream.open(block_file.generic_string().c_str(), LOG_READ);
-                  block_write = false;
-               }
+
+            /// Number of bytes appended to each file, including any not yet flushed from the streams
+            uint64_t                 block_size = 0;
+            uint64_t                 index_size = 0;
+
+            /// Number of blocks in the log, published once a block and its index entry have been written; lets
+            /// readers check a block number without taking the mutex
+            std::atomic<uint32_t>    block_count{0};
+
+            /// Guards the streams, the sizes and the current mappings
+            std::mutex               mutex;
+            mapped_file_ptr          block_map;
+            mapped_file_ptr          index_map;
+
+            /// Mappings of both files covering the first count blocks, taken together so that later appends cannot
+            /// change the blocks they describe
+            struct view {
+               mapped_file_ptr blocks;
+               mapped_file_ptr index;
+               uint32_t        count = 0;
+               /// Bytes of blocks.log holding those blocks
+               uint64_t        block_size = 0;
+            };
+
+            view snapshot() {
+               std::lock_guard<std::mutex> lock(mutex);
+               view v;
+               v.count = block_count.load(std::memory_order_relaxed);
+               v.block_size = block_size;
+               v.blocks = remap(block_map, block_stream, block_file, block_size);
+               v.index = remap(index_map, index_stream, index_file, index_size);
+               return v;
             }
 
-            inline void check_block_write() {
-               if (!block_write) {
-                  block_stream.close();
-                  block_stream.open(block_file.generic_string().c_str(), LOG_WRITE);
-                  block_write = true;
-               }
+            /// @return a mapping of blocks.log covering every block appended so far, or null if there are none
+            mapped_file_ptr blocks() {
+               std::lock_guard<std::mutex> lock(mutex);
+               return remap(block_map, block_stream, block_file, block_size);
             }
 
-            inline void check_index_read() {
-               try {
-                  if (index_write) {
-                     index_stream.close();
-                     index_stream.open(index_file.generic_string().c_str(), LOG_READ);
-                     index_write = false;
-                  }
-               }
-               FC_LOG_AND_RETHROW()
+            /// @return a mapping of blocks.index covering every block appended so far, or null if there are none
+            mapped_file_ptr index() {
+               std::lock_guard<std::mutex> lock(mutex);
+               return remap(index_map, index_stream, index_file, index_size);
             }
 
-            inline void check_index_write() {
-               if (!index_write) {
-                  index_stream.close();
-                  index_stream.open(index_file.generic_string().c_str(), LOG_WRITE);
-                  index_write = true;
+         private:
+            static const mapped_file_ptr& remap(mapped_file_ptr& current, std::ofstream& stream, const fc::path& path,
+                                                uint64_t size) {
+               if (size == 0)
+                  current.reset();
+               else if (!current || current->size() < size) {
+                  // Readers holding the old mapping keep it alive until they are done with it
+                  stream.flush();
+                  current = std::make_shared<mapped_file>(path);
                }
+               return current;
             }
       };
    }
 
+   signed_block block_log::packed_block::unpack()const {
+      signed_block result;
+      fc::datastream<const char*> ds(data, size);
+      fc::raw::unpack(ds, result);
+      return result;
+   }
+
    block_log::block_log(const fc::path& data_dir)
    :my(new detail::block_log_impl()) {
       my->block_stream.exceptions(std::fstream::failbit | std::fstream::badbit);
@@ -79,6 +137,8 @@ namespace eos { namespace chain {
          my->block_stream.close();
       if (my->index_stream.is_open())
          my->index_stream.close();
+      my->block_map.reset();
+      my->index_map.reset();
 
       if (!fc::is_directory(data_dir))
          fc::create_directories(data_dir);
@@ -88,8 +148,6 @@ namespace eos { namespace chain {
       ilog("Opening block log at ${path}", ("path", my->block_file.generic_string()));
       my->block_stream.open(my->block_file.generic_string().c_str(), LOG_WRITE);
       my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
-      my->block_write = true;
-      my->index_write = true;
 
       /* On startup of the block log, there are several states the log file and the index file can be
        * in relation to eachother.
@@ -109,26 +167,22 @@ namespace eos { namespace chain {
        *  - If the index file head is not in the log file, delete the index and replay.
        *  - If the index file head is in the log, but not up to date, replay from index head.
        */
-      auto log_size = fc::file_size(my->block_file);
-      auto index_size = fc::file_size(my->index_file);
+      my->block_size = fc::file_size(my->block_file);
+      my->index_size = fc::file_size(my->index_file);
 
-      if (log_size) {
+      my->block_count = 0;
+      if (my->block_size) {
          ilog("Log is nonempty");
          my->head = read_head();
          my->head_id = my->head->id();
+         my->block_count = my->head->block_num();
 
-         if (index_size) {
-            my->check_block_read();
-            my->check_index_read();
-
+         if (my->index_size) {
             ilog("Index is nonempty");
-            uint64_t block_pos;
-            my->block_stream.seekg(-sizeof(uint64_t), std::ios::end);
-            my->block_stream.read((char*)&block_pos, sizeof(block_pos));
-
-            uint64_t index_pos;
-            my->index_stream.seekg(-sizeof(uint64_t), std::ios::end);
-            my->index_stream.read((char*)&index_pos, sizeof(index_pos));
+            auto blocks = my->blocks();
+            auto index = my->index();
+            uint64_t block_pos = blocks->read_position(blocks->size() - sizeof(uint64_t));
+            uint64_t index_pos = index->read_position(index->size() - sizeof(uint64_t));
 
             if (block_pos < index_pos) {
                ilog("block_pos < index_pos, close and reopen index_stream");
@@ -141,31 +195,33 @@ namespace eos { namespace chain {
             ilog("Index is empty");
             construct_index();
          }
-      } else if (index_size) {
+      } else if (my->index_size) {
          ilog("Index is nonempty, remove and recreate it");
          my->index_stream.close();
          fc::remove_all(my->index_file);
          my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
-         my->index_write = true;
+         my->index_size = 0;
       }
    }
 
    uint64_t block_log::append(const signed_block& b) {
       try {
-         my->check_block_write();
-         my->check_index_write();
+         std::lock_guard<std::mutex> lock(my->mutex);
 
-         uint64_t pos = my->block_stream.tellp();
-         FC_ASSERT(my->index_stream.tellp() == sizeof(uint64_t) * (b.block_num() - 1),
+         uint64_t pos = my->block_size;
+         FC_ASSERT(my->index_size == sizeof(uint64_t) * (b.block_num() - 1),
                    "Append to index file occuring at wrong position.",
-                   ("position", (uint64_t) my->index_stream.tellp())
+                   ("position", my->index_size)
                    ("expected", (b.block_num() - 1) * sizeof(uint64_t)));
          auto data = fc::raw::pack(b);
          my->block_stream.write(data.data(), data.size());
          my->block_stream.write((char*)&pos, sizeof(pos));
          my->index_stream.write((char*)&pos, sizeof(pos));
+         my->block_size += data.size() + sizeof(pos);
+         my->index_size += sizeof(pos);
          my->head = b;
          my->head_id = b.id();
+         my->block_count.store(b.block_num(), std::memory_order_release);
 
          return pos;
       }
@@ -173,26 +229,27 @@ namespace eos { namespace chain {
    }
 
    void block_log::flush() {
+      std::lock_guard<std::mutex> lock(my->mutex);
       my->block_stream.flush();
       my->index_stream.flush();
    }
 
    std::pair<signed_block, uint64_t> block_log::read_block(uint64_t pos)const {
-      my->check_block_read();
+      auto blocks = my->blocks();
+      FC_ASSERT(blocks && pos < blocks->size(), "Position is past the end of the block log", ("pos", pos));
 
-      my->block_stream.seekg(pos);
+      fc::datastream<const char*> ds(blocks->data() + pos, blocks->size() - pos);
       std::pair<signed_block,uint64_t> result;
-      fc::raw::unpack(my->block_stream, result.first);
-      result.second = uint64_t(my->block_stream.tellg()) + 8;
+      fc::raw::unpack(ds, result.first);
+      result.second = pos + ds.tellp() + 8;
       return result;
    }
 
    optional<signed_block> block_log::read_block_by_num(uint32_t block_num)const {
       try {
          optional<signed_block> b;
-         uint64_t pos = get_block_pos(block_num);
-         if (pos != npos) {
-            b = read_block(pos).first;
+         if (auto packed = read_packed_block_by_num(block_num)) {
+            b = packed->unpack();
             FC_ASSERT(b->block_num() == block_num,
                       "Wrong block was read from block log.", ("returned", b->block_num())("expected", block_num));
          }
@@ -200,30 +257,44 @@ namespace eos { namespace chain {
       } FC_LOG_AND_RETHROW()
    }
 
-   uint64_t block_log::get_block_pos(uint32_t block_num) const {
-      my->check_index_read();
+   optional<block_log::packed_block> block_log::read_packed_block_by_num(uint32_t block_num)const {
+      // Both ends of the block are looked up in the same view, so a block appended in between cannot move the end
+      auto view = my->snapshot();
+      if (block_num == 0 || block_num > view.count)
+         return {};
+
+      uint64_t pos = view.index->read_position(sizeof(uint64_t) * (block_num - 1));
+      // Every block is followed by its position, and the next block (or the end of the view) follows that
+      uint64_t end = view.block_size;
+      if (block_num < view.count)
+         end = view.index->read_position(sizeof(uint64_t) * block_num);
+      end -= sizeof(uint64_t);
+      FC_ASSERT(pos <= end && end <= view.blocks->size(), "Block log index is inconsistent with the log",
+                ("block_num", block_num)("pos", pos)("end", end));
+
+      packed_block result;
+      result.data = view.blocks->data() + pos;
+      result.size = end - pos;
+      result.mapping = view.blocks;
+      return result;
+   }
 
-      if (!(my->head.valid() && block_num <= block_header::num_from_id(my->head_id) && block_num > 0))
+   uint64_t block_log::get_block_pos(uint32_t block_num) const {
+      // The index entry of every counted block has been written, so the mapping taken afterwards covers it
+      if (block_num == 0 || block_num > my->block_count.load(std::memory_order_acquire))
          return npos;
-      my->index_stream.seekg(sizeof(uint64_t) * (block_num - 1));
-      uint64_t pos;
-      my->index_stream.read((char*)&pos, sizeof(pos));
-      return pos;
+      auto index = my->index();
+      return index->read_position(sizeof(uint64_t) * (block_num - 1));
    }
 
    optional<signed_block> block_log::read_head()const {
-      my->check_block_read();
-
-      uint64_t pos;
+      auto blocks = my->blocks();
 
       // Check that the file is not empty
-      my->block_stream.seekg(0, std::ios::end);
-      if (my->block_stream.tellg() <= sizeof(pos))
+      if (!blocks || blocks->size() <= sizeof(uint64_t))
          return {};
 
-      my->block_stream.seekg(-sizeof(pos), std::ios::end);
-      my->block_stream.read((char*)&pos, sizeof(pos));
-      return read_block(pos).first;
+      return read_block(blocks->read_position(blocks->size() - sizeof(uint64_t))).first;
    }
 
    const optional<signed_block>& block_log::head()const {
@@ -235,22 +306,20 @@ namespace eos { namespace chain {
       my->index_stream.close();
       fc::remove_all(my->index_file);
       my->index_stream.open(my->index_file.generic_string().c_str(), LOG_WRITE);
-      my->index_write = true;
-
-      uint64_t pos = 0;
-      uint64_t end_pos;
-      my->check_block_read();
+      my->index_size = 0;
+      my->index_map.reset();
 
-      my->block_stream.seekg(-sizeof( uint64_t), std::ios::end);
-      my->block_stream.read((char*)&end_pos, sizeof(end_pos));
+      auto blocks = my->blocks();
+      uint64_t end_pos = blocks->read_position(blocks->size() - sizeof(uint64_t));
+      fc::datastream<const char*> ds(blocks->data(), blocks->size());
       signed_block tmp;
 
-      my->block_stream.seekg(pos);
-
+      uint64_t pos = 0;
       while (pos < end_pos) {
-         fc::raw::unpack(my->block_stream, tmp);
-         my->block_stream.read((char*)&pos, sizeof(pos));
+         fc::raw::unpack(ds, tmp);
+         ds.read((char*)&pos, sizeof(pos));
          my->index_stream.write((char*)&pos, sizeof(pos));
+         my->index_size += sizeof(pos);
       }
    }
 } }
@@ -24,6 +24,10 @@
 #include <eos/chain/block_schedule.hpp>
 #include <eos/chain/block.hpp>
 
+#include <boost/range/algorithm/find.hpp>
+
+#include <unordered_map>
+
 namespace eos { namespace chain {
 
 static uint next_power_of_two(uint input) {
@@ -289,6 +293,154 @@ block_schedule block_schedule::by_cycling_conflicts(
    return from_entries(schedule);
 }
 
+struct transaction_cost_visitor : public fc::visitor<uint64_t>
+{
+   // Executing the messages dominates the cost of a transaction; every transaction costs at least one
+   template <typename T>
+   uint64_t operator()(std::reference_wrapper<const T> trx) const {
+      return std::max<uint64_t>(1, trx.get().messages.size());
+   }
+};
+
+struct account_name_hash {
+   size_t operator()(const AccountName& a) const { return account_hasher(a); }
+};
+
+// The latest accesses to a scope by the transactions scheduled so far
+struct scope_access {
+   int          write_cycle = -1;
+   uint         write_thread = 0;
+   int          read_cycle = -1;
+   vector<uint> read_threads;
+};
+
+static block_schedule schedule_by_read_write_sets(
+   const vector<pending_transaction>& transactions,
+   const global_property_object& properties,
+   const schedule_shape& shape
+   )
+{
+   FC_ASSERT(shape.max_threads_per_cycle > 0 && shape.max_cycles > 0,
+             "A block schedule needs at least one thread and one cycle", ("shape", shape));
+   auto skipper = make_skipper(properties);
+
+   // Share the work evenly between the threads of a cycle; any thread may hold the most costly transaction
+   uint64_t total_cost = 0;
+   uint64_t max_cost = 0;
+   for (const auto& t : transactions) {
+      auto cost = t.visit(transaction_cost_visitor());
+      total_cost += cost;
+      max_cost = std::max(max_cost, cost);
+   }
+   const uint64_t thread_budget = std::max(max_cost, (total_cost + shape.max_threads_per_cycle - 1) / shape.max_threads_per_cycle);
+
+   vector<vector<uint64_t>> thread_costs;
+   std::unordered_map<AccountName, scope_access, account_name_hash> accesses;
+   vector<uint> conflicting_threads;
+
+   vector<schedule_entry> schedule;
+   schedule.reserve(transactions.size());
+
+   for (const auto& t : transactions) {
+      if (skipper.should_skip(t)) {
+         continue;
+      }
+
+      auto write_scopes = t.visit(scope_extracting_visitor());
+      auto read_scopes = t.visit(readscope_extracting_visitor());
+      auto cost = t.visit(transaction_cost_visitor());
+
+      // Find the last cycle with an access this transaction has to follow, and the threads making those accesses;
+      // writes follow every earlier access to their scope, and reads follow only the earlier writes
+      int bound = -1;
+      conflicting_threads.clear();
+      auto conflict = [&](int cycle, uint thread) {
+         if (cycle > bound) {
+            bound = cycle;
+            conflicting_threads.clear();
+         }
+         if (cycle == bound && boost::find(conflicting_threads, thread) == conflicting_threads.end())
+            conflicting_threads.push_back(thread);
+      };
+      for (const auto& a : write_scopes) {
+         auto itr = accesses.find(a);
+         if (itr == accesses.end()) continue;
+         if (itr->second.write_cycle >= 0)
+            conflict(itr->second.write_cycle, itr->second.write_thread);
+         for (auto thread : itr->second.read_threads)
+            conflict(itr->second.read_cycle, thread);
+      }
+      for (const auto& a : read_scopes) {
+         auto itr = accesses.find(a);
+         if (itr != accesses.end() && itr->second.write_cycle >= 0)
+            conflict(itr->second.write_cycle, itr->second.write_thread);
+      }
+
+      // Follow a single conflicting thread in its own cycle if it has room, otherwise start in the next cycle
+      optional<std::pair<uint, uint>> placement;
+      if (conflicting_threads.size() == 1 && thread_costs[bound][conflicting_threads.front()] + cost <= thread_budget)
+         placement = std::make_pair(uint(bound), conflicting_threads.front());
+
+      for (uint cycle = bound + 1; !placement && cycle < shape.max_cycles; ++cycle) {
+         if (thread_costs.size() <= cycle) {
+            thread_costs.resize(cycle + 1);
+         }
+
+         auto& threads = thread_costs[cycle];
+         if (threads.size() < shape.max_threads_per_cycle) {
+            threads.push_back(0);
+            placement = std::make_pair(cycle, uint(threads.size() - 1));
+         } else {
+            auto least = std::min_element(threads.begin(), threads.end());
+            if (*least + cost <= thread_budget)
+               placement = std::make_pair(cycle, uint(least - threads.begin()));
+         }
+      }
+
+      // leave it for a later block rather than exceed the schedule's shape
+      if (!placement) {
+         continue;
+      }
+
+      uint cycle = placement->first;
+      uint thread = placement->second;
+      thread_costs[cycle][thread] += cost;
+      for (const auto& a : write_scopes) {
+         auto& access = accesses[a];
+         access.write_cycle = cycle;
+         access.write_thread = thread;
+      }
+      for (const auto& a : read_scopes) {
+         auto& access = accesses[a];
+         if (access.read_cycle < int(cycle)) {
+            access.read_cycle = cycle;
+            access.read_threads.assign(1, thread);
+         } else if (access.read_cycle == int(cycle) && boost::find(access.read_threads, thread) == access.read_threads.end()) {
+            access.read_threads.push_back(thread);
+         }
+      }
+
+      schedule.emplace_back(cycle, thread, t);
+      skipper.apply(t);
+   }
+
+   return from_entries(schedule);
+}
+
+block_schedule block_schedule::by_read_write_sets(
+    const vector<pending_transaction>& transactions,
+    const global_property_object& properties
+    )
+{
+   return schedule_by_read_write_sets(transactions, properties, schedule_shape());
+}
+
+block_schedule::factory block_schedule::by_read_write_sets_with(const schedule_shape& shape) {
+   return [shape](const vector<pending_transaction>& transactions, const global_property_object& properties) {
+      return schedule_by_read_write_sets(transactions, properties, shape);
+   };
+}
+
 block_schedule block_schedule::in_single_thread(
     const vector<pending_transaction>& transactions,
     const global_property_object& properties
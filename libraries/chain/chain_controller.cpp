@@ -105,6 +105,11 @@ optional<signed_block> chain_controller::fetch_block_by_number(uint32_t num)cons
    return optional<signed_block>();
 }
 
+optional<block_log::packed_block> chain_controller::fetch_packed_block_by_number(uint32_t num)const
+{
+   return _block_log.read_packed_block_by_num(num);
+}
+
 const SignedTransaction& chain_controller::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = _db.get_index<transaction_multi_index, by_trx_id>();
@@ -146,6 +151,9 @@ const GeneratedTransaction& chain_controller::get_generated_transaction( const g
  */
 bool chain_controller::push_block(const signed_block& new_block, uint32_t skip)
 { try {
+   if (!(skip & skip_transaction_signatures))
+      prevalidate_signatures(new_block);
+
    return with_skip_flags( skip, [&](){ 
       return without_pending_transactions( [&]() {
          return _db.with_write_lock( [&]() {
@@ -155,6 +163,18 @@ bool chain_controller::push_block(const signed_block& new_block, uint32_t skip)
    });
 } FC_CAPTURE_AND_RETHROW((new_block)) }
 
+void chain_controller::prevalidate_signatures(const signed_block& b)const {
+   vector<std::reference_wrapper<const SignedTransaction>> trxs;
+   for (const auto& cycle : b.cycles)
+      for (const auto& thread : cycle)
+         trxs.insert(trxs.end(), thread.user_input.begin(), thread.user_input.end());
+   _signature_cache->recover(trxs, *_workers, chain_id_type{});
+}
+
+void chain_controller::prevalidate_signatures(const vector<SignedTransaction>& trxs)const {
+   _signature_cache->recover({trxs.begin(), trxs.end()}, *_workers, chain_id_type{});
+}
+
 bool chain_controller::_push_block(const signed_block& new_block)
 { try {
    uint32_t skip = _skip_flags;
@@ -168,9 +188,32 @@ bool chain_controller::_push_block(const signed_block& new_block)
          //If the newly pushed block is the same height as head, we get head back in new_head
          //Only switch forks if new_head is actually higher than head
          if (new_head->data.block_num() > head_block_num()) {
-            wlog("Switching to fork: ${id}", ("id",new_head->data.id()));
             auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
 
+            // Both branches ending in our head means new_head builds on it, through blocks the fork database was
+            // holding until their parents arrived; apply them in order rather than switching forks
+            if (branches.first.back() == branches.second.back()) {
+               for (auto ritr = branches.first.rbegin() + 1; ritr != branches.first.rend(); ++ritr) {
+                  try {
+                     auto session = _db.start_undo_session(true);
+                     apply_block((*ritr)->data, skip);
+                     session.push();
+                  } catch (const fc::exception& e) {
+                     elog("Failed to apply buffered block:\n${e}", ("e", e.to_detail_string()));
+                     // The block's changes were undone, so authorities resolved while applying it may be stale
+                     _authority_cache->clear();
+                     // keep the blocks applied so far; the rest of the branch builds on the invalid block
+                     _fork_db.set_head(*std::prev(ritr));
+                     for (; ritr != branches.first.rend(); ++ritr)
+                        _fork_db.remove((*ritr)->data.id());
+                     throw;
+                  }
+               }
+               return false;
+            }
+
+            wlog("Switching to fork: ${id}", ("id",new_head->data.id()));
+
             // pop blocks until we hit the forked block
             while (head_block_id() != branches.second.back()->data.previous)
                pop_block();
@@ -187,6 +230,7 @@ bool chain_controller::_push_block(const signed_block& new_block)
                 catch (const fc::exception& e) { except = e; }
                 if (except) {
                    wlog("exception thrown while switching forks ${e}", ("e",except->to_detail_string()));
+                   _authority_cache->clear();
                    // remove the rest of branches.first from the fork_db, those blocks are invalid
                    while (ritr != branches.first.rend()) {
                       _fork_db.remove((*ritr)->data.id());
@@ -237,6 +281,7 @@ bool chain_controller::_push_block(const signed_block& new_block)
       session.push();
    } catch ( const fc::exception& e ) {
       elog("Failed to push new block:\n${e}", ("e", e.to_detail_string()));
+      _authority_cache->clear();
       _fork_db.remove(new_block.id());
       throw;
    }
@@ -268,11 +313,21 @@ ProcessedTransaction chain_controller::_push_transaction(const SignedTransaction
    if (!_pending_tx_session.valid())
       _pending_tx_session = _db.start_undo_session(true);
 
+   auto id = trx.id();
+   EOS_ASSERT(!_pending_transactions.contains(id), tx_duplicate, "Transaction is already pending");
+
    auto temp_session = _db.start_undo_session(true);
-   validate_referenced_accounts(trx);
-   check_transaction_authorization(trx);
-   auto pt = apply_transaction(trx);
-   _pending_transactions.push_back(trx);
+   ProcessedTransaction pt;
+   try {
+      validate_referenced_accounts(trx);
+      check_transaction_authorization(trx);
+      pt = apply_transaction(trx, id);
+   } catch (...) {
+      // temp_session undoes the transaction, including any permission it created or changed
+      _authority_cache->clear();
+      throw;
+   }
+   _pending_transactions.add(trx, id);
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -284,6 +339,73 @@ ProcessedTransaction chain_controller::_push_transaction(const SignedTransaction
    return pt;
 }
 
+/**
+ * Called once blocks have been pushed, to rebuild the pending state which was undone to apply them. The transactions
+ * the blocks included were removed from the pool as each block was applied, and expired ones are dropped here.
+ *
+ * Rather than re-applying the whole pool, only about one block's worth of transactions, taken in arrival order, is
+ * applied to the new pending state; the rest wait in the pool until a block is generated from it or they reach its
+ * front. Waiting transactions which declare a scope the blocks wrote to may have been invalidated by them, so those
+ * are checked again, without keeping their changes.
+ */
+void chain_controller::restore_pending_transactions() {
+   try {
+      with_skip_flags(skip_nothing, [&] {
+         _db.with_write_lock([&] {
+            _pending_transactions.remove_expired(head_block_time());
+            auto conflicting = _pending_transactions.take_conflicting();
+            if (_pending_transactions.empty())
+               return;
+
+            if (!_pending_tx_session.valid())
+               _pending_tx_session = _db.start_undo_session(true);
+
+            vector<transaction_id_type> invalid;
+            auto check = [&](const transaction_pool::entry& e, bool keep_changes) {
+               try {
+                  auto temp_session = _db.start_undo_session(true);
+                  validate_referenced_accounts(e.trx);
+                  check_transaction_authorization(e.trx);
+                  apply_transaction(e.trx, e.id);
+                  if (keep_changes) {
+                     temp_session.squash();
+                     return;
+                  }
+               } catch (const fc::exception& ex) {
+                  dlog("Dropping pending transaction ${id}: ${e}", ("id", e.id)("e", ex.to_string()));
+                  invalid.emplace_back(e.id);
+               }
+               // The transaction's changes were undone
+               _authority_cache->clear();
+            };
+
+            const auto max_block_size = (uint64_t)get_global_properties().configuration.maxBlockSize;
+            uint64_t applied_size = 0;
+            optional<uint64_t> last_applied;
+            _pending_transactions.visit_in_arrival_order([&](const transaction_pool::entry& e) {
+               if (applied_size + e.packed_size > max_block_size)
+                  return false;
+               applied_size += e.packed_size;
+               last_applied = e.arrival;
+               check(e, true);
+               return true;
+            });
+
+            for (const auto& id : conflicting) {
+               const auto* e = _pending_transactions.find(id);
+               if (e && !(last_applied && e->arrival <= *last_applied))
+                  check(*e, false);
+            }
+
+            for (const auto& id : invalid)
+               _pending_transactions.remove(id);
+         });
+      });
+   } catch (const fc::exception& e) {
+      elog("Failed to restore pending transactions: ${e}", ("e", e.to_detail_string()));
+   }
+}
+
 signed_block chain_controller::generate_block(
    fc::time_point_sec when,
    const AccountName& producer,
@@ -333,26 +455,35 @@ signed_block chain_controller::_generate_block(
    // re-apply pending transactions in this method.
    //
    _pending_tx_session.reset();
+   _authority_cache->clear();
    _pending_tx_session = _db.start_undo_session(true);
 
    const auto& generated = _db.get_index<generated_transaction_multi_index, generated_transaction_object::by_status>().equal_range(generated_transaction_object::PENDING);
 
    vector<pending_transaction> pending;
-   std::set<transaction_id_type> invalid_pending;
-   pending.reserve(std::distance(generated.first, generated.second) + _pending_transactions.size());
+   vector<transaction_id_type> invalid_pending;
    for (auto iter = generated.first; iter != generated.second; ++iter) {
       const auto& gt = *iter;
       pending.emplace_back(std::reference_wrapper<const GeneratedTransaction> {gt.trx});
    }
-   
-   for(const auto& st: _pending_transactions) {
-      pending.emplace_back(std::reference_wrapper<const SignedTransaction> {st});
-   }
+
+   // Anything past a full block would only be postponed by the scheduler, so leave the rest of the pool alone
+   const auto max_block_size = (uint64_t)get_global_properties().configuration.maxBlockSize;
+   uint64_t offered_size = 0;
+   _pending_transactions.visit_in_arrival_order([&](const transaction_pool::entry& e) {
+      if (offered_size + e.packed_size > max_block_size)
+         return false;
+      offered_size += e.packed_size;
+      pending.emplace_back(std::reference_wrapper<const SignedTransaction> {e.trx});
+      return true;
+   });
 
    auto schedule = scheduler(pending, get_global_properties());
 
    signed_block pending_block;
    pending_block.cycles.reserve(schedule.cycles.size());
+   // The merkle tree is built as threads are completed, from the ids computed to apply the transactions
+   incremental_merkle transaction_ids;
 
    size_t invalid_transaction_count = 0;
    size_t valid_transaction_count = 0;
@@ -363,6 +494,7 @@ signed_block chain_controller::_generate_block(
 
      for (const auto &t : c) {
        thread block_thread;
+       vector<transaction_id_type> user_input_ids;
        block_thread.user_input.reserve(t.transactions.size());
        block_thread.generated_input.reserve(t.transactions.size());
        for (const auto &trx : t.transactions) {
@@ -373,11 +505,13 @@ signed_block chain_controller::_generate_block(
                 const auto& t = trx.get<std::reference_wrapper<const SignedTransaction>>().get();
                 validate_referenced_accounts(t);
                 check_transaction_authorization(t);
-                auto processed = apply_transaction(t);
+                auto id = t.id();
+                auto processed = apply_transaction(t, id);
                 block_thread.user_input.emplace_back(processed);
+                user_input_ids.emplace_back(id);
              } else if (trx.contains<std::reference_wrapper<const GeneratedTransaction>>()) {
                 const auto& t = trx.get<std::reference_wrapper<const GeneratedTransaction>>().get();
-                auto processed = apply_transaction(t);
+                auto processed = apply_transaction(t, t.id);
                 block_thread.generated_input.emplace_back(processed);
              } else {
                 FC_THROW_EXCEPTION(tx_scheduling_exception, "Unknown transaction type in block_schedule");
@@ -390,10 +524,11 @@ signed_block chain_controller::_generate_block(
           {
              // Do nothing, transaction will not be re-applied
              elog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
+             _authority_cache->clear();
              if (trx.contains<std::reference_wrapper<const SignedTransaction>>()) {
                 const auto& t = trx.get<std::reference_wrapper<const SignedTransaction>>().get();
                 wlog( "The transaction was ${t}", ("t", t ) );
-                invalid_pending.emplace(t.id());
+                invalid_pending.emplace_back(t.id());
              } else if (trx.contains<std::reference_wrapper<const GeneratedTransaction>>()) {
                 wlog( "The transaction was ${t}", ("t", trx.get<std::reference_wrapper<const GeneratedTransaction>>().get()) );
              } 
@@ -402,6 +537,12 @@ signed_block chain_controller::_generate_block(
        }
 
        if (!(block_thread.generated_input.empty() && block_thread.user_input.empty())) {
+          // In the order of thread::append_merkle_leaves
+          for (const auto& id : user_input_ids)
+             transaction_ids.append(id);
+          for (const auto& trx : block_thread.generated_input)
+             transaction_ids.append(trx.id);
+
           block_thread.generated_input.shrink_to_fit();
           block_thread.user_input.shrink_to_fit();
           block_cycle.emplace_back(std::move(block_thread));
@@ -424,29 +565,21 @@ signed_block chain_controller::_generate_block(
       wlog( "Postponed ${n} transactions errors when processing", ("n", invalid_transaction_count) );
 
       // remove pending transactions determined to be bad during scheduling
-      if (invalid_pending.size() > 0) {
-         for (auto itr = _pending_transactions.begin(); itr != _pending_transactions.end(); ) {
-            auto& tx = *itr;
-            if (invalid_pending.find(tx.id()) != invalid_pending.end()) {
-               itr = _pending_transactions.erase(itr);
-            } else {
-               ++itr;
-            }
-         }
-      }
+      for (const auto& id : invalid_pending)
+         _pending_transactions.remove(id);
    }
 
    _pending_tx_session.reset();
+   _authority_cache->clear();
 
    // We have temporarily broken the invariant that
-   // _pending_tx_session is the result of applying _pending_tx, as
-   // _pending_transactions now consists of the set of postponed transactions.
-   // However, the push_block() call below will re-create the
-   // _pending_tx_session.
+   // _pending_tx_session is the result of applying _pending_transactions.
+   // The push_block() call below removes the transactions included in
+   // this block from the pool, and re-creates the _pending_tx_session.
 
    pending_block.previous = head_block_id();
    pending_block.timestamp = when;
-   pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
+   pending_block.transaction_merkle_root = signed_block::merkle_root_of(transaction_ids);
 
    pending_block.producer = producer_obj.owner;
 
@@ -484,12 +617,14 @@ void chain_controller::pop_block()
 
    _fork_db.pop_block();
    _db.undo();
+   _authority_cache->clear();
 } FC_CAPTURE_AND_RETHROW() }
 
 void chain_controller::clear_pending()
 { try {
    _pending_transactions.clear();
-   _pending_tx_session.reset();
+   _db.with_write_lock([&] { _pending_tx_session.reset(); });
+   _authority_cache->clear();
 } FC_CAPTURE_AND_RETHROW() }
 
 //////////////////// private methods ////////////////////
@@ -659,26 +794,94 @@ void chain_controller::check_transaction_output(const T& expected, const T& actu
    }
 }
 
+chain_controller::thread_output chain_controller::apply_thread(const thread& next_thread,
+                                                              const transaction_id_type* user_input_ids)
+{
+   // The threads of a cycle share the database, whose indexes and undo state do not support concurrent writers. A
+   // thread holds _apply_mutex whenever it is not running contract code, so only contract execution overlaps.
+   std::unique_lock<std::mutex> lock(_apply_mutex);
+   auto& wasm = wasm_interface::get();
+   wasm.database_lock = &lock;
+   auto on_exit = fc::make_scoped_exit([&wasm]() {
+      wasm.database_lock = nullptr;
+   });
+
+   thread_output output;
+   output.generated_input.reserve(next_thread.generated_input.size());
+   output.user_input.reserve(next_thread.user_input.size());
+
+   for (const auto& ptrx : next_thread.generated_input)
+      output.generated_input.emplace_back(apply_transaction(get_generated_transaction(ptrx.id), ptrx.id));
+
+   for (const auto& ptrx : next_thread.user_input)
+      output.user_input.emplace_back(apply_transaction<SignedTransaction>(ptrx, *user_input_ids++));
+
+   return output;
+}
+
+void chain_controller::check_thread_output(const thread& expected, const thread_output& actual,
+                                           const path_cons_list& path)const
+{
+   auto gen_path = path_cons_list(".generated_input", path);
+   for (int p_idx = 0; p_idx < expected.generated_input.size(); p_idx++)
+      check_transaction_output(expected.generated_input.at(p_idx), actual.generated_input.at(p_idx), gen_path(p_idx));
+
+   auto user_path = path_cons_list(".user_input", path);
+   for (int p_idx = 0; p_idx < expected.user_input.size(); p_idx++)
+      check_transaction_output(expected.user_input.at(p_idx), actual.user_input.at(p_idx), user_path(p_idx));
+}
+
 void chain_controller::_apply_block(const signed_block& next_block)
 { try {
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = _skip_flags;
 
-   FC_ASSERT((skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(),
-             "", ("next_block.transaction_merkle_root", next_block.transaction_merkle_root)
-             ("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()));
+   // Authorities are only cached for the life of a block
+   _authority_cache->clear();
 
-   const producer_object& signing_producer = validate_block_header(skip, next_block);
-   
+   vector<std::reference_wrapper<const SignedTransaction>> user_input;
    for (const auto& cycle : next_block.cycles)
       for (const auto& thread : cycle)
-         for (const auto& trx : thread.user_input) {
-            validate_referenced_accounts(trx);
-            // Check authorization, and allow irrelevant signatures.
-            // If the block producer let it slide, we'll roll with it.
-            check_transaction_authorization(trx, true);
+         user_input.insert(user_input.end(), thread.user_input.begin(), thread.user_input.end());
+
+   // The transaction ids are the leaves of the merkle tree, and are needed again to apply the transactions
+   vector<transaction_id_type> user_input_ids(user_input.size());
+   _workers->for_each_index(user_input.size(), [&](size_t i) {
+      user_input_ids[i] = user_input[i].get().id();
+   });
+
+   if (!(skip & skip_merkle_check)) {
+      incremental_merkle transaction_ids;
+      auto next_id = user_input_ids.begin();
+      for (const auto& cycle : next_block.cycles)
+         for (const auto& thread : cycle) {
+            // In the order of thread::append_merkle_leaves
+            for (size_t i = 0; i < thread.user_input.size(); ++i)
+               transaction_ids.append(*next_id++);
+            for (const auto& trx : thread.generated_input)
+               transaction_ids.append(trx.id);
          }
 
+      auto merkle_root = signed_block::merkle_root_of(transaction_ids);
+      FC_ASSERT(next_block.transaction_merkle_root == merkle_root,
+                "Merkle root does not match the block's transactions under transaction merkle version ${v}",
+                ("v", config::TransactionMerkleVersion)
+                ("next_block.transaction_merkle_root", next_block.transaction_merkle_root)
+                ("calc",merkle_root)("next_block",next_block)("id",next_block.id()));
+   }
+
+   const producer_object& signing_producer = validate_block_header(skip, next_block);
+
+   // These checks only read the database, which does not change until the first cycle is applied below, so they
+   // can be spread across the worker pool.
+   _workers->for_each_index(user_input.size(), [&](size_t i) {
+      const SignedTransaction& trx = user_input[i];
+      validate_referenced_accounts(trx);
+      // Check authorization, and allow irrelevant signatures.
+      // If the block producer let it slide, we'll roll with it.
+      check_transaction_authorization(trx, true);
+   });
+
    /* We do not need to push the undo state for each transaction
     * because they either all apply and are valid or the
     * entire block fails to apply.  We only need an "undo" state
@@ -686,30 +889,24 @@ void chain_controller::_apply_block(const signed_block& next_block)
     * when building a block.
     */
    auto root_path = path_cons_list("next_block.cycles");
+   const transaction_id_type* cycle_user_input_ids = user_input_ids.data();
    for (int c_idx = 0; c_idx < next_block.cycles.size(); c_idx++) {
       const auto& cycle = next_block.cycles.at(c_idx);
       auto c_path = path_cons_list(c_idx, root_path);
 
+      vector<const transaction_id_type*> thread_user_input_ids(cycle.size());
       for (int t_idx = 0; t_idx < cycle.size(); t_idx++) {
-         const auto& thread = cycle.at(t_idx);
-         auto t_path = path_cons_list(t_idx, c_path);
-
-         auto gen_path = path_cons_list(".generated_input", t_path);
-         for(int p_idx = 0; p_idx < thread.generated_input.size(); p_idx++ ) {
-            const auto& ptrx = thread.generated_input.at(p_idx);
-            const auto& trx = get_generated_transaction(ptrx.id);
-            auto processed = apply_transaction(trx);
-            check_transaction_output(ptrx, processed, gen_path(p_idx));
-         }
-
-         auto user_path = path_cons_list(".user_input", t_path);
-         for(int p_idx = 0; p_idx < thread.user_input.size(); p_idx++ ) {
-            const auto& ptrx = thread.user_input.at(p_idx);
-            const SignedTransaction& trx = ptrx;
-            auto processed = apply_transaction(trx);
-            check_transaction_output(ptrx, processed, user_path(p_idx));
-         }
+         thread_user_input_ids[t_idx] = cycle_user_input_ids;
+         cycle_user_input_ids += cycle.at(t_idx).user_input.size();
       }
+
+      // The threads of a cycle write to disjoint scopes, so they are applied at the same time, each with its own
+      // wasm_interface, and joined before the next cycle starts. Every thread is checked against its own output.
+      _workers->for_each_index(cycle.size(), [&](size_t t_idx) {
+         const auto& thread = cycle.at(t_idx);
+         check_thread_output(thread, apply_thread(thread, thread_user_input_ids[t_idx]),
+                             path_cons_list(t_idx, c_path));
+      });
    }
 
    update_global_properties(next_block);
@@ -719,6 +916,7 @@ void chain_controller::_apply_block(const signed_block& next_block)
 
    create_block_summary(next_block);
    clear_expired_transactions();
+   _pending_transactions.remove_included(next_block, user_input_ids);
 
    // notify observers that the block has been applied
    // TODO: do this outside the write lock...? 
@@ -729,16 +927,16 @@ void chain_controller::_apply_block(const signed_block& next_block)
 namespace {
 
   auto make_get_permission(const chainbase::database& db) {
-     return [&db](const types::AccountPermission& permission) {
+     return [&db](const types::AccountPermission& permission) -> const permission_object& {
         auto key = boost::make_tuple(permission.account, permission.permission);
         return db.get<permission_object, by_owner>(key);
      };
   }
 
-  auto make_authority_checker(const chainbase::database& db, const flat_set<public_key_type>& signingKeys) {
-     auto getPermission = make_get_permission(db);
-     auto getAuthority = [getPermission](const types::AccountPermission& permission) {
-        return getPermission(permission).auth;
+  auto make_authority_checker(const chainbase::database& db, authority_cache& cache,
+                              const flat_set<public_key_type>& signingKeys) {
+     auto getAuthority = [&db, &cache](const types::AccountPermission& permission) {
+        return cache.get(db, permission);
      };
      auto depthLimit = db.get<global_property_object>().configuration.authDepthLimit;
      return MakeAuthorityChecker(std::move(getAuthority), depthLimit, signingKeys);
@@ -747,7 +945,7 @@ namespace {
 }
 
 flat_set<public_key_type> chain_controller::get_required_keys(const SignedTransaction& trx, const flat_set<public_key_type>& candidateKeys)const {
-   auto checker = make_authority_checker(_db, candidateKeys);
+   auto checker = make_authority_checker(_db, *_authority_cache, candidateKeys);
 
    for (const auto& message : trx.messages) {
       for (const auto& declaredAuthority : message.authorization) {
@@ -770,7 +968,8 @@ void chain_controller::check_transaction_authorization(const SignedTransaction&
 
    auto getPermission = make_get_permission(_db);
 #warning TODO: Use a real chain_id here (where is this stored? Do we still need it?)
-   auto checker = make_authority_checker(_db, trx.get_signature_keys(chain_id_type{}));
+   auto checker = make_authority_checker(_db, *_authority_cache,
+                                         _signature_cache->get_signature_keys(trx, chain_id_type{}));
 
    for (const auto& message : trx.messages)
       for (const auto& declaredAuthority : message.authorization) {
@@ -829,27 +1028,27 @@ const permission_object& chain_controller::lookup_minimum_permission(types::Acco
    } FC_CAPTURE_AND_RETHROW((authorizer_account)(code_account)(type))
 }
 
-void chain_controller::validate_uniqueness( const SignedTransaction& trx )const {
+void chain_controller::validate_uniqueness( const SignedTransaction& trx, const transaction_id_type& id )const {
    if( !should_check_for_duplicate_transactions() ) return;
 
-   auto transaction = _db.find<transaction_object, by_trx_id>(trx.id());
+   auto transaction = _db.find<transaction_object, by_trx_id>(id);
    EOS_ASSERT(transaction == nullptr, tx_duplicate, "Transaction is not unique");
 }
 
-void chain_controller::validate_uniqueness( const GeneratedTransaction& trx )const {
+void chain_controller::validate_uniqueness( const GeneratedTransaction& trx, const transaction_id_type& id )const {
    if( !should_check_for_duplicate_transactions() ) return;
 }
 
-void chain_controller::record_transaction(const SignedTransaction& trx) {
+void chain_controller::record_transaction(const SignedTransaction& trx, const transaction_id_type& id) {
    //Insert transaction into unique transactions database.
     _db.create<transaction_object>([&](transaction_object& transaction) {
-        transaction.trx_id = trx.id(); /// TODO: consider caching ID
+        transaction.trx_id = id;
         transaction.trx = trx;
     });
 }
 
-void chain_controller::record_transaction(const GeneratedTransaction& trx) {
-   _db.modify( _db.get<generated_transaction_object,generated_transaction_object::by_trx_id>(trx.id), [&](generated_transaction_object& transaction) {
+void chain_controller::record_transaction(const GeneratedTransaction& trx, const transaction_id_type& id) {
+   _db.modify( _db.get<generated_transaction_object,generated_transaction_object::by_trx_id>(id), [&](generated_transaction_object& transaction) {
       transaction.status = generated_transaction_object::PROCESSED;
    });
 }     
@@ -962,10 +1161,10 @@ void chain_controller::apply_message(apply_context& context)
 } FC_CAPTURE_AND_RETHROW((context.msg)) }
 
 template<typename T>
-typename T::Processed chain_controller::apply_transaction(const T& trx)
+typename T::Processed chain_controller::apply_transaction(const T& trx, const transaction_id_type& id)
 { try {
-   validate_transaction(trx);
-   record_transaction(trx);
+   validate_transaction(trx, id);
+   record_transaction(trx, id);
    return process_transaction( trx, 0, fc::time_point::now());
 
 } FC_CAPTURE_AND_RETHROW((trx)) }
@@ -1113,20 +1312,20 @@ uint32_t chain_controller::last_irreversible_block_num() const {
 }
 
 void chain_controller::initialize_indexes() {
-   _db.add_index<account_index>();
-   _db.add_index<permission_index>();
-   _db.add_index<permission_link_index>();
-   _db.add_index<action_permission_index>();
-   _db.add_index<key_value_index>();
-   _db.add_index<key128x128_value_index>();
-   _db.add_index<key64x64x64_value_index>();
-
-   _db.add_index<global_property_multi_index>();
-   _db.add_index<dynamic_global_property_multi_index>();
-   _db.add_index<block_summary_multi_index>();
-   _db.add_index<transaction_multi_index>();
-   _db.add_index<generated_transaction_multi_index>();
-   _db.add_index<producer_multi_index>();
+   add_index<account_index>();
+   add_index<permission_index>();
+   add_index<permission_link_index>();
+   add_index<action_permission_index>();
+   add_index<key_value_index>();
+   add_index<key128x128_value_index>();
+   add_index<key64x64x64_value_index>();
+
+   add_index<global_property_multi_index>();
+   add_index<dynamic_global_property_multi_index>();
+   add_index<block_summary_multi_index>();
+   add_index<transaction_multi_index>();
+   add_index<generated_transaction_multi_index>();
+   add_index<producer_multi_index>();
 }
 
 void chain_controller::initialize_chain(chain_initializer_interface& starter)
@@ -1166,12 +1365,21 @@ void chain_controller::initialize_chain(chain_initializer_interface& starter)
 } FC_CAPTURE_AND_RETHROW() }
 
 chain_controller::chain_controller(database& database, fork_database& fork_db, block_log& blocklog,
-                                   chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin)
-   : _db(database), _fork_db(fork_db), _block_log(blocklog), _admin(std::move(admin)) {
+                                   chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin,
+                                   replay_trust trust, const optional<fc::path>& snapshot)
+   : _db(database), _fork_db(fork_db), _block_log(blocklog), _admin(std::move(admin)),
+     _pending_transactions(config::MaxPendingTransactions, config::MaxPendingTransactionBytes),
+     _workers(std::make_unique<worker_pool>()),
+     _signature_cache(std::make_unique<signature_cache>(config::SignatureCacheSize)),
+     _abi_cache(std::make_unique<abi_cache>(config::AbiCacheSize)),
+     _authority_cache(std::make_unique<authority_cache>()) {
 
    initialize_indexes();
    starter.register_types(*this, _db);
 
+   if (snapshot)
+      read_snapshot(*snapshot);
+
    // Behave as though we are applying a block during chain initialization (it's the genesis block!)
    with_applying_block([&] {
       initialize_chain(starter);
@@ -1181,16 +1389,98 @@ chain_controller::chain_controller(database& database, fork_database& fork_db, b
    spinup_fork_db();
 
    if (_block_log.read_head() && head_block_num() < _block_log.read_head()->block_num())
-      replay();
+      replay(trust);
 }
 
+void chain_controller::write_snapshot(const fc::path& file)const {
+   _db.with_read_lock([&] {
+      snapshot_header header;
+      header.head_block_num = head_block_num();
+      header.head_block_id = head_block_id();
+
+      snapshot_writer snapshot(file);
+      snapshot.write_header(header);
+      for (const auto& index : _snapshot_indices)
+         index->write(_db, snapshot);
+      snapshot.finish();
+
+      ilog("Wrote snapshot of the state at block ${n} to ${f}", ("n", header.head_block_num)("f", file.generic_string()));
+   });
+}
+
+void chain_controller::read_snapshot(const fc::path& file) { try {
+   FC_ASSERT(!_db.find<global_property_object>(), "Snapshots can only be loaded into an empty database");
+
+   snapshot_reader snapshot(file);
+   auto header = snapshot.read_header();
+   auto head_block = _block_log.read_block_by_num(header.head_block_num);
+   FC_ASSERT(head_block && head_block->id() == header.head_block_id,
+             "The block log does not contain block ${n}, which the snapshot was written at",
+             ("n", header.head_block_num)("id", header.head_block_id));
+
+   _db.with_write_lock([&] {
+      for (const auto& index : _snapshot_indices)
+         index->read(_db, snapshot);
+      snapshot.check_end();
+      FC_ASSERT(head_block_id() == header.head_block_id, "Snapshot state does not match its header",
+                ("state", head_block_id())("header", header.head_block_id));
+      _db.set_revision(head_block_num());
+   });
+   ilog("Loaded the state at block ${n} from snapshot ${f}", ("n", header.head_block_num)("f", file.generic_string()));
+} FC_CAPTURE_AND_RETHROW((file)) }
+
 chain_controller::~chain_controller() {
    clear_pending();
    _db.flush();
    _fork_db.reset();
 }
 
-void chain_controller::replay() {
+uint32_t chain_controller::replay_skip_flags(replay_trust trust) {
+   switch (trust) {
+      case replay_trust::nothing:
+         return skip_nothing;
+      case replay_trust::signatures:
+         return skip_producer_signature |
+                skip_transaction_signatures |
+                skip_transaction_dupe_check |
+                skip_tapos_check |
+                skip_producer_schedule_check |
+                skip_authority_check;
+      case replay_trust::everything:
+         return replay_skip_flags(replay_trust::signatures) |
+                skip_merkle_check |
+                skip_output_check;
+   }
+   FC_THROW_EXCEPTION(fc::invalid_arg_exception, "Unknown replay trust level");
+}
+
+signed_block chain_controller::decode_replay_block(uint32_t block_num, uint32_t skip)const {
+   auto packed = _block_log.read_packed_block_by_num(block_num);
+   FC_ASSERT(packed, "Could not find block #${n} in block_log!", ("n", block_num));
+   auto block = packed->unpack();
+   FC_ASSERT(block.block_num() == block_num, "Wrong block was read from block log.",
+             ("returned", block.block_num())("expected", block_num));
+
+   if (!(skip & skip_merkle_check))
+      FC_ASSERT(block.transaction_merkle_root == block.calculate_merkle_root(),
+                "Merkle root of block #${n} does not match its transactions; a block log written before "
+                "transaction merkle version ${v} has to be resynced", ("n", block_num)("v", config::TransactionMerkleVersion));
+   if (!(skip & skip_transaction_signatures))
+      for (const auto& cycle : block.cycles)
+         for (const auto& thread : cycle)
+            for (const auto& trx : thread.user_input)
+               _signature_cache->get_signature_keys(trx, chain_id_type{});
+
+   return block;
+}
+
+/**
+ * Blocks are read from the log and decoded by the worker pool, up to config::ReplayReadAheadBlocks ahead of the
+ * block being applied. Decoding also checks the merkle root and recovers transaction signatures into the signature
+ * cache, as far as the trust level calls for them, so applying a block on this thread is left with only the work
+ * that depends on chain state.
+ */
+void chain_controller::replay(replay_trust trust) {
    ilog("Replaying blockchain");
    auto start = fc::time_point::now();
    auto last_block = _block_log.read_head();
@@ -1199,20 +1489,34 @@ void chain_controller::replay() {
       return;
    }
 
+   const auto first_block_num = head_block_num() + 1;
    const auto last_block_num = last_block->block_num();
+   const auto skip = replay_skip_flags(trust);
+
+   std::deque<std::future<signed_block>> read_ahead;
+   uint32_t next_read = first_block_num;
+   // Decoding may still be in flight if applying a block throws; it must not outlive the controller
+   auto wait_for_reads = fc::make_scoped_exit([&read_ahead] {
+      for (auto& read : read_ahead)
+         if (read.valid())
+            read.wait();
+   });
+
+   ilog("Replaying ${n} blocks...", ("n", last_block_num - first_block_num + 1) );
+   for (uint32_t i = first_block_num; i <= last_block_num; ++i) {
+      while (next_read <= last_block_num && read_ahead.size() < size_t(config::ReplayReadAheadBlocks)) {
+         read_ahead.emplace_back(_workers->post([this, num = next_read, skip] {
+            return decode_replay_block(num, skip);
+         }));
+         ++next_read;
+      }
 
-   ilog("Replaying ${n} blocks...", ("n", last_block_num) );
-   for (uint32_t i = 1; i <= last_block_num; ++i) {
       if (i % 5000 == 0)
          std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num<<"   \n";
-      fc::optional<signed_block> block = _block_log.read_block_by_num(i);
-      FC_ASSERT(block, "Could not find block #${n} in block_log!", ("n", i));
-      apply_block(*block, skip_producer_signature |
-                          skip_transaction_signatures |
-                          skip_transaction_dupe_check |
-                          skip_tapos_check |
-                          skip_producer_schedule_check |
-                          skip_authority_check);
+      auto block = read_ahead.front().get();
+      read_ahead.pop_front();
+      // The merkle root was checked while decoding
+      apply_block(block, skip | skip_merkle_check);
    }
    auto end = fc::time_point::now();
    ilog("Done replaying ${n} blocks, elapsed time: ${t} sec",
@@ -1225,6 +1529,7 @@ void chain_controller::spinup_db() {
    // Rewind the database to the last irreversible block
    _db.with_write_lock([&] {
       _db.undo_all();
+      _authority_cache->clear();
 
       FC_ASSERT(_db.revision() == head_block_num(), "Chainbase revision does not match head block num",
                 ("rev", _db.revision())("head_block", head_block_num()));
@@ -1237,7 +1542,11 @@ void chain_controller::spinup_fork_db()
    if(last_block.valid()) {
       _fork_db.start_block(*last_block);
       if (last_block->id() != head_block_id()) {
-           FC_ASSERT(head_block_num() == 0, "last block ID does not match current chain state",
+           // The state may be behind the log, if it was wiped or loaded from a snapshot; replay will catch it up
+           auto head_in_log = head_block_num() > 0 && head_block_num() < last_block->block_num()?
+                                 _block_log.read_block_by_num(head_block_num()) : optional<signed_block>();
+           FC_ASSERT(head_block_num() == 0 || (head_in_log && head_in_log->id() == head_block_id()),
+                     "last block ID does not match current chain state",
                      ("last_block->id", last_block->id())("head_block_num",head_block_num()));
       }
    }
@@ -1477,28 +1786,20 @@ ProcessedTransaction chain_controller::transaction_from_variant( const fc::varia
 }
 
 vector<char> chain_controller::message_to_binary( Name code, Name type, const fc::variant& obj )const {
-   const auto& code_account = _db.get<account_object,by_name>( code );
-   if( code_account.abi.size() > 4 ) { /// 4 == packsize of empty Abi
-      fc::datastream<const char*> ds( code_account.abi.data(), code_account.abi.size() );
-      eos::types::Abi abi;
-      fc::raw::unpack( ds, abi );
-      types::AbiSerializer abis( abi );
-      return abis.variantToBinary( abis.getActionType( type ), obj );
-   }
+   if( auto abi = get_abi( code ) )
+      return abi->serializer.variantToBinary( abi->serializer.getActionType( type ), obj );
    return vector<char>();
 }
 fc::variant chain_controller::message_from_binary( Name code, Name type, const vector<char>& data )const {
-   const auto& code_account = _db.get<account_object,by_name>( code );
-   if( code_account.abi.size() > 4 ) { /// 4 == packsize of empty Abi
-      fc::datastream<const char*> ds( code_account.abi.data(), code_account.abi.size() );
-      eos::types::Abi abi;
-      fc::raw::unpack( ds, abi );
-      types::AbiSerializer abis( abi );
-      return abis.binaryToVariant( abis.getActionType( type ), data );
-   }
+   if( auto abi = get_abi( code ) )
+      return abi->serializer.binaryToVariant( abi->serializer.getActionType( type ), data );
    return fc::variant();
 }
 
+std::shared_ptr<const abi_cache::cached_abi> chain_controller::get_abi( Name code )const {
+   return _abi_cache->get( _db.get<account_object,by_name>( code ) );
+}
+
 fc::variant  chain_controller::transaction_to_variant( const ProcessedTransaction& trx )const {
 #define SET_FIELD( MVO, OBJ, FIELD ) MVO(#FIELD, OBJ.FIELD)
 
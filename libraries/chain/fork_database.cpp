@@ -33,6 +33,7 @@ void fork_database::reset()
 {
    _head.reset();
    _index.clear();
+   _unlinked_index.clear();
 }
 
 void fork_database::pop_block()
@@ -53,6 +54,10 @@ void     fork_database::start_block(signed_block b)
 /**
  * Pushes the block into the fork database and caches it if it doesn't link
  *
+ * A block that arrives ahead of its parent is held in the unlinked index, as long as it is no more than
+ * MAX_BLOCK_REORDERING blocks past the head, and the unlinkable_block_exception is still thrown so the caller knows
+ * it was not applied. Once its parent is pushed, the block and any of its buffered descendants are linked in order
+ * and the returned head reflects them.
  */
 shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
 {
@@ -62,10 +67,14 @@ shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
    }
    catch ( const unlinkable_block_exception& e )
    {
-      wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",b.id())("num",b.block_num()) );
-      wlog( "Head: ${num}, ${id}", ("num",_head->data.block_num())("id",_head->data.id()) );
+      if( item->num <= _head->num + MAX_BLOCK_REORDERING && _unlinked_index.size() < _max_size ) {
+         dlog( "Buffering block that does not link yet: ${id}, ${num}", ("id",item->id)("num",item->num) );
+         _unlinked_index.insert( item );
+      } else {
+         wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",item->id)("num",item->num) );
+         wlog( "Head: ${num}, ${id}", ("num",_head->data.block_num())("id",_head->data.id()) );
+      }
       throw;
-      _unlinked_index.insert( item );
    }
    return _head;
 }
@@ -99,9 +108,11 @@ void  fork_database::_push_block(const item_ptr& item)
       while( num_idx.size() && (*num_idx.begin())->num < min_num )
          num_idx.erase( num_idx.begin() );
       
-      _unlinked_index.get<block_num>().erase(_head->num - _max_size);
+      auto& unlinked_num_idx = _unlinked_index.get<block_num>();
+      while( unlinked_num_idx.size() && (*unlinked_num_idx.begin())->num < min_num )
+         unlinked_num_idx.erase( unlinked_num_idx.begin() );
    }
-   //_push_next( item );
+   _push_next( item );
 }
 
 /**
@@ -119,7 +130,11 @@ void fork_database::_push_next( const item_ptr& new_item )
     {
        auto tmp = *itr;
        prev_idx.erase( itr );
-       _push_block( tmp );
+       try {
+          _push_block( tmp );
+       } catch ( const fc::exception& e ) {
+          wlog( "Dropping buffered block ${id} that failed to link: ${e}", ("id",tmp->id)("e",e.to_string()) );
+       }
 
        itr = prev_idx.find( new_item->id );
     }
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/account_object.hpp>
+#include <eos/types/AbiSerializer.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <memory>
+#include <shared_mutex>
+
+namespace eos { namespace chain {
+
+   /**
+    *   @class abi_cache
+    *   @brief keeps the unpacked ABI and a ready AbiSerializer for recently used contracts
+    *
+    *   Converting a message or table row between JSON and binary needs the contract's ABI unpacked from the account
+    *   and loaded into an AbiSerializer, which costs far more than the conversion itself. The cache keeps the result
+    *   per account, and reuses it for as long as the account's abi_version matches the one it was built from; a
+    *   setcode that changes the ABI, or a fork switch that undoes one, therefore rebuilds it on next use.
+    *
+    *   The serializers handed out are immutable and may be used from any thread. Lookups take a shared lock, so any
+    *   number of readers can use the cache at once.
+    */
+   class abi_cache {
+      public:
+         struct cached_abi {
+            explicit cached_abi(types::Abi&& a) : abi(std::move(a)), serializer(abi) {}
+
+            types::Abi           abi;
+            types::AbiSerializer serializer;
+         };
+
+         explicit abi_cache(uint32_t max_size);
+
+         /// @return the ABI of account, or nullptr if it has not set one
+         std::shared_ptr<const cached_abi> get(const account_object& account);
+
+         size_t size()const;
+         void clear();
+
+      private:
+         struct entry {
+            AccountName                       name;
+            fc::sha256                        abi_version;
+            std::shared_ptr<const cached_abi> value;
+         };
+
+         struct by_name;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::ordered_unique<boost::multi_index::tag<by_name>,
+                  BOOST_MULTI_INDEX_MEMBER(entry, AccountName, name)>
+            >
+         > entry_index;
+
+         uint32_t                          _max_size;
+         entry_index                       _entries;
+         mutable std::shared_timed_mutex   _mutex;
+   };
+
+} } // eos::chain
@@ -40,11 +40,13 @@ namespace eos { namespace chain {
       Time                creation_date;
       shared_vector<char> code;
       shared_vector<char> abi;
+      fc::sha256          abi_version; ///< hash of abi, so cached copies of it can be checked cheaply
 
       void set_abi( const eos::types::Abi& _abi ) {
          abi.resize( fc::raw::pack_size( _abi ) );
          fc::datastream<char*> ds( abi.data(), abi.size() );
          fc::raw::pack( ds, _abi );
+         abi_version = fc::sha256::hash( abi.data(), abi.size() );
       }
    };
    using account_id_type = account_object::id_type;
@@ -64,4 +66,4 @@ CHAINBASE_SET_INDEX_TYPE(eos::chain::account_object, eos::chain::account_index)
 
 FC_REFLECT(chainbase::oid<eos::chain::account_object>, (_id))
 
-FC_REFLECT(eos::chain::account_object, (id)(name)(vm_type)(vm_version)(code_version)(code)(creation_date))
+FC_REFLECT(eos::chain::account_object, (id)(name)(vm_type)(vm_version)(code_version)(code)(creation_date)(abi)(abi_version))
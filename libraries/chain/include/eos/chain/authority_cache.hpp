@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/authority_checker.hpp>
+#include <eos/chain/permission_object.hpp>
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
+namespace eos { namespace chain {
+
+   /**
+    *   @class authority_cache
+    *   @brief keeps the resolved authorities of the permissions checked while applying the current block
+    *
+    *   Every signature check walks the declared permission, and any permissions it delegates to, fetching each
+    *   permission_object and sorting its keys and accounts into evaluation order. Busy multi-sig and delegated
+    *   permissions are checked over and over within a block, so the cache keeps each resolved authority until the
+    *   permission is changed by updateauth or deleteauth, or the block ends. The cache does not follow the undo
+    *   state of the database, so it must also be cleared whenever an undo session is discarded: the permissions that
+    *   session created, updated or deleted revert, and the authorities resolved from them would be stale.
+    *
+    *   The resolved authorities handed out are immutable and may be used from any thread. Lookups take a shared lock,
+    *   so any number of readers can use the cache at once.
+    */
+   class authority_cache {
+      public:
+         /// @return the resolved authority of permission, which must exist in db
+         std::shared_ptr<const resolved_authority> get(const chainbase::database& db,
+                                                       const types::AccountPermission& permission);
+
+         /// Forget permission; call whenever it is modified or removed
+         void invalidate(const types::AccountPermission& permission);
+
+         size_t size()const;
+         void clear();
+
+      private:
+         typedef std::pair<AccountName,PermissionName> permission_key;
+
+         std::map<permission_key, std::shared_ptr<const resolved_authority>> _entries;
+         mutable std::shared_timed_mutex                                    _mutex;
+   };
+
+} } // eos::chain
@@ -3,12 +3,10 @@
 #include <eos/chain/types.hpp>
 #include <eos/types/generated.hpp>
 
-#include <eos/utilities/parallel_markers.hpp>
+#include <boost/container/flat_set.hpp>
 
-#include <fc/scoped_exit.hpp>
-
-#include <boost/range/algorithm/find.hpp>
-#include <boost/algorithm/cxx11/all_of.hpp>
+#include <algorithm>
+#include <memory>
 
 namespace eos { namespace chain {
 
@@ -26,14 +24,37 @@ struct GetWeightVisitor {
 struct MetaPermissionComparator {
    bool operator()(const MetaPermission& a, const MetaPermission& b) const {
       GetWeightVisitor scale;
-      if (a.visit(scale) > b.visit(scale)) return true;
+      auto aWeight = a.visit(scale), bWeight = b.visit(scale);
+      if (aWeight != bWeight) return aWeight > bWeight;
       return a.contains<types::KeyPermissionWeight>() && !b.contains<types::KeyPermissionWeight>();
    }
 };
-
-using MetaPermissionSet = boost::container::flat_multiset<MetaPermission, MetaPermissionComparator>;
 }
 
+/**
+ * @brief An authority with its key and account permissions merged into the order @ref AuthorityChecker evaluates them
+ *
+ * Sorting the permissions is most of the cost of checking a small authority, so authorities which are checked
+ * repeatedly should be resolved once and the result reused; see @ref authority_cache.
+ */
+struct resolved_authority {
+   resolved_authority() = default;
+
+   template<typename AuthorityType>
+   explicit resolved_authority(const AuthorityType& authority)
+      : threshold(authority.threshold) {
+      permissions.reserve(authority.keys.size() + authority.accounts.size());
+      for (const auto& key : authority.keys)
+         permissions.emplace_back(types::KeyPermissionWeight(key));
+      for (const auto& account : authority.accounts)
+         permissions.emplace_back(types::AccountPermissionWeight(account));
+      std::stable_sort(permissions.begin(), permissions.end(), detail::MetaPermissionComparator());
+   }
+
+   UInt32                         threshold = 0;
+   vector<detail::MetaPermission> permissions;
+};
+
 /**
  * @brief This class determines whether a set of signing keys are sufficient to satisfy an authority or not
  *
@@ -41,15 +62,26 @@ using MetaPermissionSet = boost::container::flat_multiset<MetaPermission, MetaPe
  * then determine whether that list of keys is sufficient to satisfy the authority. This class takes a list of keys and
  * provides the @ref satisfied method to determine whether that list of keys satisfies a provided authority.
  *
+ * The signing keys are kept sorted and looked up by binary search, and the keys used so far are tracked in a bitmask.
+ * Keys newly marked as used are logged so that they can be unmarked if the authority using them turns out not to be
+ * satisfied, which keeps checking an authority free of allocations once the checker has been constructed.
+ *
  * @tparam F A callable which takes a single argument of type @ref AccountPermission and returns the corresponding
- * authority
+ * authority, either as an authority type, a @ref resolved_authority, or a shared pointer to one
  */
 template<typename F>
 class AuthorityChecker {
    F PermissionToAuthority;
    UInt16 recursionDepthLimit;
    vector<public_key_type> signingKeys;
-   vector<bool> usedKeys;
+   vector<uint64_t> usedKeys;
+   vector<uint32_t> newlyUsedKeys;
+
+   bool is_used(size_t index) const { return (usedKeys[index / 64] >> (index % 64)) & 1; }
+   void set_used(size_t index, bool used) {
+      if (used) usedKeys[index / 64] |= uint64_t(1) << (index % 64);
+      else usedKeys[index / 64] &= ~(uint64_t(1) << (index % 64));
+   }
 
    struct WeightTallyVisitor {
       using result_type = UInt32;
@@ -62,9 +94,13 @@ class AuthorityChecker {
          : checker(checker), recursionDepth(recursionDepth) {}
 
       UInt32 operator()(const types::KeyPermissionWeight& permission) {
-         auto itr = boost::find(checker.signingKeys, permission.key);
-         if (itr != checker.signingKeys.end()) {
-            checker.usedKeys[itr - checker.signingKeys.begin()] = true;
+         auto itr = std::lower_bound(checker.signingKeys.begin(), checker.signingKeys.end(), permission.key);
+         if (itr != checker.signingKeys.end() && *itr == permission.key) {
+            auto index = itr - checker.signingKeys.begin();
+            if (!checker.is_used(index)) {
+               checker.set_used(index, true);
+               checker.newlyUsedKeys.push_back(index);
+            }
             totalWeight += permission.weight;
          }
          return totalWeight;
@@ -82,47 +118,63 @@ public:
       : PermissionToAuthority(PermissionToAuthority),
         recursionDepthLimit(recursionDepthLimit),
         signingKeys(signingKeys.begin(), signingKeys.end()),
-        usedKeys(signingKeys.size(), false)
-   {}
+        usedKeys((signingKeys.size() + 63) / 64, 0)
+   {
+      newlyUsedKeys.reserve(signingKeys.size());
+   }
 
    bool satisfied(const types::AccountPermission& permission, UInt16 depth = 0) {
       return satisfied(PermissionToAuthority(permission), depth);
    }
    template<typename AuthorityType>
+   bool satisfied(const std::shared_ptr<AuthorityType>& authority, UInt16 depth = 0) {
+      return satisfied(*authority, depth);
+   }
+   template<typename AuthorityType>
    bool satisfied(const AuthorityType& authority, UInt16 depth = 0) {
+      return satisfied(resolved_authority(authority), depth);
+   }
+   bool satisfied(const resolved_authority& authority, UInt16 depth = 0) {
       // This check is redundant, since WeightTallyVisitor did it too, but I'll leave it here for future-proofing
       if (depth > recursionDepthLimit)
          return false;
 
-      // Save the current used keys; if we do not satisfy this authority, the newly used keys aren't actually used
-      auto KeyReverter = fc::make_scoped_exit([this, keys = usedKeys] () mutable {
-         usedKeys = keys;
-      });
-
-      // Sort key permissions and account permissions together into a single set of MetaPermissions
-      detail::MetaPermissionSet permissions;
-      permissions.insert(authority.keys.begin(), authority.keys.end());
-      permissions.insert(authority.accounts.begin(), authority.accounts.end());
+      // Keys marked as used beyond this point are only actually used if we satisfy this authority
+      auto firstNewKey = newlyUsedKeys.size();
 
       // Check all permissions, from highest weight to lowest, seeing if signingKeys satisfies them or not
       WeightTallyVisitor visitor(*this, depth);
-      for (const auto& permission : permissions)
+      for (const auto& permission : authority.permissions)
          // If we've got enough weight, to satisfy the authority, return!
          if (permission.visit(visitor) >= authority.threshold) {
-            KeyReverter.cancel();
+            // Nothing above the top level can revert these keys any more
+            if (depth == 0)
+               newlyUsedKeys.clear();
             return true;
          }
+
+      for (auto i = firstNewKey; i < newlyUsedKeys.size(); ++i)
+         set_used(newlyUsedKeys[i], false);
+      newlyUsedKeys.resize(firstNewKey);
       return false;
    }
 
-   bool all_keys_used() const { return boost::algorithm::all_of_equal(usedKeys, true); }
-   flat_set<public_key_type> used_keys() const {
-      auto range = utilities::FilterDataByMarker(signingKeys, usedKeys, true);
-      return {range.begin(), range.end()};
+   bool all_keys_used() const {
+      for (size_t i = 0; i < signingKeys.size(); ++i)
+         if (!is_used(i)) return false;
+      return true;
    }
-   flat_set<public_key_type> unused_keys() const {
-      auto range = utilities::FilterDataByMarker(signingKeys, usedKeys, false);
-      return {range.begin(), range.end()};
+   flat_set<public_key_type> used_keys() const { return keys_with_marker(true); }
+   flat_set<public_key_type> unused_keys() const { return keys_with_marker(false); }
+
+private:
+   flat_set<public_key_type> keys_with_marker(bool used) const {
+      vector<public_key_type> keys;
+      for (size_t i = 0; i < signingKeys.size(); ++i)
+         if (is_used(i) == used)
+            keys.push_back(signingKeys[i]);
+      // signingKeys came from a flat_set, so keys is already sorted and unique
+      return {boost::container::ordered_unique_range, keys.begin(), keys.end()};
    }
 };
 
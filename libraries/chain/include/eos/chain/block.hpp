@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <eos/chain/transaction.hpp>
+#include <eos/chain/merkle.hpp>
 
 namespace eos { namespace chain {
 
@@ -66,14 +67,21 @@ namespace eos { namespace chain {
       vector<ProcessedGeneratedTransaction> generated_input;
       vector<ProcessedTransaction>          user_input;
 
-      digest_type merkle_digest() const;
+      /// Append the merkle leaves of this thread's transactions: the ids of the user input, then the generated input
+      void append_merkle_leaves(incremental_merkle& merkle) const;
    };
 
    using cycle = vector<thread>;
 
    struct signed_block : public signed_block_header
    {
+      /**
+       * @return the transaction_merkle_root for this block, which is over the ids of all its transactions, thread by
+       * thread in the order given by thread::append_merkle_leaves
+       */
       checksum_type calculate_merkle_root() const;
+      /// @return the transaction_merkle_root for a block whose transaction ids have been accumulated in transactions
+      static checksum_type merkle_root_of(const incremental_merkle& transactions);
       vector<cycle> cycles;
    };
 
@@ -2,6 +2,8 @@
 #include <fc/filesystem.hpp>
 #include <eos/chain/block.hpp>
 
+#include <memory>
+
 namespace eos { namespace chain {
 
    namespace detail { class block_log_impl; }
@@ -29,10 +31,26 @@ namespace eos { namespace chain {
     *
     * The main file is the only file that needs to persist. The index file can be reconstructed during a
     * linear scan of the main file.
+    *
+    * Both files are only ever appended to through an output stream. Reads go through read only memory mappings of
+    * the files, which are replaced by larger ones when a read needs data appended after the mapping was made. A
+    * reader holding on to an older mapping is not affected by this, so reads and appends may happen concurrently.
     */
 
    class block_log {
       public:
+         /**
+          * The packed bytes of a block, pointing directly into the memory mapped log. The mapping stays valid as long
+          * as the packed_block is held, even if the log is appended to in the meantime.
+          */
+         struct packed_block {
+            const char*                 data = nullptr;
+            size_t                      size = 0;
+            std::shared_ptr<const void> mapping;
+
+            signed_block unpack()const;
+         };
+
          block_log(const fc::path& data_dir);
          block_log(block_log&& other);
          ~block_log();
@@ -41,6 +59,7 @@ namespace eos { namespace chain {
          void flush();
          std::pair<signed_block, uint64_t> read_block(uint64_t file_pos)const;
          optional<signed_block> read_block_by_num(uint32_t block_num)const;
+         optional<packed_block> read_packed_block_by_num(uint32_t block_num)const;
          optional<signed_block> read_block_by_id(const block_id_type& id)const {
             return read_block_by_num(block_header::num_from_id(id));
          }
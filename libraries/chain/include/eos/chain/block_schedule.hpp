@@ -22,9 +22,11 @@
  * THE SOFTWARE.
  */
 #pragma once
+#include <eos/chain/config.hpp>
 #include <eos/chain/global_property_object.hpp>
 #include <eos/chain/transaction.hpp>
 
+#include <functional>
 #include <random>
 #include <set>
 
@@ -37,13 +39,22 @@ namespace eos { namespace chain {
 
    using cycle_schedule = vector<thread_schedule>;
 
+   /**
+    *   @brief the most cycles and threads block_schedule::by_read_write_sets may use for one block
+    */
+   struct schedule_shape {
+      uint32_t max_threads_per_cycle = config::DefaultMaxThreadsPerCycle;
+      /// Transactions which would need more cycles are left for a later block
+      uint32_t max_cycles            = config::DefaultMaxCyclesPerBlock;
+   };
+
    /**
     *   @class block_schedule
     *   @brief represents a proposed order of execution for a generated block
     */
    struct block_schedule
    {
-      typedef block_schedule (*factory)(const vector<pending_transaction>&, const global_property_object&);
+      typedef std::function<block_schedule(const vector<pending_transaction>&, const global_property_object&)> factory;
       vector<cycle_schedule> cycles;
 
       // Algorithms
@@ -66,6 +77,21 @@ namespace eos { namespace chain {
        * @return the block scheduler
        */
       static block_schedule in_single_thread(const vector<pending_transaction>& transactions, const global_property_object& properties);
+
+      /**
+       * A greedy scheduler that tracks the scopes each transaction writes and reads separately, so that transactions
+       * which only read a scope never conflict with each other. A transaction which conflicts with threads of an
+       * earlier cycle goes in the first cycle after them, or joins the conflicting thread if there is only one.
+       * Threads are filled by the estimated cost of their transactions, up to an equal share of the block's total,
+       * rather than by a count of transactions.
+       * @return the block scheduler
+       */
+      static block_schedule by_read_write_sets(const vector<pending_transaction>& transactions, const global_property_object& properties);
+
+      /**
+       * @return a by_read_write_sets scheduler building schedules of the given shape
+       */
+      static factory by_read_write_sets_with(const schedule_shape& shape);
      
    };
 
@@ -78,7 +104,17 @@ namespace eos { namespace chain {
       }
    };
 
+   struct readscope_extracting_visitor : public fc::visitor<std::set<AccountName>> {
+      template <typename T>
+      std::set<AccountName> operator()(std::reference_wrapper<const T> trx) const {
+         const auto& t = trx.get();
+         std::set<AccountName> unique_names(t.readscope.begin(), t.readscope.end());
+         return unique_names;
+      }
+   };
+
 } } // eos::chain
 
+FC_REFLECT(eos::chain::schedule_shape, (max_threads_per_cycle)(max_cycles))
 FC_REFLECT(eos::chain::thread_schedule, (transactions))
 FC_REFLECT(eos::chain::block_schedule, (cycles))
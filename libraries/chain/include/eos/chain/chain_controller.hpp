@@ -39,10 +39,17 @@
 #include <eos/chain/chain_initializer_interface.hpp>
 #include <eos/chain/chain_administration_interface.hpp>
 #include <eos/chain/exceptions.hpp>
+#include <eos/chain/signature_cache.hpp>
+#include <eos/chain/abi_cache.hpp>
+#include <eos/chain/authority_cache.hpp>
+#include <eos/chain/worker_pool.hpp>
+#include <eos/chain/snapshot.hpp>
+#include <eos/chain/transaction_pool.hpp>
 
 #include <fc/log/logger.hpp>
 
 #include <map>
+#include <mutex>
 
 namespace eos { namespace chain {
    using database = chainbase::database;
@@ -55,8 +62,25 @@ namespace eos { namespace chain {
     */
    class chain_controller {
       public:
+         /**
+          * How much of each block is checked again when the chain state is rebuilt from the block log. Every block
+          * in the log is irreversible, so it was fully validated when it was first applied.
+          */
+         enum class replay_trust {
+            nothing,    ///< check every block as though it had just been received
+            signatures, ///< trust signatures, authorities, TaPoS, duplicates and the producer schedule
+            everything  ///< also trust the merkle roots and outputs recorded in the blocks, and only execute them
+         };
+
+         /**
+          * If a snapshot is given, the database must be empty; the chain state is loaded from the snapshot rather than
+          * initialized from genesis, and the block log, which must contain the snapshot's head block, is replayed from
+          * there.
+          */
          chain_controller(database& database, fork_database& fork_db, block_log& blocklog,
-                          chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin);
+                          chain_initializer_interface& starter, unique_ptr<chain_administration_interface> admin,
+                          replay_trust trust = replay_trust::signatures,
+                          const optional<fc::path>& snapshot = optional<fc::path>());
          chain_controller(chain_controller&&) = default;
          ~chain_controller();
 
@@ -82,6 +106,16 @@ namespace eos { namespace chain {
           */
          bool is_applying_block()const { return _currently_applying_block; }
 
+         /**
+          * @brief Drop any cached copy of a permission's authority
+          *
+          * Must be called by anything which modifies or removes a permission_object, so that signatures are not
+          * checked against the authority it had before.
+          */
+         void invalidate_authority(const types::AccountPermission& permission) {
+            _authority_cache->invalidate(permission);
+         }
+
          /**
           *  The controller can override any script endpoint with native code.
           */
@@ -89,6 +123,25 @@ namespace eos { namespace chain {
          void set_apply_handler( const AccountName& contract, const AccountName& scope, const ActionName& action, apply_handler v );
          //@}
 
+         /**
+          * @brief Add an index to the database, and to the state written to and loaded from snapshots
+          *
+          * Every index holding chain state must be added this way, and in the same order on every node.
+          */
+         template<typename MultiIndexType>
+         void add_index() {
+            _db.add_index<MultiIndexType>();
+            _snapshot_indices.emplace_back(std::make_unique<snapshot_index<MultiIndexType>>());
+         }
+
+         /**
+          * @brief Write the chain state as of the head block to a snapshot file
+          *
+          * A node started from the snapshot needs the head block in its block log, so the head block should be
+          * irreversible, as it is when the chain has just been opened.
+          */
+         void write_snapshot(const fc::path& file)const;
+
          enum validation_steps
          {
             skip_nothing                = 0,
@@ -108,6 +161,9 @@ namespace eos { namespace chain {
             skip_output_check           = 1 << 13  ///< used to skip checks for outputs in block exactly matching those created from apply
          };
 
+         /// @return the skip flags used to apply blocks from the block log at the given trust level
+         static uint32_t replay_skip_flags(replay_trust trust);
+
          /**
           *  @return true if the block is in our fork DB or saved to disk as
           *  part of the official chain, otherwise return false
@@ -117,6 +173,8 @@ namespace eos { namespace chain {
          block_id_type               get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>      fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>      fetch_block_by_number( uint32_t num )const;
+         /// Packed bytes of an irreversible block straight from the block log; empty if the block is not yet in the log
+         optional<block_log::packed_block> fetch_packed_block_by_number( uint32_t num )const;
          const SignedTransaction&    get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type>  get_block_ids_on_fork(block_id_type head_of_fork)const;
          const GeneratedTransaction& get_generated_transaction( const generated_transaction_id_type& id ) const;
@@ -140,6 +198,12 @@ namespace eos { namespace chain {
          vector<char>       message_to_binary( Name code, Name type, const fc::variant& obj )const;
          fc::variant        message_from_binary( Name code, Name type, const vector<char>& bin )const;
 
+         /**
+          *  @return the unpacked ABI of code together with a serializer for it, or nullptr if code has no ABI. The
+          *  result is cached until the account's ABI changes, and may be used without holding any lock.
+          */
+         std::shared_ptr<const abi_cache::cached_abi> get_abi( Name code )const;
+
 
          /**
           *  Calculate the percent of block production slots that were missed in the
@@ -153,6 +217,17 @@ namespace eos { namespace chain {
 
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
 
+         /**
+          * @brief Recover the signing keys of transactions ahead of validating them
+          *
+          * The keys are recovered on the worker pool and cached, so that the authorization checks performed while
+          * the write lock is held can reuse them. This does not touch the database and does not need to hold any lock.
+          */
+         ///@{
+         void prevalidate_signatures( const signed_block& b )const;
+         void prevalidate_signatures( const vector<SignedTransaction>& trxs )const;
+         ///@}
+
 
          ProcessedTransaction push_transaction( const SignedTransaction& trx, uint32_t skip = skip_nothing );
          ProcessedTransaction _push_transaction( const SignedTransaction& trx );
@@ -196,19 +271,14 @@ namespace eos { namespace chain {
          template<typename Function>
          auto without_pending_transactions( Function&& f ) -> decltype((*((Function*)nullptr))()) 
          {
-            auto old_pending = std::move( _pending_transactions );
-            _pending_tx_session.reset();
-            auto on_exit = fc::make_scoped_exit( [&](){ 
-               for( const auto& t : old_pending ) {
-                  try {
-                     if (!is_known_transaction(t.id()))
-                        push_transaction( t );
-                  } catch ( ... ){}
-               }
-            });
+            // undoing the pending state writes to the database, which read-only API calls may be reading
+            _db.with_write_lock([&] { _pending_tx_session.reset(); });
+            _authority_cache->clear();
+            auto on_exit = fc::make_scoped_exit( [&](){ restore_pending_transactions(); });
             return f();
          }
 
+         /// Must be called under the database write lock, as push_block does, if read-only API calls may be running
          void pop_block();
          void clear_pending();
 
@@ -268,18 +338,36 @@ namespace eos { namespace chain {
          bool should_check_scope()const                      { return !(_skip_flags&skip_scope_check);            }
 
 
-         const deque<SignedTransaction>&  pending()const { return _pending_transactions; }
+         const transaction_pool&  pending()const { return _pending_transactions; }
    private:
 
          /// Reset the object graph in-memory
          void initialize_indexes();
          void initialize_chain(chain_initializer_interface& starter);
 
-         void replay();
+         void read_snapshot(const fc::path& file);
+         /// Rebuild the pending state after blocks have been applied; see the definition for which transactions
+         void restore_pending_transactions();
+         void replay(replay_trust trust);
+         /// Read a block from the log for replay, doing the checks which do not depend on chain state
+         signed_block decode_replay_block(uint32_t block_num, uint32_t skip)const;
 
          void apply_block(const signed_block& next_block, uint32_t skip = skip_nothing);
          void _apply_block(const signed_block& next_block);
 
+         /// The results of applying one thread of a cycle, in the same order as the thread's inputs
+         struct thread_output {
+            vector<ProcessedGeneratedTransaction> generated_input;
+            vector<ProcessedTransaction>          user_input;
+         };
+
+         /**
+          * Applies one thread of a cycle; the threads of a cycle may be applied concurrently
+          * @param user_input_ids the ids of the thread's user input transactions, in order
+          */
+         thread_output apply_thread(const thread& next_thread, const transaction_id_type* user_input_ids);
+         void check_thread_output(const thread& expected, const thread_output& actual, const path_cons_list& path)const;
+
          template<typename Function>
          auto with_applying_block(Function&& f) -> decltype((*((Function*)nullptr))()) {
             auto on_exit = fc::make_scoped_exit([this](){
@@ -294,8 +382,9 @@ namespace eos { namespace chain {
          template<typename T>
          void check_transaction_output(const T& expected, const T& actual, const path_cons_list& path)const;
 
+         /// @param id the id of trx, which callers generally already have at hand
          template<typename T>
-         typename T::Processed apply_transaction(const T& trx);
+         typename T::Processed apply_transaction(const T& trx, const transaction_id_type& id);
          
          template<typename T>
          typename T::Processed process_transaction(const T& trx, int depth, const fc::time_point& start_time);
@@ -307,27 +396,27 @@ namespace eos { namespace chain {
           * @thow transaction_exception if the transaction is invalid
           */
          template<typename T>
-         void validate_transaction(const T& trx) const {
+         void validate_transaction(const T& trx, const transaction_id_type& id) const {
          try {
             EOS_ASSERT(trx.messages.size() > 0, transaction_exception, "A transaction must have at least one message");
 
             validate_scope(trx);
             validate_expiration(trx);
-            validate_uniqueness(trx);
+            validate_uniqueness(trx, id);
             validate_tapos(trx);
 
          } FC_CAPTURE_AND_RETHROW( (trx) ) }
          
          /// Validate transaction helpers @{
-         void validate_uniqueness(const SignedTransaction& trx)const;
-         void validate_uniqueness(const GeneratedTransaction& trx)const;
+         void validate_uniqueness(const SignedTransaction& trx, const transaction_id_type& id)const;
+         void validate_uniqueness(const GeneratedTransaction& trx, const transaction_id_type& id)const;
          void validate_tapos(const Transaction& trx)const;
          void validate_referenced_accounts(const Transaction& trx)const;
          void validate_expiration(const Transaction& trx) const;
          void validate_scope(const Transaction& trx) const;
 
-         void record_transaction(const SignedTransaction& trx);
-         void record_transaction(const GeneratedTransaction& trx);         
+         void record_transaction(const SignedTransaction& trx, const transaction_id_type& id);
+         void record_transaction(const GeneratedTransaction& trx, const transaction_id_type& id);
          /// @}
 
          /**
@@ -368,19 +457,34 @@ namespace eos { namespace chain {
          ProducerRound calculate_next_round(const signed_block& next_block);
 
          database&                        _db;
+         /**
+          * Read-only API calls run on other threads and hold only the database read lock, so _fork_db and
+          * _block_log may only change under _db.with_write_lock, as _push_block, pop_block and
+          * update_last_irreversible_block do when called from push_block
+          */
          fork_database&                   _fork_db;
          block_log&                       _block_log;
 
          unique_ptr<chain_administration_interface> _admin;
 
          optional<database::session>      _pending_tx_session;
-         deque<SignedTransaction>         _pending_transactions;
+         transaction_pool                 _pending_transactions;
 
          bool                             _currently_applying_block = false;
          uint64_t                         _skip_flags = 0;
 
          flat_map<uint32_t,block_id_type> _checkpoints;
 
+         /// Applies the threads of a cycle, and runs the read-only parts of block validation, concurrently
+         unique_ptr<worker_pool>          _workers;
+         /// Held by a thread of a cycle being applied whenever it is not running contract code
+         std::mutex                       _apply_mutex;
+         unique_ptr<signature_cache>      _signature_cache;
+         unique_ptr<abi_cache>            _abi_cache;
+         unique_ptr<authority_cache>      _authority_cache;
+
+         vector<unique_ptr<abstract_snapshot_index>> _snapshot_indices;
+
          typedef pair<AccountName,types::Name> handler_key;
 
          map< AccountName, map<handler_key, apply_handler> >                   apply_handlers;
@@ -67,6 +67,38 @@ const static UInt32 DefaultMaxInlineMsgSize = 4 * 1024;
 const static UInt32 DefaultMaxGenTrxSize = 64 * 1024;
 const static UInt32 ProducersAuthorityThreshold = 14;
 
+/**
+ * Version of the transaction_merkle_root in block headers. Version 2 is taken over the ids of all of a block's
+ * transactions rather than over a root per thread, so blocks and block logs produced under version 1 no longer
+ * validate and must be resynced from a node running this version.
+ */
+const static UInt32 TransactionMerkleVersion = 2;
+
+/** Number of transactions whose recovered signing keys are remembered by the chain_controller */
+const static int SignatureCacheSize = 64 * 1024;
+
+/** Number of contracts whose unpacked ABI is kept ready for JSON conversions */
+const static int AbiCacheSize = 1024;
+
+/** Number of instantiated contracts the wasm_interface keeps in memory */
+const static int DefaultMaxWasmInstances = 128;
+
+/** Number of table cursors a single message handler may have open at once */
+const static int MaxOpenCursors = 64;
+
+/** Number of blocks decoded ahead of the one being applied while replaying the block log */
+const static int ReplayReadAheadBlocks = 256;
+
+/** Number of transactions the pending transaction pool holds before it refuses new ones */
+const static int MaxPendingTransactions = 100 * 1024;
+/** Total packed size of the transactions the pending transaction pool holds before it refuses new ones */
+const static int MaxPendingTransactionBytes = 64 * 1024 * 1024;
+
+/** Most threads the read/write set block scheduler puts in one cycle, unless the producer configures otherwise */
+const static int DefaultMaxThreadsPerCycle = 16;
+/** Most cycles the read/write set block scheduler puts in one block, unless the producer configures otherwise */
+const static int DefaultMaxCyclesPerBlock = 64;
+
 const static int BlocksPerRound = 21;
 const static int VotedProducersPerRound = 20;
 const static int IrreversibleThresholdPercent = 70 * Percent1;
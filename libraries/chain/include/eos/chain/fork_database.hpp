@@ -84,6 +84,7 @@ namespace eos { namespace chain {
 
          /**
           *  @return the new head block ( the longest fork )
+          *  @throws unlinkable_block_exception if b does not link yet; it is kept and linked once its parent is pushed
           */
          shared_ptr<fork_item>            push_block(const signed_block& b);
          shared_ptr<fork_item>            head()const { return _head; }
@@ -78,4 +78,4 @@ namespace eos { namespace chain {
 
 CHAINBASE_SET_INDEX_TYPE(eos::chain::generated_transaction_object, eos::chain::generated_transaction_multi_index)
 
-FC_REFLECT( eos::chain::generated_transaction_object, (trx) )
+FC_REFLECT( eos::chain::generated_transaction_object, (trx)(status) )
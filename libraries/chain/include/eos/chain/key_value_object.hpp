@@ -167,3 +167,5 @@ CHAINBASE_SET_INDEX_TYPE(eos::chain::key128x128_value_object, eos::chain::key128
 CHAINBASE_SET_INDEX_TYPE(eos::chain::key64x64x64_value_object, eos::chain::key64x64x64_value_index)
 
 FC_REFLECT(eos::chain::key_value_object, (id)(scope)(code)(table)(primary_key)(value) )
+FC_REFLECT(eos::chain::key128x128_value_object, (id)(scope)(code)(table)(primary_key)(secondary_key)(value) )
+FC_REFLECT(eos::chain::key64x64x64_value_object, (id)(scope)(code)(table)(primary_key)(secondary_key)(tertiary_key)(value) )
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/types.hpp>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief Calculate the root of a merkle tree over ids
+    *
+    * Adjacent pairs of nodes are hashed together to form the next level of the tree, and the last node of a level
+    * with an odd number of nodes is paired with itself. The root of a single id is the id itself.
+    */
+   digest_type merkle(vector<digest_type> ids);
+
+   /**
+    *   @class incremental_merkle
+    *   @brief accumulates the merkle tree of a sequence of leaves as they are appended
+    *
+    *   Only the roots of the complete subtrees still waiting for a right sibling are kept, at most one per level of
+    *   the tree, so appending a leaf costs O(1) hashes amortized and O(log(N)) memory. get_root() gives the same result
+    *   as merkle() over every leaf appended so far.
+    */
+   class incremental_merkle {
+      public:
+         void append(const digest_type& leaf);
+
+         /// @return the root of the tree, or an empty digest if no leaves have been appended
+         digest_type get_root()const;
+
+         uint64_t leaf_count()const { return _leaf_count; }
+
+      private:
+         /// _pending[level] holds a subtree root only if bit level of _leaf_count is set
+         vector<digest_type> _pending;
+         uint64_t            _leaf_count = 0;
+   };
+
+} } // eos::chain
@@ -77,6 +77,7 @@ public:
       const auto* obj = db.find<ObjectType, by_scope_primary>(tuple);
       if( obj ) {
          mutable_db.remove( *obj );
+         ++record_removals;
          return 1;
       }
       return 0;
@@ -90,19 +91,10 @@ public:
       auto tuple = load_record_tuple<typename IndexType::value_type, Scope>::get(scope, code, table, keys);
       auto itr = idx.lower_bound(tuple);
 
-      if( itr == idx.end() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ||
+      if( !in_table(idx, itr, scope, code, table) ||
           !load_record_compare<typename IndexType::value_type, Scope>::compare(*itr, keys)) return -1;
 
-       key_helper<typename IndexType::value_type>::set(keys, *itr);
-
-       auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-       if( copylen ) {
-          itr->value.copy(value, copylen);
-       }
-       return copylen;
+      return copy_record(*itr, keys, value, valuelen);
    }
 
    template <typename IndexType, typename Scope>
@@ -111,20 +103,11 @@ public:
 
       const auto& idx = db.get_index<IndexType, Scope>();
       auto tuple = front_record_tuple<typename IndexType::value_type>::get(scope, code, table);
-
       auto itr = idx.lower_bound( tuple );
-      if( itr == idx.end() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ) return -1;
 
-      key_helper<typename IndexType::value_type>::set(keys, *itr);
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
 
-      auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-      if( copylen ) {
-         itr->value.copy(value, copylen);
-      }
-      return copylen;
+      return copy_record(*itr, keys, value, valuelen);
    }
 
    template <typename IndexType, typename Scope>
@@ -135,21 +118,13 @@ public:
       auto tuple = back_record_tuple<typename IndexType::value_type>::get(scope, code, table);
       auto itr = idx.upper_bound(tuple);
 
-      if( std::distance(idx.begin(), itr) == 0 ) return -1;
+      if( itr == idx.begin() ) return -1;
 
       --itr;
 
-      if( itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ) return -1;
-
-      key_helper<typename IndexType::value_type>::set(keys, *itr);
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
 
-      auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-      if( copylen ) {
-         itr->value.copy(value, copylen);
-      }
-      return copylen;
+      return copy_record(*itr, keys, value, valuelen);
    }
 
    template <typename IndexType, typename Scope>
@@ -158,33 +133,16 @@ public:
 
       const auto& idx = db.get_index<IndexType, Scope>();
       auto tuple = next_record_tuple<typename IndexType::value_type, Scope>::get(scope, code, table, keys);
-
       auto itr = idx.lower_bound(tuple);
 
-      if( itr == idx.end() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ||
-          !key_helper<typename IndexType::value_type>::compare(*itr, keys) ) { 
-        return -1;
-      }
+      if( !in_table(idx, itr, scope, code, table) ||
+          !key_helper<typename IndexType::value_type>::compare(*itr, keys) ) return -1;
 
       ++itr;
 
-      if( itr == idx.end() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ) { 
-        return -1;
-      }
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
 
-      key_helper<typename IndexType::value_type>::set(keys, *itr);
-      
-      auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-      if( copylen ) {
-         itr->value.copy(value, copylen);
-      }
-      return copylen;
+      return copy_record(*itr, keys, value, valuelen);
    }
 
    template <typename IndexType, typename Scope>
@@ -194,27 +152,16 @@ public:
       const auto& idx = db.get_index<IndexType, Scope>();
       auto tuple = next_record_tuple<typename IndexType::value_type, Scope>::get(scope, code, table, keys);
       auto itr = idx.lower_bound(tuple);
-      
-      if( itr == idx.end() ||
-          itr == idx.begin() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ||
+
+      if( itr == idx.begin() ||
+          !in_table(idx, itr, scope, code, table) ||
           !key_helper<typename IndexType::value_type>::compare(*itr, keys) ) return -1;
 
       --itr;
 
-      if( itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ) return -1;
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
 
-      key_helper<typename IndexType::value_type>::set(keys, *itr);
-
-      auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-      if( copylen ) {
-         itr->value.copy(value, copylen);
-      }
-      return copylen;
+      return copy_record(*itr, keys, value, valuelen);
    }
 
    template <typename IndexType, typename Scope>
@@ -225,18 +172,9 @@ public:
       auto tuple = lower_bound_tuple<typename IndexType::value_type, Scope>::get(scope, code, table, keys);
       auto itr = idx.lower_bound(tuple);
 
-      if( itr == idx.end() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table) return -1;
-
-      key_helper<typename IndexType::value_type>::set(keys, *itr);
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
 
-      auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-      if( copylen ) {
-         itr->value.copy(value, copylen);
-      }
-      return copylen;
+      return copy_record(*itr, keys, value, valuelen);
    }
 
    template <typename IndexType, typename Scope>
@@ -247,20 +185,56 @@ public:
       auto tuple = upper_bound_tuple<typename IndexType::value_type, Scope>::get(scope, code, table, keys);
       auto itr = idx.upper_bound(tuple);
 
-      if( itr == idx.end() ||
-          itr->scope != scope ||
-          itr->code  != code  ||
-          itr->table != table ) return -1;
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
 
-      key_helper<typename IndexType::value_type>::set(keys, *itr);
+      return copy_record(*itr, keys, value, valuelen);
+   }
 
-      auto copylen =  std::min<size_t>(itr->value.size(),valuelen);
-      if( copylen ) {
-         itr->value.copy(value, copylen);
-      }
-      return copylen;
+   /**
+    * @brief A position in a table which a contract can step through without searching for it again
+    *
+    * The *_record functions above locate their starting point with a fresh lookup on every call, so walking a table
+    * with next_record costs a search of the whole index per step. A cursor instead remembers the record it is on and
+    * moves to the neighbouring record directly.
+    */
+   struct record_cursor {
+      virtual ~record_cursor() {}
+
+      /// What @ref read returns when there is no record to read
+      enum read_failure : int32_t {
+         end_of_table   = -1, ///< the cursor has stepped out of its table
+         record_removed = -2  ///< the record under the cursor was removed; stepping moves to its neighbours
+      };
+
+      /// Copies the current record's keys and value out; returns the number of bytes written or a @ref read_failure
+      virtual int32_t read( char* data, uint32_t datalen ) = 0;
+      /// Moves to the following record in index order; returns false when the table is exhausted
+      virtual bool next() = 0;
+      /// Moves to the preceding record in index order; returns false when the table is exhausted
+      virtual bool previous() = 0;
+   };
+   typedef int32_t cursor_handle;
+
+   /**
+    * @brief Open a cursor on the first record in the table not less than @ref keys in the index @ref Scope
+    * @return a handle for use with @ref get_cursor, or -1 if there is no such record
+    */
+   template <typename IndexType, typename Scope>
+   cursor_handle lower_bound_cursor( Name scope, Name code, Name table, typename IndexType::value_type::key_type* keys ) {
+      require_scope( scope );
+
+      const auto& idx = db.get_index<IndexType, Scope>();
+      auto tuple = lower_bound_tuple<typename IndexType::value_type, Scope>::get(scope, code, table, keys);
+      auto itr = idx.lower_bound(tuple);
+
+      if( !in_table(idx, itr, scope, code, table) ) return -1;
+
+      return add_cursor(std::make_unique<table_cursor<IndexType, Scope>>(*this, *itr));
    }
 
+   record_cursor& get_cursor( cursor_handle handle );
+   void close_cursor( cursor_handle handle );
+
    /**
     * @brief Require @ref account to have approved of this message
     * @param account The account whose approval is required
@@ -336,6 +310,115 @@ public:
    pending_message& get_pending_message(pending_message::handle_type handle);
    pending_message& create_pending_message(const AccountName& code, const FuncName& type, const Bytes& data);
    void release_pending_message(pending_message::handle_type handle);
+
+private:
+   template <typename Index, typename Iterator>
+   static bool in_table( const Index& idx, const Iterator& itr, Name scope, Name code, Name table ) {
+      return itr != idx.end() &&
+             itr->scope == scope &&
+             itr->code  == code  &&
+             itr->table == table;
+   }
+
+   template <typename ObjectType>
+   static int32_t copy_record( const ObjectType& obj, typename ObjectType::key_type* keys, char* value, uint32_t valuelen ) {
+      key_helper<ObjectType>::set(keys, obj);
+
+      auto copylen =  std::min<size_t>(obj.value.size(),valuelen);
+      if( copylen ) {
+         obj.value.copy(value, copylen);
+      }
+      return copylen;
+   }
+
+   /**
+    * Holds a pointer to the record it is on, so stepping is a single iterator increment. Records are node based and
+    * do not move when others are added or modified, but one may be removed out from under the cursor; in that case
+    * the cursor seeks back to the removed record's keys and carries on from the record that took its place.
+    */
+   template <typename IndexType, typename Scope>
+   struct table_cursor : public record_cursor {
+      typedef typename IndexType::value_type object_type;
+      typedef typename object_type::key_type key_type;
+
+      table_cursor( apply_context& context, const object_type& obj )
+         : context(context), scope(obj.scope), code(obj.code), table(obj.table) {
+         seat(&obj);
+      }
+
+      virtual int32_t read( char* data, uint32_t datalen ) override {
+         static const uint32_t keylen = object_type::number_of_keys*sizeof(key_type);
+         FC_ASSERT( datalen >= keylen, "insufficient data passed" );
+
+         bool exact;
+         auto itr = locate(exact);
+         if( current == nullptr ) return end_of_table;
+         if( !exact ) return record_removed;
+
+         return keylen + copy_record(*itr, reinterpret_cast<key_type*>(data), data + keylen, datalen - keylen);
+      }
+
+      virtual bool next() override {
+         bool exact;
+         auto itr = locate(exact);
+         if( itr == index().end() ) return seat(itr);
+         if( exact ) ++itr;
+         return seat(itr);
+      }
+
+      virtual bool previous() override {
+         bool exact;
+         auto itr = locate(exact);
+         if( current == nullptr || itr == index().begin() ) return seat(index().end());
+         --itr;
+         return seat(itr);
+      }
+
+   private:
+      const auto& index()const { return context.db.template get_index<IndexType, Scope>(); }
+
+      /// Finds the record the cursor is on; if it has been removed, clears @ref exact and finds the one after it
+      auto locate( bool& exact ) {
+         exact = true;
+         if( current == nullptr ) return index().end();
+         if( removals != context.record_removals && context.db.template find<object_type>(id) == nullptr ) {
+            exact = false;
+            return index().lower_bound(next_record_tuple<object_type, Scope>::get(scope, code, table, keys));
+         }
+         removals = context.record_removals;
+         return index().iterator_to(*current);
+      }
+
+      template <typename Iterator>
+      bool seat( const Iterator& itr ) {
+         if( !in_table(index(), itr, scope, code, table) ) {
+            current = nullptr;
+            return false;
+         }
+         return seat(&*itr);
+      }
+      bool seat( const object_type* obj ) {
+         current  = obj;
+         id       = obj->id;
+         removals = context.record_removals;
+         key_helper<object_type>::set(keys, *obj);
+         return true;
+      }
+
+      apply_context&                context;
+      Name                          scope;
+      Name                          code;
+      Name                          table;
+      const object_type*            current = nullptr; ///< null once the cursor has left the table
+      typename object_type::id_type id;
+      uint64_t                      removals = 0;
+      key_type                      keys[object_type::number_of_keys];
+   };
+
+   cursor_handle add_cursor( std::unique_ptr<record_cursor> cursor );
+
+   vector<std::unique_ptr<record_cursor>> cursors;
+   uint64_t                               record_removals = 0; ///< bumped by remove_record so cursors know to recheck
 };
 
 using apply_handler = std::function<void(apply_context&)>;
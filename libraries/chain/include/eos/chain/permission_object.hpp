@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <eos/chain/authority.hpp>
+#include <eos/chain/snapshot.hpp>
 
 #include "multi_index_includes.hpp"
 
@@ -68,6 +69,10 @@ namespace eos { namespace chain {
       }
    };
 
+   /// Permissions are referred to by id, from their children and from action_permission_object
+   template<>
+   struct snapshot_preserves_ids<permission_object> : std::true_type {};
+
    struct by_parent;
    struct by_owner;
    struct by_name;
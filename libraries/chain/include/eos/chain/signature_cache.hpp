@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/transaction.hpp>
+#include <eos/chain/worker_pool.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <mutex>
+
+namespace eos { namespace chain {
+
+   /**
+    *   @class signature_cache
+    *   @brief remembers the public keys recovered from the signatures of recently seen transactions
+    *
+    *   Recovering a public key from a signature is the most expensive part of validating a transaction, and the same
+    *   transaction is checked several times on its way into the chain: when it is pushed to the pending queue, when
+    *   a block containing it is generated, and again when that block is applied. The cache lets all but the first of
+    *   these reuse the recovered keys, and recover() allows the work for a whole block or batch of transactions to be
+    *   spread across a worker_pool before the database write lock is taken.
+    *
+    *   Entries are keyed by transaction id, and only reused if the signatures and chain id match the ones the keys
+    *   were recovered from. The oldest entries are evicted once the cache holds max_size transactions.
+    *
+    *   All methods are safe to call concurrently.
+    */
+   class signature_cache {
+      public:
+         explicit signature_cache(uint32_t max_size);
+
+         /// Recover and cache the keys of every transaction in trxs using the worker pool
+         void recover(const vector<std::reference_wrapper<const SignedTransaction>>& trxs, worker_pool& pool,
+                      const chain_id_type& chain_id);
+
+         /// @return the keys which signed trx, recovering and caching them if they are not already known
+         flat_set<public_key_type> get_signature_keys(const SignedTransaction& trx, const chain_id_type& chain_id);
+
+         size_t size()const;
+         void clear();
+
+      private:
+         struct entry {
+            transaction_id_type       id;
+            chain_id_type             chain_id;
+            vector<signature_type>    signatures;
+            flat_set<public_key_type> keys;
+         };
+
+         struct by_id;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::hashed_unique<boost::multi_index::tag<by_id>,
+                  BOOST_MULTI_INDEX_MEMBER(entry, transaction_id_type, id), std::hash<transaction_id_type>>
+            >
+         > entry_index;
+
+         optional<flat_set<public_key_type>> find(const transaction_id_type& id, const SignedTransaction& trx,
+                                                  const chain_id_type& chain_id)const;
+         void insert(entry&& e);
+
+         uint32_t           _max_size;
+         entry_index        _entries;
+         mutable std::mutex _mutex;
+   };
+
+} } // eos::chain
@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/types.hpp>
+
+#include <chainbase/chainbase.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/static_variant.hpp>
+
+#include <fstream>
+
+namespace eos { namespace chain {
+
+   /**
+    * The first record of a snapshot, identifying the file format and the block the state was taken at
+    */
+   struct snapshot_header {
+      static const uint32_t magic_number = 0x534f4553; ///< "SEOS" when read as little endian bytes
+      static const uint32_t current_version = 1;
+
+      uint32_t       magic = magic_number;
+      uint32_t       version = current_version;
+      uint32_t       head_block_num = 0;
+      block_id_type  head_block_id;
+   };
+
+   /**
+    *   @class snapshot_writer
+    *   @brief streams the chain state into a snapshot file
+    *
+    *   A snapshot is a sequence of records, each a 32 bit length followed by that many bytes. The first record is the
+    *   snapshot_header, followed for each index by a section record naming the object type and counting its rows, and
+    *   then one record per row. finish() appends the sha256 of everything before it, which snapshot_reader checks
+    *   before handing out any record.
+    */
+   class snapshot_writer {
+      public:
+         explicit snapshot_writer(const fc::path& file);
+
+         void write_header(const snapshot_header& header);
+         void write_section(const string& type_name, uint64_t row_count);
+         /// Write a row of the current section, along with the id it is stored under
+         template<typename Object>
+         void write_row(int64_t id, const Object& row);
+
+         /// Append the checksum and close the file; a snapshot which was not finished can not be read
+         void finish();
+
+      private:
+         void write_record(const vector<char>& record);
+
+         fc::path             _file;
+         std::ofstream        _out;
+         fc::sha256::encoder  _checksum;
+   };
+
+   /**
+    *   @class snapshot_reader
+    *   @brief reads back the records written by a snapshot_writer, in the same order
+    */
+   class snapshot_reader {
+      public:
+         /// Opens the file and verifies its checksum, throwing if it does not match
+         explicit snapshot_reader(const fc::path& file);
+
+         snapshot_header read_header();
+         /// @return the number of rows in the section, which must be for objects named type_name
+         uint64_t read_section(const string& type_name);
+         template<typename Object>
+         void read_row(Object& row);
+         /// @return the id the next row was stored under, without consuming the row
+         int64_t peek_row_id();
+
+         /// Assert that every record in the file has been read
+         void check_end();
+
+      private:
+         vector<char> read_record();
+
+         fc::path       _file;
+         std::ifstream  _in;
+         uint64_t       _end = 0;
+         vector<char>   _row;
+         bool           _row_pending = false;
+   };
+
+   /**
+    * The serialization used for rows of a snapshot. Objects in the database hold shared memory containers, and ids,
+    * which fc::raw does not know how to pack, so reflected types are walked member by member here and everything
+    * that contains no shared memory types is handed off to fc::raw.
+    */
+   namespace snapshot_detail {
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const T& v);
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, T& v);
+
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const chainbase::oid<T>& v);
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, chainbase::oid<T>& v);
+      template<typename Stream>
+      void snapshot_pack(Stream& s, const types::UInt128& v);
+      template<typename Stream>
+      void snapshot_unpack(Stream& s, types::UInt128& v);
+      template<typename Stream>
+      void snapshot_pack(Stream& s, const shared_string& v);
+      template<typename Stream>
+      void snapshot_unpack(Stream& s, shared_string& v);
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const shared_vector<T>& v);
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, shared_vector<T>& v);
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const shared_set<T>& v);
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, shared_set<T>& v);
+      template<typename Stream, typename T, size_t N>
+      void snapshot_pack(Stream& s, const std::array<T,N>& v);
+      template<typename Stream, typename T, size_t N>
+      void snapshot_unpack(Stream& s, std::array<T,N>& v);
+      template<typename Stream, typename... T>
+      void snapshot_pack(Stream& s, const fc::static_variant<T...>& v);
+      template<typename Stream, typename... T>
+      void snapshot_unpack(Stream& s, fc::static_variant<T...>& v);
+
+      template<typename Stream, typename Class>
+      struct pack_member_visitor {
+         pack_member_visitor(const Class& c, Stream& s) : c(c), s(s) {}
+
+         template<typename T, typename C, T(C::*p)>
+         void operator()(const char*)const { snapshot_pack(s, c.*p); }
+
+         const Class& c;
+         Stream&      s;
+      };
+
+      template<typename Stream, typename Class>
+      struct unpack_member_visitor {
+         unpack_member_visitor(Class& c, Stream& s) : c(c), s(s) {}
+
+         template<typename T, typename C, T(C::*p)>
+         void operator()(const char* name)const { try {
+            snapshot_unpack(s, c.*p);
+         } FC_RETHROW_EXCEPTIONS(warn, "Error unpacking field ${field}", ("field", name)) }
+
+         Class&  c;
+         Stream& s;
+      };
+
+      template<typename T>
+      using is_reflected_class = std::integral_constant<bool, fc::reflector<T>::is_defined::value &&
+                                                              !std::is_enum<T>::value>;
+
+      template<typename Stream, typename T>
+      void pack_value(Stream& s, const T& v, std::true_type) {
+         fc::reflector<T>::visit(pack_member_visitor<Stream,T>(v, s));
+      }
+      template<typename Stream, typename T>
+      void pack_value(Stream& s, const T& v, std::false_type) {
+         fc::raw::pack(s, v);
+      }
+      template<typename Stream, typename T>
+      void unpack_value(Stream& s, T& v, std::true_type) {
+         fc::reflector<T>::visit(unpack_member_visitor<Stream,T>(v, s));
+      }
+      template<typename Stream, typename T>
+      void unpack_value(Stream& s, T& v, std::false_type) {
+         fc::raw::unpack(s, v);
+      }
+
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const T& v) {
+         pack_value(s, v, is_reflected_class<T>());
+      }
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, T& v) {
+         unpack_value(s, v, is_reflected_class<T>());
+      }
+
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const chainbase::oid<T>& v) {
+         fc::raw::pack(s, v._id);
+      }
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, chainbase::oid<T>& v) {
+         fc::raw::unpack(s, v._id);
+      }
+
+      template<typename Stream>
+      void snapshot_pack(Stream& s, const types::UInt128& v) {
+         fc::raw::pack(s, static_cast<uint64_t>(v >> 64));
+         fc::raw::pack(s, static_cast<uint64_t>(v & std::numeric_limits<uint64_t>::max()));
+      }
+      template<typename Stream>
+      void snapshot_unpack(Stream& s, types::UInt128& v) {
+         uint64_t high, low;
+         fc::raw::unpack(s, high);
+         fc::raw::unpack(s, low);
+         v = (types::UInt128(high) << 64) | low;
+      }
+
+      template<typename Stream>
+      void snapshot_pack(Stream& s, const shared_string& v) {
+         fc::raw::pack(s, fc::unsigned_int(v.size()));
+         if (v.size())
+            s.write(v.data(), v.size());
+      }
+      template<typename Stream>
+      void snapshot_unpack(Stream& s, shared_string& v) {
+         fc::unsigned_int size;
+         fc::raw::unpack(s, size);
+         v.resize(size.value);
+         if (size.value)
+            s.read(&v[0], size.value);
+      }
+
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const shared_vector<T>& v) {
+         fc::raw::pack(s, fc::unsigned_int(v.size()));
+         for (const auto& item : v)
+            snapshot_pack(s, item);
+      }
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, shared_vector<T>& v) {
+         fc::unsigned_int size;
+         fc::raw::unpack(s, size);
+         v.clear();
+         v.resize(size.value);
+         for (auto& item : v)
+            snapshot_unpack(s, item);
+      }
+
+      template<typename Stream, typename T>
+      void snapshot_pack(Stream& s, const shared_set<T>& v) {
+         fc::raw::pack(s, fc::unsigned_int(v.size()));
+         for (const auto& item : v)
+            snapshot_pack(s, item);
+      }
+      template<typename Stream, typename T>
+      void snapshot_unpack(Stream& s, shared_set<T>& v) {
+         fc::unsigned_int size;
+         fc::raw::unpack(s, size);
+         v.clear();
+         for (uint32_t i = 0; i < size.value; ++i) {
+            T item;
+            snapshot_unpack(s, item);
+            v.insert(std::move(item));
+         }
+      }
+
+      template<typename Stream, typename T, size_t N>
+      void snapshot_pack(Stream& s, const std::array<T,N>& v) {
+         for (const auto& item : v)
+            snapshot_pack(s, item);
+      }
+      template<typename Stream, typename T, size_t N>
+      void snapshot_unpack(Stream& s, std::array<T,N>& v) {
+         for (auto& item : v)
+            snapshot_unpack(s, item);
+      }
+
+      template<typename Stream>
+      struct pack_variant_visitor {
+         typedef void result_type;
+         Stream& s;
+         template<typename T>
+         void operator()(const T& v)const { snapshot_pack(s, v); }
+      };
+      template<typename Stream>
+      struct unpack_variant_visitor {
+         typedef void result_type;
+         Stream& s;
+         template<typename T>
+         void operator()(T& v)const { snapshot_unpack(s, v); }
+      };
+
+      template<typename Stream, typename... T>
+      void snapshot_pack(Stream& s, const fc::static_variant<T...>& v) {
+         fc::raw::pack(s, fc::unsigned_int(v.which()));
+         v.visit(pack_variant_visitor<Stream>{s});
+      }
+      template<typename Stream, typename... T>
+      void snapshot_unpack(Stream& s, fc::static_variant<T...>& v) {
+         fc::unsigned_int which;
+         fc::raw::unpack(s, which);
+         v.set_which(which.value);
+         v.visit(unpack_variant_visitor<Stream>{s});
+      }
+   } // namespace snapshot_detail
+
+   template<typename Object>
+   void snapshot_writer::write_row(int64_t id, const Object& row) {
+      fc::datastream<size_t> size_stream;
+      fc::raw::pack(size_stream, id);
+      snapshot_detail::snapshot_pack(size_stream, row);
+      vector<char> record(size_stream.tellp());
+      fc::datastream<char*> ds(record.data(), record.size());
+      fc::raw::pack(ds, id);
+      snapshot_detail::snapshot_pack(ds, row);
+      write_record(record);
+   }
+
+   template<typename Object>
+   void snapshot_reader::read_row(Object& row) {
+      if (!_row_pending)
+         _row = read_record();
+      _row_pending = false;
+      fc::datastream<const char*> ds(_row.data(), _row.size());
+      int64_t id;
+      fc::raw::unpack(ds, id);
+      snapshot_detail::snapshot_unpack(ds, row);
+      FC_ASSERT(ds.remaining() == 0, "Snapshot row for ${type} was not fully read",
+                ("type", fc::get_typename<Object>::name()));
+   }
+
+   /**
+    * Objects whose ids are stored in other objects must be restored under the same id. The rows of every other index
+    * are numbered afresh, in order, when a snapshot is loaded.
+    */
+   template<typename Object>
+   struct snapshot_preserves_ids : std::false_type {};
+
+   /**
+    * @brief writes and restores the rows of one chainbase index; see chain_controller::add_index
+    */
+   class abstract_snapshot_index {
+      public:
+         virtual ~abstract_snapshot_index() {}
+
+         virtual void write(const chainbase::database& db, snapshot_writer& snapshot)const = 0;
+         /// Restore the rows of the index, which must be empty
+         virtual void read(chainbase::database& db, snapshot_reader& snapshot)const = 0;
+   };
+
+   template<typename MultiIndexType>
+   class snapshot_index : public abstract_snapshot_index {
+      public:
+         using object_type = typename MultiIndexType::value_type;
+
+         void write(const chainbase::database& db, snapshot_writer& snapshot)const override {
+            const auto& rows = db.get_index<MultiIndexType>().indices();
+            snapshot.write_section(fc::get_typename<object_type>::name(), rows.size());
+            for (const auto& row : rows)
+               snapshot.write_row(row.id._id, row);
+         }
+
+         void read(chainbase::database& db, snapshot_reader& snapshot)const override {
+            const auto row_count = snapshot.read_section(fc::get_typename<object_type>::name());
+            FC_ASSERT(db.get_index<MultiIndexType>().indices().empty(),
+                      "Cannot load ${type} rows from a snapshot into a non-empty index",
+                      ("type", fc::get_typename<object_type>::name()));
+
+            int64_t next_id = 0;
+            for (uint64_t i = 0; i < row_count; ++i) {
+               const auto saved_id = snapshot.peek_row_id();
+               if (snapshot_preserves_ids<object_type>::value) {
+                  FC_ASSERT(saved_id >= next_id, "Snapshot rows for ${type} are out of order",
+                            ("type", fc::get_typename<object_type>::name()));
+                  // Rows removed before the snapshot was written left gaps in the ids; use them up, so that this row
+                  // is created with the id it was saved under
+                  for (; next_id < saved_id; ++next_id)
+                     db.remove(db.create<object_type>([](object_type&) {}));
+               }
+
+               const auto& restored = db.create<object_type>([&snapshot](object_type& row) {
+                  auto id = row.id;
+                  snapshot.read_row(row);
+                  row.id = id;
+               });
+               FC_ASSERT(!snapshot_preserves_ids<object_type>::value || restored.id._id == saved_id,
+                         "Restored ${type} under id ${id} instead of ${saved}",
+                         ("type", fc::get_typename<object_type>::name())("id", restored.id._id)("saved", saved_id));
+               next_id = restored.id._id + 1;
+            }
+         }
+   };
+
+} } // eos::chain
+
+FC_REFLECT(eos::chain::snapshot_header, (magic)(version)(head_block_num)(head_block_id))
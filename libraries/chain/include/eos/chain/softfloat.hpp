@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+
+namespace eos { namespace chain {
+
+   /**
+    * @brief Deterministic IEEE-754 binary64 arithmetic on the bit patterns of doubles
+    *
+    * Contracts see doubles only as their 64 bit patterns, so that the results of floating point intrinsics never
+    * depend on the host's floating point unit, compiler flags or math library. Every operation here is implemented
+    * with integer arithmetic alone, and rounds its exact result to nearest, ties to even, as IEEE-754 specifies.
+    *
+    * Any NaN result is the canonical quiet NaN, 0x7ff8000000000000, whatever NaNs the operands were; that and
+    * f64_to_ui64 match the results the intrinsics gave when they were computed with 50 digit multiprecision floats.
+    */
+   namespace softfloat {
+      const uint64_t canonical_nan = 0x7ff8000000000000ull;
+
+      inline bool f64_is_nan(uint64_t a) { return (a & 0x7fffffffffffffffull) > 0x7ff0000000000000ull; }
+      inline bool f64_is_zero(uint64_t a) { return !(a & 0x7fffffffffffffffull); }
+
+      uint64_t f64_add(uint64_t a, uint64_t b);
+      uint64_t f64_sub(uint64_t a, uint64_t b);
+      uint64_t f64_mul(uint64_t a, uint64_t b);
+      uint64_t f64_div(uint64_t a, uint64_t b);
+      uint64_t f64_sqrt(uint64_t a);
+      /// a * b + c, rounded once
+      uint64_t f64_fma(uint64_t a, uint64_t b, uint64_t c);
+
+      /// Comparisons are false if either operand is NaN, and -0 equals +0
+      ///@{
+      bool f64_eq(uint64_t a, uint64_t b);
+      bool f64_lt(uint64_t a, uint64_t b);
+      bool f64_le(uint64_t a, uint64_t b);
+      ///@}
+
+      uint64_t i64_to_f64(int64_t a);
+
+      /**
+       * The magnitude of a, truncated toward zero, modulo 2^64. Magnitudes of 2^168 and above, and infinities,
+       * give 2^64-1. Throws if a is NaN.
+       */
+      uint64_t f64_to_ui64(uint64_t a);
+   }
+
+} } // eos::chain
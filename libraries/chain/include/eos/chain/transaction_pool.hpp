@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <eos/chain/block.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <set>
+
+namespace eos { namespace chain {
+
+   /**
+    *   @class transaction_pool
+    *   @brief holds the signed transactions waiting to be included in a block
+    *
+    *   Transactions are indexed by id, by expiration, by the order they arrived in and by the scopes they declare.
+    *   This lets the chain_controller drop the transactions a block included, and those which have expired, and find
+    *   the ones which may conflict with the block because they declare a scope it wrote to, without walking the rest
+    *   of the pool.
+    *
+    *   The pool is bounded both in the number of transactions and in their total packed size; add() refuses new
+    *   transactions while either limit is reached.
+    */
+   class transaction_pool {
+      public:
+         struct entry {
+            transaction_id_type  id;
+            SignedTransaction    trx;
+            uint64_t             arrival = 0;
+            uint32_t             packed_size = 0;
+
+            time_point_sec expiration()const { return trx.expiration; }
+         };
+
+         transaction_pool(uint32_t max_count, uint64_t max_packed_size);
+
+         /**
+          * @brief Add a transaction to the back of the pool
+          * @return false if the transaction was already in the pool
+          * @throws tx_resource_exhausted if the pool is full
+          */
+         bool add(const SignedTransaction& trx, const transaction_id_type& id);
+         bool contains(const transaction_id_type& id)const;
+         /// @return false if the transaction was not in the pool
+         bool remove(const transaction_id_type& id);
+         void clear();
+
+         /// Remove the transactions which expire at or before now; @return the number removed
+         size_t remove_expired(time_point_sec now);
+
+         /**
+          * @brief Remove the transactions included in an applied block
+          *
+          * The scopes the block's user input transactions wrote to are remembered until take_conflicting() is called.
+          *
+          * @param user_input_ids the ids of the block's user input transactions
+          */
+         void remove_included(const signed_block& block, const vector<transaction_id_type>& user_input_ids);
+
+         /**
+          * @return the ids, in arrival order, of the transactions which declare a scope written to by a block passed to
+          * remove_included() since the last call
+          */
+         vector<transaction_id_type> take_conflicting();
+
+         /// @return the transaction with the given id, or nullptr if it is not in the pool
+         const entry* find(const transaction_id_type& id)const;
+
+         /// Call f for each transaction in arrival order, until it returns false
+         template<typename Function>
+         void visit_in_arrival_order(Function&& f)const {
+            for (const auto& e : _entries.get<by_arrival>())
+               if (!f(e))
+                  return;
+         }
+
+         size_t   size()const         { return _entries.size(); }
+         bool     empty()const        { return _entries.empty(); }
+         uint64_t packed_size()const  { return _packed_size; }
+
+      private:
+         struct by_id;
+         struct by_expiration;
+         struct by_arrival;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::hashed_unique<boost::multi_index::tag<by_id>,
+                  BOOST_MULTI_INDEX_MEMBER(entry, transaction_id_type, id), std::hash<transaction_id_type>>,
+               boost::multi_index::ordered_non_unique<boost::multi_index::tag<by_expiration>,
+                  BOOST_MULTI_INDEX_CONST_MEM_FUN(entry, time_point_sec, expiration)>,
+               boost::multi_index::ordered_unique<boost::multi_index::tag<by_arrival>,
+                  BOOST_MULTI_INDEX_MEMBER(entry, uint64_t, arrival)>
+            >
+         > entry_index;
+
+         entry_index::iterator erase(entry_index::iterator itr);
+
+         entry_index             _entries;
+         /// (scope, arrival) for every scope declared by every transaction in the pool
+         std::set<std::pair<AccountName,uint64_t>> _scopes;
+         flat_set<AccountName>   _written_scopes;
+         uint64_t                _next_arrival = 0;
+         uint64_t                _packed_size = 0;
+         uint32_t                _max_count;
+         uint64_t                _max_packed_size;
+   };
+
+} } // eos::chain
@@ -1,20 +1,29 @@
 #pragma once
+#include <eos/chain/config.hpp>
 #include <eos/chain/exceptions.hpp>
 #include <eos/chain/message.hpp>
 #include <eos/chain/message_handling_contexts.hpp>
 #include <Runtime/Runtime.h>
 #include "IR/Module.h"
+#include <atomic>
+#include <list>
+#include <mutex>
 
 namespace eos { namespace chain {
 
 class  chain_controller;
+class  checktime_watchdog;
 /**
  * @class wasm_interface
  *
- * EOS uses the wasm-jit library to evaluate web assembly code. This library relies
- * upon a singlton interface which means there can be only one instance. This interface
- * is designed to wrap that singlton interface and potentially make it thread-local state
- * in the future.
+ * EOS uses the wasm-jit library to evaluate web assembly code. Every thread that executes
+ * contracts has its own wasm_interface, returned by get(), which holds the context of the
+ * contract that thread is running and its own instances of the contracts it has run, each
+ * with its own linear memory. Intrinsics find their context through get(), so contracts
+ * can run on several threads at once.
+ *
+ * The wasm-jit runtime itself keeps process-wide state, so loading and freeing instances is
+ * serialized across threads; calls into contracts that are already loaded are not.
  */
 class wasm_interface {
    public:
@@ -25,9 +34,29 @@ class wasm_interface {
          int                      mem_end      = 1<<16;
          vector<char>             init_memory;
          fc::sha256               code_version;
+         /// The WASM::injectionVersion the code was instrumented with; an instance is only reused for the same code
+         /// and instrumentation
+         U32                      instrumentation_version = 0;
+         /// Where the contract is in the use order of the thread's instances
+         std::list<AccountName>::iterator lru_position;
+
+         /// Entry points resolved when the contract is loaded; an entry point the contract does not export is unbound
+         Runtime::BoundFunction apply_entry;
+         Runtime::BoundFunction init_entry;
+         Runtime::BoundFunction alloc_entry;
       };
 
+      /// The interface of the calling thread
       static wasm_interface& get();
+      ~wasm_interface();
+
+      /**
+       * Configure the instance cache
+       *
+       * @param max_instances the number of instantiated contracts each thread keeps in memory; the least recently
+       * used instance is freed when another contract has to be loaded
+       */
+      static void set_max_instances( uint32_t max_instances );
 
       void init( apply_context& c );
       void apply( apply_context& c );
@@ -36,6 +65,29 @@ class wasm_interface {
 
       int64_t current_execution_time();
 
+      /**
+       * Called by the checktime calls injected at every block and loop of a contract; throws checktime_exceeded
+       * once the watchdog has found the contract running for longer than CHECKTIME_LIMIT
+       */
+      void checktime() {
+         if( checktime_expired.load( std::memory_order_relaxed ) )
+            checktime_expired_throw();
+      }
+
+      /**
+       * Stop and restart the clock of the running contract while it waits for something other than its own work,
+       * such as the database_lock
+       */
+      void pause_checktime();
+      void resume_checktime();
+
+      /**
+       * The lock on the database of a block thread applied at the same time as the other threads of its cycle, or
+       * null when the calling thread has the database to itself. The thread holds it whenever it is not running
+       * contract code: calls into a contract let go of it, and intrinsics that reach the database take it back.
+       */
+      std::unique_lock<std::mutex>* database_lock = nullptr;
+
       apply_context*       current_apply_context        = nullptr;
       apply_context*       current_validate_context     = nullptr;
       apply_context*       current_precondition_context = nullptr;
@@ -46,19 +98,32 @@ class wasm_interface {
 
    private:
       void load( const AccountName& name, const chainbase::database& db );
+      IR::Module* load_module( const shared_vector<char>& code );
+      void free_instance( map<AccountName, ModuleState>::iterator itr );
+      static void collect_garbage();
 
       char* vm_allocate( int bytes );   
-      void  vm_call( const char* name );
+      void  vm_call( const Runtime::BoundFunction& entry, const char* name );
       void  vm_validate();
       void  vm_precondition();
       void  vm_apply();
       void  vm_onInit();
       U32   vm_pointer_to_offset( char* );
 
+      void start_checktime();
+      void checktime_expired_throw();
+
 
 
       map<AccountName, ModuleState> instances;
       fc::time_point checktimeStart;
+      std::atomic<bool>                   checktime_expired{false};
+      std::shared_ptr<checktime_watchdog> watchdog;
+
+      std::list<AccountName>        lru; ///< the contracts in instances, least recently used first
+
+      static uint32_t max_instances;
+      static uint32_t uncollected_instances; ///< instances freed since the runtime last released unreachable objects
 
       wasm_interface();
 };
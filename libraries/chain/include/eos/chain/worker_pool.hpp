@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eos { namespace chain {
+
+   /**
+    *   @class worker_pool
+    *   @brief a fixed set of worker threads used to fan out independent pieces of work
+    *
+    *   The chain_controller uses the pool to apply the threads of a cycle at the same time, and for the read-only
+    *   parts of block processing: computing transaction ids, recovering signatures, checking authorizations and
+    *   decoding blocks during replay. Work is always
+    *   joined before control returns to the caller, so from the outside every operation on the pool is
+    *   synchronous; exceptions thrown by a task are carried back to the calling thread.
+    *
+    *   A pool constructed with zero workers runs everything on the calling thread.
+    */
+   class worker_pool {
+      public:
+         explicit worker_pool(uint32_t thread_count = default_thread_count());
+         worker_pool(const worker_pool&) = delete;
+         worker_pool& operator=(const worker_pool&) = delete;
+         ~worker_pool();
+
+         /// @return the number of worker threads, not counting the caller
+         uint32_t size()const { return _workers.size(); }
+
+         /// @return one worker per hardware thread, leaving one for the caller
+         static uint32_t default_thread_count();
+
+         /**
+          * @brief Queue a single task on the pool
+          * @return a future which becomes ready once the task has run and holds its result or exception
+          */
+         template<typename Function>
+         auto post(Function&& f) -> std::future<decltype(f())> {
+            using result_type = decltype(f());
+            auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Function>(f));
+            auto result = task->get_future();
+            if (_workers.empty()) {
+               (*task)();
+               return result;
+            }
+            enqueue([task]() { (*task)(); });
+            return result;
+         }
+
+         /**
+          * @brief Run task(i) for every i in [0, count) and wait for all of them to complete
+          *
+          * The calling thread takes part in the work. If one or more tasks throw, the exception of the task with the
+          * lowest index is rethrown once all tasks have finished, so the reported failure does not depend on timing.
+          */
+         template<typename Function>
+         void for_each_index(size_t count, Function&& task) {
+            if (count == 0)
+               return;
+            if (count == 1 || _workers.empty()) {
+               for (size_t i = 0; i < count; ++i)
+                  task(i);
+               return;
+            }
+
+            std::vector<std::exception_ptr> failures(count);
+            std::atomic<size_t> next_index(0);
+            auto drain = [&]() {
+               for (size_t i = next_index++; i < count; i = next_index++) {
+                  try {
+                     task(i);
+                  } catch (...) {
+                     failures[i] = std::current_exception();
+                  }
+               }
+            };
+
+            auto helper_count = std::min<size_t>(count - 1, _workers.size());
+            std::vector<std::future<void>> helpers;
+            helpers.reserve(helper_count);
+            for (size_t h = 0; h < helper_count; ++h)
+               helpers.emplace_back(post(drain));
+
+            drain();
+            for (auto& h : helpers)
+               h.wait();
+
+            for (const auto& f : failures)
+               if (f)
+                  std::rethrow_exception(f);
+         }
+
+      private:
+         void enqueue(std::function<void()> task);
+         void run();
+
+         std::vector<std::thread>            _workers;
+         std::deque<std::function<void()>>   _tasks;
+         std::mutex                          _mutex;
+         std::condition_variable             _condition;
+         bool                                _stopping = false;
+   };
+
+} } // eos::chain
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/merkle.hpp>
+
+namespace eos { namespace chain {
+
+namespace {
+   digest_type merkle_pair(const digest_type& left, const digest_type& right) {
+      return digest_type::hash(std::make_pair(left, right));
+   }
+}
+
+digest_type merkle(vector<digest_type> ids) {
+   if (ids.empty())
+      return digest_type();
+
+   while (ids.size() > 1) {
+      if (ids.size() % 2)
+         ids.push_back(ids.back());
+      for (size_t i = 0; i < ids.size() / 2; ++i)
+         ids[i] = merkle_pair(ids[2*i], ids[2*i+1]);
+      ids.resize(ids.size() / 2);
+   }
+
+   return ids.front();
+}
+
+void incremental_merkle::append(const digest_type& leaf) {
+   auto node = leaf;
+   size_t level = 0;
+   // Every set low bit of the count is a complete subtree which the new node is the right sibling of
+   for (; _leaf_count & (uint64_t(1) << level); ++level)
+      node = merkle_pair(_pending[level], node);
+
+   if (level == _pending.size())
+      _pending.emplace_back(node);
+   else
+      _pending[level] = node;
+   ++_leaf_count;
+}
+
+digest_type incremental_merkle::get_root()const {
+   if (_leaf_count == 0)
+      return digest_type();
+
+   // Walk up from the leaves, carrying the root of the incomplete subtree on the right edge of the tree, if any
+   optional<digest_type> carry;
+   for (size_t level = 0; ; ++level) {
+      const auto complete = _leaf_count >> level;
+      const bool has_pending = complete & 1;
+      if (complete + (carry? 1 : 0) == 1)
+         return has_pending? _pending[level] : *carry;
+
+      // The last node of a level with an odd number of nodes is paired with itself
+      if (has_pending)
+         carry = merkle_pair(_pending[level], carry? *carry : _pending[level]);
+      else if (carry)
+         carry = merkle_pair(*carry, *carry);
+   }
+}
+
+} } // eos::chain
@@ -1,6 +1,7 @@
 #include <eos/chain/message_handling_contexts.hpp>
 #include <eos/chain/permission_object.hpp>
 #include <eos/chain/exceptions.hpp>
+#include <eos/chain/config.hpp>
 #include <eos/chain/key_value_object.hpp>
 #include <eos/chain/chain_controller.hpp>
 
@@ -137,4 +138,27 @@ void apply_context::release_pending_message(pending_message::handle_type handle)
    pending_messages.pop_back();
 }
 
+apply_context::record_cursor& apply_context::get_cursor(cursor_handle handle) {
+   EOS_ASSERT(handle >= 0 && size_t(handle) < cursors.size() && cursors[handle], tx_unknown_argument,
+              "Transaction refers to non-existant/closed cursor");
+   return *cursors[handle];
+}
+
+void apply_context::close_cursor(cursor_handle handle) {
+   get_cursor(handle);
+   cursors[handle].reset();
+}
+
+apply_context::cursor_handle apply_context::add_cursor(std::unique_ptr<record_cursor> cursor) {
+   auto itr = boost::find_if(cursors, [](const auto& c) { return !c; });
+   if (itr != cursors.end()) {
+      *itr = std::move(cursor);
+      return itr - cursors.begin();
+   }
+   EOS_ASSERT(cursors.size() < config::MaxOpenCursors, tx_unknown_argument,
+              "Too many open cursors; at most ${max} may be open at once", ("max", config::MaxOpenCursors));
+   cursors.emplace_back(std::move(cursor));
+   return cursors.size() - 1;
+}
+
 } } // namespace eos::chain
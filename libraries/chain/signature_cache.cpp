@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/signature_cache.hpp>
+
+namespace eos { namespace chain {
+
+signature_cache::signature_cache(uint32_t max_size)
+   : _max_size(max_size) {}
+
+void signature_cache::recover(const vector<std::reference_wrapper<const SignedTransaction>>& trxs, worker_pool& pool,
+                              const chain_id_type& chain_id) {
+   pool.for_each_index(trxs.size(), [&](size_t i) {
+      try {
+         get_signature_keys(trxs[i], chain_id);
+      } catch (const fc::exception&) {
+         // Malformed signatures are reported when the transaction's authorization is checked
+      }
+   });
+}
+
+flat_set<public_key_type> signature_cache::get_signature_keys(const SignedTransaction& trx,
+                                                              const chain_id_type& chain_id) {
+   auto id = trx.id();
+   if (auto keys = find(id, trx, chain_id))
+      return std::move(*keys);
+
+   // Recover outside of the lock; if two threads race on the same transaction they compute the same result
+   entry e{id, chain_id, trx.signatures, trx.get_signature_keys(chain_id)};
+   auto keys = e.keys;
+   insert(std::move(e));
+   return keys;
+}
+
+size_t signature_cache::size()const {
+   std::lock_guard<std::mutex> lock(_mutex);
+   return _entries.size();
+}
+
+void signature_cache::clear() {
+   std::lock_guard<std::mutex> lock(_mutex);
+   _entries.clear();
+}
+
+optional<flat_set<public_key_type>> signature_cache::find(const transaction_id_type& id, const SignedTransaction& trx,
+                                                          const chain_id_type& chain_id)const {
+   std::lock_guard<std::mutex> lock(_mutex);
+   const auto& by_trx_id = _entries.get<by_id>();
+   auto itr = by_trx_id.find(id);
+   if (itr == by_trx_id.end() || itr->chain_id != chain_id || itr->signatures != trx.signatures)
+      return optional<flat_set<public_key_type>>();
+   return itr->keys;
+}
+
+void signature_cache::insert(entry&& e) {
+   std::lock_guard<std::mutex> lock(_mutex);
+   auto& by_trx_id = _entries.get<by_id>();
+   auto itr = by_trx_id.find(e.id);
+   if (itr != by_trx_id.end())
+      by_trx_id.erase(itr);
+
+   _entries.emplace_back(std::move(e));
+   while (_entries.size() > _max_size)
+      _entries.pop_front();
+}
+
+} } // eos::chain
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/snapshot.hpp>
+
+#include <fc/filesystem.hpp>
+
+namespace eos { namespace chain {
+
+snapshot_writer::snapshot_writer(const fc::path& file)
+   : _file(file) {
+   _out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+   _out.open(file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+}
+
+void snapshot_writer::write_header(const snapshot_header& header) {
+   write_record(fc::raw::pack(header));
+}
+
+void snapshot_writer::write_section(const string& type_name, uint64_t row_count) {
+   write_record(fc::raw::pack(std::make_pair(type_name, row_count)));
+}
+
+void snapshot_writer::write_record(const vector<char>& record) {
+   FC_ASSERT(record.size() <= std::numeric_limits<uint32_t>::max(), "Snapshot record is too large");
+   uint32_t size = record.size();
+   _checksum.write((const char*)&size, sizeof(size));
+   _checksum.write(record.data(), record.size());
+   _out.write((const char*)&size, sizeof(size));
+   _out.write(record.data(), record.size());
+}
+
+void snapshot_writer::finish() {
+   auto checksum = _checksum.result();
+   _out.write(checksum.data(), checksum.data_size());
+   _out.close();
+}
+
+snapshot_reader::snapshot_reader(const fc::path& file)
+   : _file(file) {
+   FC_ASSERT(fc::exists(file), "Snapshot ${f} does not exist", ("f", file.generic_string()));
+   _in.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+   _in.open(file.generic_string().c_str(), std::ios::in | std::ios::binary);
+
+   const auto file_size = fc::file_size(file);
+   FC_ASSERT(file_size >= sizeof(fc::sha256), "Snapshot ${f} is truncated", ("f", file.generic_string()));
+   _end = file_size - sizeof(fc::sha256);
+
+   // Check the whole file before restoring anything from it, rather than discovering corruption halfway through
+   fc::sha256::encoder enc;
+   vector<char> buffer(1024*1024);
+   for (uint64_t pos = 0; pos < _end; ) {
+      auto chunk = std::min<uint64_t>(buffer.size(), _end - pos);
+      _in.read(buffer.data(), chunk);
+      enc.write(buffer.data(), chunk);
+      pos += chunk;
+   }
+   fc::sha256 expected;
+   _in.read(expected.data(), expected.data_size());
+   FC_ASSERT(enc.result() == expected, "Snapshot ${f} is corrupt: checksum mismatch", ("f", file.generic_string()));
+
+   _in.seekg(0);
+}
+
+vector<char> snapshot_reader::read_record() {
+   FC_ASSERT(uint64_t(_in.tellg()) + sizeof(uint32_t) <= _end, "Unexpected end of snapshot ${f}",
+             ("f", _file.generic_string()));
+   uint32_t size;
+   _in.read((char*)&size, sizeof(size));
+   FC_ASSERT(uint64_t(_in.tellg()) + size <= _end, "Unexpected end of snapshot ${f}", ("f", _file.generic_string()));
+   vector<char> record(size);
+   if (size)
+      _in.read(record.data(), size);
+   return record;
+}
+
+snapshot_header snapshot_reader::read_header() {
+   auto header = fc::raw::unpack<snapshot_header>(read_record());
+   FC_ASSERT(header.magic == snapshot_header::magic_number, "${f} is not a snapshot", ("f", _file.generic_string()));
+   FC_ASSERT(header.version == snapshot_header::current_version, "Unsupported snapshot version ${v}",
+             ("v", header.version)("supported", snapshot_header::current_version));
+   return header;
+}
+
+uint64_t snapshot_reader::read_section(const string& type_name) {
+   auto section = fc::raw::unpack<std::pair<string,uint64_t>>(read_record());
+   FC_ASSERT(section.first == type_name, "Expected snapshot section for ${expected} but found ${found}",
+             ("expected", type_name)("found", section.first));
+   return section.second;
+}
+
+int64_t snapshot_reader::peek_row_id() {
+   if (!_row_pending) {
+      _row = read_record();
+      _row_pending = true;
+   }
+   FC_ASSERT(_row.size() >= sizeof(int64_t), "Snapshot row is truncated");
+   return fc::raw::unpack<int64_t>(_row);
+}
+
+void snapshot_reader::check_end() {
+   FC_ASSERT(!_row_pending && uint64_t(_in.tellg()) == _end, "Snapshot ${f} has unread records",
+             ("f", _file.generic_string()));
+}
+
+} } // eos::chain
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/softfloat.hpp>
+
+#include <fc/exception/exception.hpp>
+
+namespace eos { namespace chain { namespace softfloat {
+
+typedef unsigned __int128 uint128;
+
+/*
+ * Internally a finite nonzero value is a sign, an exponent and a significand. The significand handed to round_pack
+ * has its leading one at bit 62, with the bits below bit 10 to be rounded off; the exponent is one less than the
+ * biased exponent of the result, as adding the leading one into the exponent field when packing makes up the
+ * difference. Bits shifted out of a significand are "jammed" into its lowest bit, so rounding can tell an exact
+ * halfway case from one that is just above it.
+ */
+
+static inline bool sign_of(uint64_t a) { return a >> 63; }
+static inline int32_t exp_of(uint64_t a) { return (a >> 52) & 0x7ff; }
+static inline uint64_t frac_of(uint64_t a) { return a & 0x000fffffffffffffull; }
+static inline uint64_t pack(bool sign, int32_t exp, uint64_t sig) {
+   return (uint64_t(sign) << 63) + (uint64_t(exp) << 52) + sig;
+}
+static inline uint64_t infinity(bool sign) { return pack(sign, 0x7ff, 0); }
+
+static inline int clz64(uint64_t a) { return a ? __builtin_clzll(a) : 64; }
+static inline int clz128(uint128 a) {
+   uint64_t high = uint64_t(a >> 64);
+   return high ? clz64(high) : 64 + clz64(uint64_t(a));
+}
+
+static inline uint64_t shift_right_jam64(uint64_t a, uint32_t dist) {
+   if (!dist)
+      return a;
+   return dist < 63 ? a >> dist | (uint64_t(a << (-dist & 63)) != 0) : (a != 0);
+}
+static inline uint128 shift_right_jam128(uint128 a, uint32_t dist) {
+   if (!dist)
+      return a;
+   return dist < 127 ? a >> dist | (uint128(a << (-dist & 127)) != 0) : (a != 0);
+}
+
+/// Normalize the fraction of a subnormal so its leading one is at bit 52, and return the matching exponent
+static inline int32_t normalize_subnormal(uint64_t& sig) {
+   int shift = clz64(sig) - 11;
+   sig <<= shift;
+   return 1 - shift;
+}
+
+static uint64_t round_pack(bool sign, int32_t exp, uint64_t sig) {
+   uint64_t round_bits = sig & 0x3ff;
+   if (exp < 0 || exp >= 0x7fd) {
+      if (exp < 0) {
+         sig = shift_right_jam64(sig, -exp);
+         exp = 0;
+         round_bits = sig & 0x3ff;
+      } else if (exp > 0x7fd || sig + 0x200 >= 0x8000000000000000ull) {
+         return infinity(sign);
+      }
+   }
+   sig = (sig + 0x200) >> 10;
+   // Ties go to even
+   if (round_bits == 0x200)
+      sig &= ~uint64_t(1);
+   if (!sig)
+      exp = 0;
+   return pack(sign, exp, sig);
+}
+
+static uint64_t norm_round_pack(bool sign, int32_t exp, uint64_t sig) {
+   int shift = clz64(sig) - 1;
+   exp -= shift;
+   if (shift >= 10 && exp >= 0 && exp < 0x7fd)
+      return pack(sign, sig ? exp : 0, sig << (shift - 10));
+   return round_pack(sign, exp, sig << shift);
+}
+
+/// Round sig * 2^exp, for any nonzero 128 bit sig
+static uint64_t round_pack128(bool sign, int32_t exp, uint128 sig) {
+   int shift = clz128(sig) - 1;
+   sig <<= shift;
+   exp -= shift;
+   // The leading one is now at bit 126; keep the top 64 bits, jamming the rest
+   uint64_t sig64 = uint64_t(sig >> 64) | (uint64_t(sig) != 0);
+   return round_pack(sign, exp + 126 + 0x3fe, sig64);
+}
+
+static uint64_t add_magnitudes(uint64_t a, uint64_t b, bool sign) {
+   int32_t exp_a = exp_of(a), exp_b = exp_of(b);
+   uint64_t sig_a = frac_of(a), sig_b = frac_of(b);
+   int32_t exp_diff = exp_a - exp_b;
+   int32_t exp;
+   uint64_t sig;
+
+   if (!exp_diff) {
+      if (!exp_a)
+         return a + sig_b;
+      if (exp_a == 0x7ff)
+         return (sig_a | sig_b) ? canonical_nan : a;
+      exp = exp_a;
+      sig = (0x0020000000000000ull + sig_a + sig_b) << 9;
+   } else {
+      sig_a <<= 9;
+      sig_b <<= 9;
+      if (exp_diff < 0) {
+         if (exp_b == 0x7ff)
+            return sig_b ? canonical_nan : infinity(sign);
+         exp = exp_b;
+         sig_a = exp_a ? sig_a + 0x2000000000000000ull : sig_a << 1;
+         sig_a = shift_right_jam64(sig_a, -exp_diff);
+      } else {
+         if (exp_a == 0x7ff)
+            return sig_a ? canonical_nan : a;
+         exp = exp_a;
+         sig_b = exp_b ? sig_b + 0x2000000000000000ull : sig_b << 1;
+         sig_b = shift_right_jam64(sig_b, exp_diff);
+      }
+      sig = 0x2000000000000000ull + sig_a + sig_b;
+      if (sig < 0x4000000000000000ull) {
+         --exp;
+         sig <<= 1;
+      }
+   }
+   return round_pack(sign, exp, sig);
+}
+
+static uint64_t sub_magnitudes(uint64_t a, uint64_t b, bool sign) {
+   int32_t exp_a = exp_of(a), exp_b = exp_of(b);
+   uint64_t sig_a = frac_of(a), sig_b = frac_of(b);
+   int32_t exp_diff = exp_a - exp_b;
+
+   if (!exp_diff) {
+      if (exp_a == 0x7ff)
+         return canonical_nan;
+      int64_t sig_diff = int64_t(sig_a - sig_b);
+      if (!sig_diff)
+         return pack(false, 0, 0);
+      if (exp_a)
+         --exp_a;
+      if (sig_diff < 0) {
+         sign = !sign;
+         sig_diff = -sig_diff;
+      }
+      int shift = clz64(sig_diff) - 11;
+      int32_t exp = exp_a - shift;
+      if (exp < 0) {
+         shift = exp_a;
+         exp = 0;
+      }
+      return pack(sign, exp, uint64_t(sig_diff) << shift);
+   }
+
+   int32_t exp;
+   uint64_t sig;
+   sig_a <<= 10;
+   sig_b <<= 10;
+   if (exp_diff < 0) {
+      sign = !sign;
+      if (exp_b == 0x7ff)
+         return sig_b ? canonical_nan : infinity(sign);
+      sig_a += exp_a ? 0x4000000000000000ull : sig_a;
+      sig_a = shift_right_jam64(sig_a, -exp_diff);
+      sig_b |= 0x4000000000000000ull;
+      exp = exp_b;
+      sig = sig_b - sig_a;
+   } else {
+      if (exp_a == 0x7ff)
+         return sig_a ? canonical_nan : a;
+      sig_b += exp_b ? 0x4000000000000000ull : sig_b;
+      sig_b = shift_right_jam64(sig_b, exp_diff);
+      sig_a |= 0x4000000000000000ull;
+      exp = exp_a;
+      sig = sig_a - sig_b;
+   }
+   return norm_round_pack(sign, exp - 1, sig);
+}
+
+uint64_t f64_add(uint64_t a, uint64_t b) {
+   if (f64_is_nan(a) || f64_is_nan(b))
+      return canonical_nan;
+   if (sign_of(a) == sign_of(b))
+      return add_magnitudes(a, b, sign_of(a));
+   return sub_magnitudes(a, b, sign_of(a));
+}
+
+uint64_t f64_sub(uint64_t a, uint64_t b) {
+   return f64_add(a, b ^ 0x8000000000000000ull);
+}
+
+uint64_t f64_mul(uint64_t a, uint64_t b) {
+   if (f64_is_nan(a) || f64_is_nan(b))
+      return canonical_nan;
+   bool sign = sign_of(a) ^ sign_of(b);
+   int32_t exp_a = exp_of(a), exp_b = exp_of(b);
+   uint64_t sig_a = frac_of(a), sig_b = frac_of(b);
+
+   if (exp_a == 0x7ff || exp_b == 0x7ff)
+      // Infinity times zero is invalid
+      return (f64_is_zero(a) || f64_is_zero(b)) ? canonical_nan : infinity(sign);
+   if ((!exp_a && !sig_a) || (!exp_b && !sig_b))
+      return pack(sign, 0, 0);
+   if (!exp_a)
+      exp_a = normalize_subnormal(sig_a);
+   if (!exp_b)
+      exp_b = normalize_subnormal(sig_b);
+
+   int32_t exp = exp_a + exp_b - 0x3ff;
+   sig_a = (sig_a | 0x0010000000000000ull) << 10;
+   sig_b = (sig_b | 0x0010000000000000ull) << 11;
+   uint128 product = uint128(sig_a) * sig_b;
+   uint64_t sig = uint64_t(product >> 64) | (uint64_t(product) != 0);
+   if (sig < 0x4000000000000000ull) {
+      --exp;
+      sig <<= 1;
+   }
+   return round_pack(sign, exp, sig);
+}
+
+uint64_t f64_div(uint64_t a, uint64_t b) {
+   if (f64_is_nan(a) || f64_is_nan(b))
+      return canonical_nan;
+   bool sign = sign_of(a) ^ sign_of(b);
+   int32_t exp_a = exp_of(a), exp_b = exp_of(b);
+   uint64_t sig_a = frac_of(a), sig_b = frac_of(b);
+
+   if (exp_a == 0x7ff)
+      return exp_b == 0x7ff ? canonical_nan : infinity(sign);
+   if (exp_b == 0x7ff)
+      return pack(sign, 0, 0);
+   if (!exp_b) {
+      if (!sig_b)
+         return f64_is_zero(a) ? canonical_nan : infinity(sign);
+      exp_b = normalize_subnormal(sig_b);
+   }
+   if (!exp_a) {
+      if (!sig_a)
+         return pack(sign, 0, 0);
+      exp_a = normalize_subnormal(sig_a);
+   }
+
+   sig_a |= 0x0010000000000000ull;
+   sig_b |= 0x0010000000000000ull;
+   int32_t exp = exp_a - exp_b + 0x3fe;
+   // Scale the dividend so the quotient has its leading one at bit 62
+   uint128 dividend = uint128(sig_a) << 62;
+   if (sig_a < sig_b) {
+      --exp;
+      dividend <<= 1;
+   }
+   uint64_t sig = uint64_t(dividend / sig_b);
+   sig |= (uint64_t(dividend % sig_b) != 0);
+   return round_pack(sign, exp, sig);
+}
+
+uint64_t f64_sqrt(uint64_t a) {
+   if (f64_is_nan(a))
+      return canonical_nan;
+   if (f64_is_zero(a))
+      return a;
+   if (sign_of(a))
+      return canonical_nan;
+   int32_t exp_a = exp_of(a);
+   uint64_t sig_a = frac_of(a);
+   if (exp_a == 0x7ff)
+      return a;
+   if (!exp_a)
+      exp_a = normalize_subnormal(sig_a);
+   sig_a |= 0x0010000000000000ull;
+
+   // a = sig_a * 2^(e - 52); make the exponent even, so that the root of sig_a * 2^72 has its leading one at bit 62
+   int32_t e = exp_a - 0x3ff;
+   if (e & 1) {
+      sig_a <<= 1;
+      --e;
+   }
+   uint128 radicand = uint128(sig_a) << 72;
+
+   // Newton's method from above converges on the floor of the root
+   uint64_t root = 0x8000000000000000ull;
+   for (;;) {
+      uint64_t next = uint64_t((root + uint128(radicand / root)) >> 1);
+      if (next >= root)
+         break;
+      root = next;
+   }
+   uint64_t sig = root | (uint128(root) * root != radicand);
+   return round_pack(false, e / 2 + 0x3fe, sig);
+}
+
+uint64_t f64_fma(uint64_t a, uint64_t b, uint64_t c) {
+   if (f64_is_nan(a) || f64_is_nan(b) || f64_is_nan(c))
+      return canonical_nan;
+   bool sign_product = sign_of(a) ^ sign_of(b);
+   int32_t exp_a = exp_of(a), exp_b = exp_of(b), exp_c = exp_of(c);
+   uint64_t sig_a = frac_of(a), sig_b = frac_of(b), sig_c = frac_of(c);
+
+   if (exp_a == 0x7ff || exp_b == 0x7ff) {
+      if (f64_is_zero(a) || f64_is_zero(b))
+         return canonical_nan;
+      if (exp_c == 0x7ff && sign_of(c) != sign_product)
+         return canonical_nan;
+      return infinity(sign_product);
+   }
+   if (exp_c == 0x7ff)
+      return c;
+
+   bool product_is_zero = f64_is_zero(a) || f64_is_zero(b);
+   if (product_is_zero)
+      // Exact, and gives the sign of zero the sum of two zeros would have
+      return f64_add(pack(sign_product, 0, 0), c);
+
+   if (!exp_a)
+      exp_a = normalize_subnormal(sig_a);
+   if (!exp_b)
+      exp_b = normalize_subnormal(sig_b);
+   sig_a |= 0x0010000000000000ull;
+   sig_b |= 0x0010000000000000ull;
+
+   // The exact product is product * 2^exp_product
+   uint128 product = uint128(sig_a) * sig_b;
+   int32_t exp_product = exp_a + exp_b - 2 * (0x3ff + 52);
+   if (f64_is_zero(c))
+      return round_pack128(sign_product, exp_product, product);
+
+   if (!exp_c)
+      exp_c = normalize_subnormal(sig_c);
+   uint128 addend = sig_c | 0x0010000000000000ull;
+   int32_t exp_addend = exp_c - (0x3ff + 52);
+
+   // Put the larger operand's leading one at bit 125, leaving room for a carry, and align the other to it
+   int shift = clz128(product) - 2;
+   product <<= shift;
+   exp_product -= shift;
+   shift = clz128(addend) - 2;
+   addend <<= shift;
+   exp_addend -= shift;
+
+   int32_t exp;
+   if (exp_product >= exp_addend) {
+      addend = shift_right_jam128(addend, exp_product - exp_addend);
+      exp = exp_product;
+   } else {
+      product = shift_right_jam128(product, exp_addend - exp_product);
+      exp = exp_addend;
+   }
+
+   bool sign_c = sign_of(c);
+   if (sign_product == sign_c)
+      return round_pack128(sign_c, exp, product + addend);
+   if (product == addend)
+      return pack(false, 0, 0);
+   if (product > addend)
+      return round_pack128(sign_product, exp, product - addend);
+   return round_pack128(sign_c, exp, addend - product);
+}
+
+bool f64_eq(uint64_t a, uint64_t b) {
+   if (f64_is_nan(a) || f64_is_nan(b))
+      return false;
+   return a == b || (f64_is_zero(a) && f64_is_zero(b));
+}
+
+bool f64_lt(uint64_t a, uint64_t b) {
+   if (f64_is_nan(a) || f64_is_nan(b))
+      return false;
+   bool sign_a = sign_of(a), sign_b = sign_of(b);
+   if (sign_a != sign_b)
+      return sign_a && !(f64_is_zero(a) && f64_is_zero(b));
+   return a != b && (sign_a ^ (a < b));
+}
+
+bool f64_le(uint64_t a, uint64_t b) {
+   if (f64_is_nan(a) || f64_is_nan(b))
+      return false;
+   bool sign_a = sign_of(a), sign_b = sign_of(b);
+   if (sign_a != sign_b)
+      return sign_a || (f64_is_zero(a) && f64_is_zero(b));
+   return a == b || (sign_a ^ (a < b));
+}
+
+uint64_t i64_to_f64(int64_t a) {
+   if (!a)
+      return 0;
+   bool sign = a < 0;
+   uint64_t magnitude = sign ? -uint64_t(a) : uint64_t(a);
+   return norm_round_pack(sign, 0x43c, magnitude);
+}
+
+uint64_t f64_to_ui64(uint64_t a) {
+   FC_ASSERT(!f64_is_nan(a), "Could not convert NaN to integer");
+   int32_t exp = exp_of(a);
+   if (exp == 0x7ff)
+      return uint64_t(-1);
+   if (exp < 0x3ff)
+      return 0;
+   int32_t e = exp - 0x3ff;
+   if (e >= 168)
+      return uint64_t(-1);
+   uint64_t sig = frac_of(a) | 0x0010000000000000ull;
+   if (e <= 52)
+      return sig >> (52 - e);
+   return e - 52 < 64 ? sig << (e - 52) : 0;
+}
+
+} } } // eos::chain::softfloat
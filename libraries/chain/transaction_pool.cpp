@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/transaction_pool.hpp>
+#include <eos/chain/exceptions.hpp>
+
+#include <fc/io/raw.hpp>
+
+namespace eos { namespace chain {
+
+transaction_pool::transaction_pool(uint32_t max_count, uint64_t max_packed_size)
+   : _max_count(max_count), _max_packed_size(max_packed_size) {}
+
+bool transaction_pool::add(const SignedTransaction& trx, const transaction_id_type& id) {
+   if (contains(id))
+      return false;
+
+   auto size = fc::raw::pack_size(trx);
+   EOS_ASSERT(_entries.size() < _max_count && _packed_size + size <= _max_packed_size, tx_resource_exhausted,
+              "Pending transaction pool is full", ("transactions", _entries.size())("bytes", _packed_size));
+
+   const auto arrival = _next_arrival++;
+   _entries.insert(entry{id, trx, arrival, uint32_t(size)});
+   for (const auto& scope : trx.scope)
+      _scopes.emplace(scope, arrival);
+   _packed_size += size;
+   return true;
+}
+
+bool transaction_pool::contains(const transaction_id_type& id)const {
+   return find(id) != nullptr;
+}
+
+const transaction_pool::entry* transaction_pool::find(const transaction_id_type& id)const {
+   auto itr = _entries.find(id);
+   return itr == _entries.end()? nullptr : &*itr;
+}
+
+bool transaction_pool::remove(const transaction_id_type& id) {
+   auto itr = _entries.find(id);
+   if (itr == _entries.end())
+      return false;
+   erase(itr);
+   return true;
+}
+
+void transaction_pool::clear() {
+   _entries.clear();
+   _scopes.clear();
+   _written_scopes.clear();
+   _packed_size = 0;
+}
+
+transaction_pool::entry_index::iterator transaction_pool::erase(entry_index::iterator itr) {
+   for (const auto& scope : itr->trx.scope)
+      _scopes.erase(std::make_pair(scope, itr->arrival));
+   _packed_size -= itr->packed_size;
+   return _entries.erase(itr);
+}
+
+size_t transaction_pool::remove_expired(time_point_sec now) {
+   auto& by_exp = _entries.get<by_expiration>();
+   size_t removed = 0;
+   for (auto itr = by_exp.begin(); itr != by_exp.end() && itr->expiration() <= now; itr = by_exp.begin()) {
+      erase(_entries.project<0>(itr));
+      ++removed;
+   }
+   return removed;
+}
+
+void transaction_pool::remove_included(const signed_block& block, const vector<transaction_id_type>& user_input_ids) {
+   for (const auto& id : user_input_ids)
+      remove(id);
+
+   for (const auto& cycle : block.cycles)
+      for (const auto& thread : cycle)
+         for (const auto& trx : thread.user_input)
+            _written_scopes.insert(trx.scope.begin(), trx.scope.end());
+}
+
+vector<transaction_id_type> transaction_pool::take_conflicting() {
+   flat_set<uint64_t> arrivals;
+   for (const auto& scope : _written_scopes)
+      for (auto itr = _scopes.lower_bound(std::make_pair(scope, uint64_t(0)));
+           itr != _scopes.end() && itr->first == scope; ++itr)
+         arrivals.insert(itr->second);
+   _written_scopes.clear();
+
+   vector<transaction_id_type> ids;
+   ids.reserve(arrivals.size());
+   const auto& by_arr = _entries.get<by_arrival>();
+   for (auto arrival : arrivals)
+      ids.emplace_back(by_arr.find(arrival)->id);
+   return ids;
+}
+
+} } // eos::chain
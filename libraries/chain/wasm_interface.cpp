@@ -2,6 +2,7 @@
 #include <boost/multiprecision/cpp_bin_float.hpp>
 #include <eos/chain/wasm_interface.hpp>
 #include <eos/chain/chain_controller.hpp>
+#include <eos/chain/softfloat.hpp>
 #include "Platform/Platform.h"
 #include "WAST/WAST.h"
 #include "Runtime/Runtime.h"
@@ -12,28 +13,175 @@
 #include "IR/Validate.h"
 #include <eos/chain/key_value_object.hpp>
 #include <eos/chain/account_object.hpp>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
 
 namespace eos { namespace chain {
    using namespace IR;
    using namespace Runtime;
    typedef boost::multiprecision::cpp_bin_float_50 DOUBLE;
 
-   wasm_interface::wasm_interface() {
-   }
-
 #ifdef NDEBUG
    const int CHECKTIME_LIMIT = 3000;
 #else
    const int CHECKTIME_LIMIT = 18000;
 #endif
 
-DEFINE_INTRINSIC_FUNCTION0(env,checktime,checktime,none) {
-   auto dur = wasm_interface::get().current_execution_time();
-   if (dur > CHECKTIME_LIMIT) {
-      wlog("checktime called ${d}", ("d", dur));
-      throw checktime_exceeded();
+   /**
+    *  Raises the checktime_expired flag of the interface once the contract being executed has run for
+    *  CHECKTIME_LIMIT. The checktime calls injected into contracts only test that flag, so how far a contract can
+    *  run past the limit does not depend on how much work it does between two checks.
+    *
+    *  The deadline and the flag only change under the mutex, so a deadline that passes while a new call is being
+    *  started cannot expire that new call.
+    */
+   class checktime_watchdog {
+      public:
+         explicit checktime_watchdog( std::atomic<bool>& expired )
+         :expired(expired),thread( [this]{ run(); } ) {}
+
+         ~checktime_watchdog() {
+            {
+               std::lock_guard<std::mutex> lock( mutex );
+               stopping = true;
+            }
+            wake.notify_one();
+            thread.join();
+         }
+
+         void start( std::chrono::microseconds limit ) {
+            std::unique_lock<std::mutex> lock( mutex );
+            expired.store( false, std::memory_order_relaxed );
+            auto next = clock::now() + limit;
+            // The watchdog only has to be woken up when it would otherwise sleep past the new deadline
+            bool earlier = next < deadline;
+            deadline = next;
+            lock.unlock();
+            if( earlier )
+               wake.notify_one();
+         }
+
+         /// Stops the clock of the current call; a call that has already expired stays expired
+         void pause() {
+            std::lock_guard<std::mutex> lock( mutex );
+            if( deadline != clock::time_point::max() ) {
+               remaining = deadline - clock::now();
+               deadline = clock::time_point::max();
+               paused = true;
+            }
+         }
+
+         /// Gives the current call what was left of its time when it was paused
+         void resume() {
+            std::unique_lock<std::mutex> lock( mutex );
+            if( !paused )
+               return;
+            paused = false;
+            deadline = clock::now() + remaining;
+            lock.unlock();
+            wake.notify_one();
+         }
+
+      private:
+         typedef std::chrono::steady_clock clock;
+
+         void run() {
+            std::unique_lock<std::mutex> lock( mutex );
+            while( !stopping ) {
+               if( clock::now() >= deadline ) {
+                  expired.store( true, std::memory_order_relaxed );
+                  deadline = clock::time_point::max();
+               }
+               if( deadline == clock::time_point::max() )
+                  wake.wait( lock );
+               else
+                  wake.wait_until( lock, deadline );
+            }
+         }
+
+         std::atomic<bool>&       expired;
+         std::mutex               mutex;
+         std::condition_variable  wake;
+         clock::time_point        deadline = clock::time_point::max();
+         clock::duration          remaining = clock::duration::zero();
+         bool                     paused = false;
+         bool                     stopping = false;
+         std::thread              thread;
+   };
+
+   namespace {
+      /**
+       * The wasm-jit runtime keeps the objects it creates in process-wide lists, so instantiating and freeing
+       * modules is serialized across the per-thread interfaces. Every interface registers itself so the instances
+       * of all threads are kept alive when unreferenced objects are freed.
+       */
+      std::mutex                 runtime_mutex;
+      std::set<wasm_interface*>  interfaces;
+   }
+
+   uint32_t wasm_interface::max_instances = config::DefaultMaxWasmInstances;
+   uint32_t wasm_interface::uncollected_instances = 0;
+
+   namespace {
+      /// Lets the other block threads of the cycle use the database while the calling thread runs contract code
+      class database_release {
+         public:
+            explicit database_release( std::unique_lock<std::mutex>* lock ):lock(lock) {
+               if( lock )
+                  lock->unlock();
+            }
+            ~database_release() {
+               if( lock )
+                  lock->lock();
+            }
+
+         private:
+            std::unique_lock<std::mutex>* lock;
+      };
+
+      /**
+       *  Takes the database back for an intrinsic called by contract code. The time spent waiting for the other
+       *  block threads of the cycle does not count against the contract.
+       */
+      class database_access {
+         public:
+            database_access():wasm( wasm_interface::get() ) {
+               if( wasm.database_lock ) {
+                  wasm.pause_checktime();
+                  wasm.database_lock->lock();
+                  wasm.resume_checktime();
+               }
+            }
+            ~database_access() {
+               if( wasm.database_lock )
+                  wasm.database_lock->unlock();
+            }
+
+         private:
+            wasm_interface& wasm;
+      };
+   }
+
+   wasm_interface::wasm_interface()
+   :watchdog( std::make_shared<checktime_watchdog>( checktime_expired ) ) {
+      std::lock_guard<std::mutex> lock( runtime_mutex );
+      interfaces.insert( this );
+   }
+
+   wasm_interface::~wasm_interface() {
+      std::lock_guard<std::mutex> lock( runtime_mutex );
+      interfaces.erase( this );
+      while( !instances.empty() )
+         free_instance( instances.begin() );
+      collect_garbage();
    }
+
+DEFINE_INTRINSIC_FUNCTION0(env,checktime,checktime,none) {
+   wasm_interface::get().checktime();
 }
    template <typename Function, typename KeyType, int numberOfKeys>
    int32_t validate(int32_t valueptr, int32_t valuelen, Function func) {
@@ -47,6 +195,7 @@ DEFINE_INTRINSIC_FUNCTION0(env,checktime,checktime,none) {
 
       char* value = memoryArrayPtr<char>( wasm.current_memory, valueptr, valuelen );
       KeyType*  keys = reinterpret_cast<KeyType*>(value);
+      database_access access;
       
       valuelen -= keylen;
       value    += keylen;
@@ -100,6 +249,12 @@ DEFINE_INTRINSIC_FUNCTION0(env,checktime,checktime,none) {
    } \
    DEFINE_INTRINSIC_FUNCTION5(env,upper_bound_##FUNCPREFIX##OBJTYPE,upper_bound_##FUNCPREFIX##OBJTYPE,i32,i64,scope,i64,code,i64,table,i32,valueptr,i32,valuelen) { \
       READ_RECORD(upper_bound_record, INDEX, SCOPE); \
+   } \
+   DEFINE_INTRINSIC_FUNCTION5(env,cursor_lower_bound_##FUNCPREFIX##OBJTYPE,cursor_lower_bound_##FUNCPREFIX##OBJTYPE,i32,i64,scope,i64,code,i64,table,i32,valueptr,i32,valuelen) { \
+      auto lambda = [&](apply_context* ctx, INDEX::value_type::key_type* keys, char*, uint32_t) -> int32_t { \
+         return ctx->lower_bound_cursor<INDEX, SCOPE>( Name(scope), Name(code), Name(table), keys); \
+      }; \
+      return validate<decltype(lambda), INDEX::value_type::key_type, INDEX::value_type::number_of_keys>(valueptr, valuelen, lambda); \
    }
 
 DEFINE_RECORD_UPDATE_FUNCTIONS(i64, key_value_index);
@@ -114,6 +269,44 @@ DEFINE_RECORD_READ_FUNCTIONS(i64i64i64, primary_,   key64x64x64_value_index, by_
 DEFINE_RECORD_READ_FUNCTIONS(i64i64i64, secondary_, key64x64x64_value_index, by_scope_secondary);
 DEFINE_RECORD_READ_FUNCTIONS(i64i64i64, tertiary_,  key64x64x64_value_index, by_scope_tertiary);
 
+DEFINE_INTRINSIC_FUNCTION3(env,cursor_read,cursor_read,i32,i32,handle,i32,valueptr,i32,valuelen) {
+   auto& wasm  = wasm_interface::get();
+   FC_ASSERT( wasm.current_apply_context, "no apply context found" );
+   database_access access;
+
+   char* value = memoryArrayPtr<char>( wasm.current_memory, valueptr, valuelen );
+   return wasm.current_apply_context->get_cursor(handle).read(value, valuelen);
+}
+
+DEFINE_INTRINSIC_FUNCTION3(env,cursor_next,cursor_next,i32,i32,handle,i32,valueptr,i32,valuelen) {
+   auto& wasm  = wasm_interface::get();
+   FC_ASSERT( wasm.current_apply_context, "no apply context found" );
+   database_access access;
+
+   char* value = memoryArrayPtr<char>( wasm.current_memory, valueptr, valuelen );
+   auto& cursor = wasm.current_apply_context->get_cursor(handle);
+   if( !cursor.next() ) return -1;
+   return cursor.read(value, valuelen);
+}
+
+DEFINE_INTRINSIC_FUNCTION3(env,cursor_previous,cursor_previous,i32,i32,handle,i32,valueptr,i32,valuelen) {
+   auto& wasm  = wasm_interface::get();
+   FC_ASSERT( wasm.current_apply_context, "no apply context found" );
+   database_access access;
+
+   char* value = memoryArrayPtr<char>( wasm.current_memory, valueptr, valuelen );
+   auto& cursor = wasm.current_apply_context->get_cursor(handle);
+   if( !cursor.previous() ) return -1;
+   return cursor.read(value, valuelen);
+}
+
+DEFINE_INTRINSIC_FUNCTION1(env,cursor_close,cursor_close,none,i32,handle) {
+   auto& wasm  = wasm_interface::get();
+   FC_ASSERT( wasm.current_apply_context, "no apply context found" );
+
+   wasm.current_apply_context->close_cursor(handle);
+}
+
 DEFINE_INTRINSIC_FUNCTION3(env, assert_sha256,assert_sha256,none,i32,dataptr,i32,datalen,i32,hash) {
    FC_ASSERT( datalen > 0 );
 
@@ -156,54 +349,60 @@ DEFINE_INTRINSIC_FUNCTION2(env,diveq_i128,diveq_i128,none,i32,self,i32,other) {
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,double_add,double_add,i64,i64,a,i64,b) {
-   DOUBLE c = DOUBLE(*reinterpret_cast<double *>(&a))
-            + DOUBLE(*reinterpret_cast<double *>(&b));
-   double res = c.convert_to<double>();
-   return *reinterpret_cast<uint64_t *>(&res);
+   return softfloat::f64_add(a, b);
+}
+
+DEFINE_INTRINSIC_FUNCTION2(env,double_sub,double_sub,i64,i64,a,i64,b) {
+   return softfloat::f64_sub(a, b);
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,double_mult,double_mult,i64,i64,a,i64,b) {
-   DOUBLE c = DOUBLE(*reinterpret_cast<double *>(&a))
-            * DOUBLE(*reinterpret_cast<double *>(&b));
-   double res = c.convert_to<double>();
-   return *reinterpret_cast<uint64_t *>(&res);
+   return softfloat::f64_mul(a, b);
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,double_div,double_div,i64,i64,a,i64,b) {
-   auto divisor = DOUBLE(*reinterpret_cast<double *>(&b));
-   FC_ASSERT( divisor != 0, "divide by zero" );
+   FC_ASSERT( !softfloat::f64_is_zero(b), "divide by zero" );
+   return softfloat::f64_div(a, b);
+}
+
+DEFINE_INTRINSIC_FUNCTION1(env,double_sqrt,double_sqrt,i64,i64,a) {
+   return softfloat::f64_sqrt(a);
+}
 
-   DOUBLE c = DOUBLE(*reinterpret_cast<double *>(&a)) / divisor;
-   double res = c.convert_to<double>();
-   return *reinterpret_cast<uint64_t *>(&res);
+DEFINE_INTRINSIC_FUNCTION3(env,double_fma,double_fma,i64,i64,a,i64,b,i64,c) {
+   return softfloat::f64_fma(a, b, c);
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,double_lt,double_lt,i32,i64,a,i64,b) {
-   return DOUBLE(*reinterpret_cast<double *>(&a))
-        < DOUBLE(*reinterpret_cast<double *>(&b));
+   return softfloat::f64_lt(a, b);
+}
+
+DEFINE_INTRINSIC_FUNCTION2(env,double_le,double_le,i32,i64,a,i64,b) {
+   return softfloat::f64_le(a, b);
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,double_eq,double_eq,i32,i64,a,i64,b) {
-   return DOUBLE(*reinterpret_cast<double *>(&a))
-       == DOUBLE(*reinterpret_cast<double *>(&b));
+   return softfloat::f64_eq(a, b);
+}
+
+DEFINE_INTRINSIC_FUNCTION2(env,double_ge,double_ge,i32,i64,a,i64,b) {
+   return softfloat::f64_le(b, a);
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,double_gt,double_gt,i32,i64,a,i64,b) {
-   return DOUBLE(*reinterpret_cast<double *>(&a))
-        > DOUBLE(*reinterpret_cast<double *>(&b));
+   return softfloat::f64_lt(b, a);
 }
 
 DEFINE_INTRINSIC_FUNCTION1(env,double_to_i64,double_to_i64,i64,i64,a) {
-   return DOUBLE(*reinterpret_cast<double *>(&a))
-          .convert_to<uint64_t>();
+   return softfloat::f64_to_ui64(a);
 }
 
 DEFINE_INTRINSIC_FUNCTION1(env,i64_to_double,i64_to_double,i64,i64,a) {
-   double res = DOUBLE(a).convert_to<double>();
-   return *reinterpret_cast<uint64_t *>(&res);
+   return softfloat::i64_to_f64(a);
 }
 
 DEFINE_INTRINSIC_FUNCTION0(env,now,now,i32) {
+   database_access access;
    return wasm_interface::get().current_validate_context->controller.head_block_time().sec_since_epoch();
 }
 
@@ -257,6 +456,7 @@ DEFINE_INTRINSIC_FUNCTION3(env,memset,memset,i32,i32,rel_ptr,i32,value,i32,len)
  */ 
 
 DEFINE_INTRINSIC_FUNCTION0(env,transactionCreate,transactionCreate,i32) {
+   database_access access;
    auto& ptrx = wasm_interface::get().current_apply_context->create_pending_transaction();
    return ptrx.handle;
 }
@@ -269,6 +469,7 @@ static void emplace_scope(const Name& scope, std::vector<Name>& scopes) {
 }
 
 DEFINE_INTRINSIC_FUNCTION3(env,transactionRequireScope,transactionRequireScope,none,i32,handle,i64,scope,i32,readOnly) {
+   database_access access;
    auto& ptrx = wasm_interface::get().current_apply_context->get_pending_transaction(handle);
    if(readOnly == 0) {
       emplace_scope(scope, ptrx.scope);
@@ -280,6 +481,7 @@ DEFINE_INTRINSIC_FUNCTION3(env,transactionRequireScope,transactionRequireScope,n
 }
 
 DEFINE_INTRINSIC_FUNCTION2(env,transactionAddMessage,transactionAddMessage,none,i32,handle,i32,msg_handle) {
+   database_access access;
    auto apply_context  = wasm_interface::get().current_apply_context;
    auto& ptrx = apply_context->get_pending_transaction(handle);
    auto& pmsg = apply_context->get_pending_message(msg_handle);
@@ -323,6 +525,7 @@ DEFINE_INTRINSIC_FUNCTION4(env,messageCreate,messageCreate,i32,i64,code,i64,type
       }
    }
 
+   database_access access;
    auto& pmsg = wasm.current_apply_context->create_pending_message(Name(code), Name(type), payload);
    return pmsg.handle;
 }
@@ -421,14 +624,13 @@ DEFINE_INTRINSIC_FUNCTION1(env,free,free,none,i32,ptr) {
 }
 
    wasm_interface& wasm_interface::get() {
-      static wasm_interface*  wasm = nullptr;
-      if( !wasm )
-      {
+      static std::once_flag runtime_initialized;
+      std::call_once( runtime_initialized, [] {
          wlog( "Runtime::init" );
          Runtime::init();
-         wasm = new wasm_interface();
-      }
-      return *wasm;
+      });
+      thread_local wasm_interface wasm;
+      return wasm;
    }
 
 
@@ -451,54 +653,62 @@ DEFINE_INTRINSIC_FUNCTION1(env,free,free,none,i32,ptr) {
       return (fc::time_point::now() - checktimeStart).count();
    }
 
+   void wasm_interface::start_checktime() {
+      checktimeStart = fc::time_point::now();
+      watchdog->start( std::chrono::microseconds( CHECKTIME_LIMIT ) );
+   }
+
+   void wasm_interface::pause_checktime() {
+      watchdog->pause();
+   }
+
+   void wasm_interface::resume_checktime() {
+      watchdog->resume();
+   }
+
+   void wasm_interface::checktime_expired_throw() {
+      wlog("checktime called ${d}", ("d", current_execution_time()));
+      throw checktime_exceeded();
+   }
+
 
    char* wasm_interface::vm_allocate( int bytes ) {
-      FunctionInstance* alloc_function = asFunctionNullable(getInstanceExport(current_module,"alloc"));
-      const FunctionType* functionType = getFunctionType(alloc_function);
-      FC_ASSERT( functionType->parameters.size() == 1 );
-      std::vector<Value> invokeArgs(1);
-      invokeArgs[0] = U32(bytes);
+      const auto& alloc = current_state->alloc_entry;
+      FC_ASSERT( alloc.function && alloc.ret == ResultType::i32, "no alloc method found" );
+      U64 args[2] = { U32(bytes) };
 
-      checktimeStart = fc::time_point::now();
+      start_checktime();
 
-      auto result = Runtime::invokeFunction(alloc_function,invokeArgs);
+      database_release release( database_lock );
+      Runtime::invokeBoundFunction( alloc, args );
 
-      return &memoryRef<char>( current_memory, result.i32 );
+      return &memoryRef<char>( current_memory, U32(args[1]) );
    }
 
    U32 wasm_interface::vm_pointer_to_offset( char* ptr ) {
       return U32(ptr - &memoryRef<char>(current_memory,0));
    }
 
-   void  wasm_interface::vm_call( const char* name ) {
+   void  wasm_interface::vm_call( const Runtime::BoundFunction& entry, const char* name ) {
    try {
       try {
-         /*
-         name += "_" + std::string( current_validate_context->msg.code ) + "_";
-         name += std::string( current_validate_context->msg.type );
-         */
-         /// TODO: cache this somehow
-         FunctionInstance* call = asFunctionNullable(getInstanceExport(current_module,name) );
-         if( !call ) {
-            //wlog( "unable to find call ${name}", ("name",name));
+         if( !entry.function )
             return;
-         }
-         //FC_ASSERT( apply, "no entry point found for ${call}", ("call", std::string(name))  );
-
-         FC_ASSERT( getFunctionType(call)->parameters.size() == 2 );
 
-  //       idump((current_validate_context->msg.code)(current_validate_context->msg.type)(current_validate_context->code));
-         std::vector<Value> args = { Value(uint64_t(current_validate_context->msg.code)),
-                                     Value(uint64_t(current_validate_context->msg.type)) };
+         // The parameters, followed by a slot for the result
+         U64 args[3] = { uint64_t(current_validate_context->msg.code), uint64_t(current_validate_context->msg.type) };
 
+         // Copying the first page back is cheaper than remapping it from a snapshot, which costs a syscall, a TLB
+         // flush and a fault for every page the contract writes; see the contract_memory_reset_cost slow test
          auto& state = *current_state;
          char* memstart = &memoryRef<char>( current_memory, 0 );
          memset( memstart + state.mem_end, 0, ((1<<16) - state.mem_end) );
          memcpy( memstart, state.init_memory.data(), state.mem_end);
 
-         checktimeStart = fc::time_point::now();
+         start_checktime();
 
-         Runtime::invokeFunction(call,args);
+         database_release release( database_lock );
+         Runtime::invokeBoundFunction( entry, args );
       } catch( const Runtime::Exception& e ) {
           edump((std::string(describeExceptionCause(e.cause))));
           edump((e.callStack));
@@ -506,26 +716,22 @@ DEFINE_INTRINSIC_FUNCTION1(env,free,free,none,i32,ptr) {
       }
    } FC_CAPTURE_AND_RETHROW( (name)(current_validate_context->msg.type) ) }
 
-   void  wasm_interface::vm_apply()        { vm_call("apply" );          }
+   void  wasm_interface::vm_apply()        { vm_call( current_state->apply_entry, "apply" ); }
 
    void  wasm_interface::vm_onInit()
    { try {
       try {
           wlog( "on_init" );
-            FunctionInstance* apply = asFunctionNullable(getInstanceExport(current_module,"init"));
-            if( !apply ) {
-               elog( "no onInit method found" );
-               return; /// if not found then it is a no-op
-         }
-
-         checktimeStart = fc::time_point::now();
-
-            const FunctionType* functionType = getFunctionType(apply);
-            FC_ASSERT( functionType->parameters.size() == 0 );
+          if( !current_state->init_entry.function ) {
+             elog( "no onInit method found" );
+             return; /// if not found then it is a no-op
+          }
 
-            std::vector<Value> args(0);
+          start_checktime();
 
-            Runtime::invokeFunction(apply,args);
+          U64 result[1];
+          database_release release( database_lock );
+          Runtime::invokeBoundFunction( current_state->init_entry, result );
       } catch( const Runtime::Exception& e ) {
           edump((std::string(describeExceptionCause(e.cause))));
           edump((e.callStack));
@@ -533,6 +739,20 @@ DEFINE_INTRINSIC_FUNCTION1(env,free,free,none,i32,ptr) {
       }
    } FC_CAPTURE_AND_RETHROW() }
 
+   /**
+    *  Resolves an entry point a contract exports by name and prepares it to be invoked directly. An entry point the
+    *  contract does not export is left unbound; one that does not take the expected parameters fails the load.
+    */
+   static Runtime::BoundFunction bind_entry( ModuleInstance* instance, const char* name,
+                                             const std::vector<ValueType>& parameters ) {
+      FunctionInstance* function = asFunctionNullable( getInstanceExport( instance, name ) );
+      if( !function )
+         return Runtime::BoundFunction();
+      FC_ASSERT( getFunctionType( function )->parameters == parameters, "${name} has the wrong parameters",
+                 ("name", name) );
+      return Runtime::bindFunction( function );
+   }
+
    void wasm_interface::validate( apply_context& c ) {
       /*
       current_validate_context       = &c;
@@ -581,32 +801,83 @@ DEFINE_INTRINSIC_FUNCTION1(env,free,free,none,i32,ptr) {
 
 
 
+   void wasm_interface::set_max_instances( uint32_t max ) {
+      FC_ASSERT( max > 0, "at least one contract instance must be kept in memory" );
+      std::lock_guard<std::mutex> lock( runtime_mutex );
+      max_instances = max;
+   }
+
+   void wasm_interface::free_instance( map<AccountName, ModuleState>::iterator itr ) {
+      delete itr->second.module;
+      lru.erase( itr->second.lru_position );
+      instances.erase( itr );
+
+      // Finding what is no longer reachable walks every object of the runtime, so evicted instances are released
+      // in batches rather than one at a time
+      if( ++uncollected_instances >= std::max<uint32_t>( 1, max_instances / 4 ) )
+         collect_garbage();
+   }
+
+   /**
+    *  The runtime owns every instance, its memory and its compiled code; releases everything that is no longer
+    *  reachable from one of the instances kept by any thread
+    */
+   void wasm_interface::collect_garbage() {
+      std::vector<ObjectInstance*> roots;
+      for( auto wasm : interfaces )
+         for( const auto& i : wasm->instances )
+            if( i.second.instance )
+               roots.push_back( asObject( i.second.instance ) );
+      Runtime::freeUnreferencedObjects( std::move(roots) );
+      uncollected_instances = 0;
+   }
+
+   /// Decodes the code of a contract and instruments it with the checktime calls
+   IR::Module* wasm_interface::load_module( const shared_vector<char>& code ) {
+      auto module = std::make_unique<IR::Module>();
+      Serialization::MemoryInputStream stream( (const U8*)code.data(), code.size() );
+      WASM::serializeWithInjection( stream, *module );
+      return module.release();
+   }
+
    void wasm_interface::load( const AccountName& name, const chainbase::database& db ) {
       const auto& recipient = db.get<account_object,by_name>( name );
   //    idump(("recipient")(Name(name))(recipient.code_version));
 
-      auto& state = instances[name];
-      if( state.code_version != recipient.code_version ) {
-         if( state.instance ) {
-            /// TODO: free existing instance and module
-#warning TODO: free existing module if the code has been updated, currently leak memory
-            state.instance     = nullptr;
-            state.module       = nullptr;
-            state.code_version = fc::sha256();
-         }
-         state.module = new IR::Module();
+      auto itr = instances.find( name );
+      bool current = itr != instances.end() && itr->second.code_version == recipient.code_version &&
+                     itr->second.instrumentation_version == WASM::injectionVersion;
+      std::unique_lock<std::mutex> lock( runtime_mutex, std::defer_lock );
+      if( !current )
+         lock.lock();
+
+      if( itr != instances.end() && (itr->second.code_version != recipient.code_version ||
+                                     itr->second.instrumentation_version != WASM::injectionVersion) ) {
+         // The code has been updated, the old instance will never be used again
+         free_instance( itr );
+         itr = instances.end();
+      }
+
+      if( itr == instances.end() ) {
+         while( instances.size() >= max_instances )
+            free_instance( instances.find( lru.front() ) );
+         itr = instances.emplace( name, ModuleState() ).first;
+         auto& state = itr->second;
+         state.lru_position = lru.insert( lru.end(), name );
 
         try
         {
           wlog( "LOADING CODE" );
           auto start = fc::time_point::now();
-          Serialization::MemoryInputStream stream((const U8*)recipient.code.data(),recipient.code.size());
-          WASM::serializeWithInjection(stream,*state.module);
+          state.module = load_module( recipient.code );
 
           RootResolver rootResolver;
           LinkResult linkResult = linkModule(*state.module,rootResolver);
           state.instance = instantiateModule( *state.module, std::move(linkResult.resolvedImports) );
           FC_ASSERT( state.instance );
+          state.apply_entry = bind_entry( state.instance, "apply", { ValueType::i64, ValueType::i64 } );
+          state.init_entry  = bind_entry( state.instance, "init",  {} );
+          state.alloc_entry = bind_entry( state.instance, "alloc", { ValueType::i32 } );
           auto end = fc::time_point::now();
           idump(( (end-start).count()/1000000.0) );
 
@@ -625,26 +896,38 @@ DEFINE_INTRINSIC_FUNCTION1(env,free,free,none,i32,ptr) {
           memcpy( state.init_memory.data(), memstart, state.mem_end ); //state.init_memory.size() );
           std::cerr <<"\n";
           state.code_version = recipient.code_version;
+          state.instrumentation_version = WASM::injectionVersion;
           idump((state.code_version));
         }
         catch(Serialization::FatalSerializationException exception)
         {
           std::cerr << "Error deserializing WebAssembly binary file:" << std::endl;
           std::cerr << exception.message << std::endl;
+          free_instance( itr );
           throw;
         }
         catch(IR::ValidationException exception)
         {
           std::cerr << "Error validating WebAssembly binary file:" << std::endl;
           std::cerr << exception.message << std::endl;
+          free_instance( itr );
           throw;
         }
         catch(std::bad_alloc)
         {
           std::cerr << "Memory allocation failed: input is likely malformed" << std::endl;
+          free_instance( itr );
+          throw;
+        }
+        catch(...)
+        {
+          free_instance( itr );
           throw;
         }
       }
+
+      auto& state = itr->second;
+      lru.splice( lru.end(), lru, state.lru_position );
       current_module = state.instance;
       current_memory = getDefaultMemory( current_module );
       current_state  = &state;
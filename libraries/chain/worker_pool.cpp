@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <eos/chain/worker_pool.hpp>
+
+namespace eos { namespace chain {
+
+worker_pool::worker_pool(uint32_t thread_count) {
+   _workers.reserve(thread_count);
+   for (uint32_t i = 0; i < thread_count; ++i)
+      _workers.emplace_back([this]() { run(); });
+}
+
+worker_pool::~worker_pool() {
+   {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+   }
+   _condition.notify_all();
+   for (auto& w : _workers)
+      w.join();
+}
+
+uint32_t worker_pool::default_thread_count() {
+   auto hardware = std::thread::hardware_concurrency();
+   return hardware > 1 ? hardware - 1 : 0;
+}
+
+void worker_pool::enqueue(std::function<void()> task) {
+   {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _tasks.emplace_back(std::move(task));
+   }
+   _condition.notify_one();
+}
+
+void worker_pool::run() {
+   while (true) {
+      std::function<void()> task;
+      {
+         std::unique_lock<std::mutex> lock(_mutex);
+         _condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+         if (_tasks.empty())
+            return;
+         task = std::move(_tasks.front());
+         _tasks.pop_front();
+      }
+      task();
+   }
+}
+
+} } // eos::chain
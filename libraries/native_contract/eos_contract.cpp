@@ -388,11 +388,13 @@ void apply_eos_updateauth(apply_context& context) {
    if (permission) {
       EOS_ASSERT(parent.id == permission->parent, message_precondition_exception,
                  "Changing parent authority is not currently supported");
-      if (context.controller.is_applying_block())
+      if (context.controller.is_applying_block()) {
          db.modify(*permission, [&update, parent = parent.id](permission_object& po) {
             po.auth = update.authority;
             po.parent = parent;
          });
+         context.mutable_controller.invalidate_authority({update.account, update.permission});
+      }
    } else if (context.controller.is_applying_block()) {
       db.create<permission_object>([&update, parent = parent.id](permission_object& po) {
          po.name = update.permission;
@@ -426,8 +428,10 @@ void apply_eos_deleteauth(apply_context& context) {
                  "Cannot delete a linked authority. Unlink the authority first");
    }
 
-   if (context.controller.is_applying_block())
+   if (context.controller.is_applying_block()) {
       db.remove(permission);
+      context.mutable_controller.invalidate_authority({remove.account, remove.permission});
+   }
 }
 
 void apply_eos_linkauth(apply_context& context) {
@@ -41,3 +41,5 @@ using BalanceMultiIndex = chainbase::shared_multi_index_container<
 } } // namespace native::eos
 
 CHAINBASE_SET_INDEX_TYPE(native::eos::BalanceObject, native::eos::BalanceMultiIndex)
+
+FC_REFLECT(native::eos::BalanceObject, (id)(ownerName)(balance))
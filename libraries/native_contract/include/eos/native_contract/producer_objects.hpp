@@ -74,7 +74,7 @@ class ProducerVotesObject : public chainbase::object<chain::producer_votes_objec
     *
     * @warning Do not update these values directly; use @ref updateVotes instead!
     */
-   struct {
+   struct RaceState {
       /// The current speed for this producer (which is actually the total votes for the producer)
       types::ShareType speed = 0;
       /// The position of this producer when we last updated the records
@@ -242,3 +242,8 @@ using ProducerScheduleMultiIndex = chainbase::shared_multi_index_container<
 CHAINBASE_SET_INDEX_TYPE(native::eos::ProducerVotesObject, native::eos::ProducerVotesMultiIndex)
 CHAINBASE_SET_INDEX_TYPE(native::eos::ProxyVoteObject, native::eos::ProxyVoteMultiIndex)
 CHAINBASE_SET_INDEX_TYPE(native::eos::ProducerScheduleObject, native::eos::ProducerScheduleMultiIndex)
+
+FC_REFLECT(native::eos::ProducerVotesObject::RaceState, (speed)(position)(positionUpdateTime)(projectedFinishTime))
+FC_REFLECT(native::eos::ProducerVotesObject, (id)(ownerName)(race))
+FC_REFLECT(native::eos::ProxyVoteObject, (id)(proxyTarget)(proxySources)(proxiedStake))
+FC_REFLECT(native::eos::ProducerScheduleObject, (id)(currentRaceTime))
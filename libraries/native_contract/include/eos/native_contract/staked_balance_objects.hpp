@@ -114,3 +114,7 @@ using StakedBalanceMultiIndex = chainbase::shared_multi_index_container<
 } } // namespace native::eos
 
 CHAINBASE_SET_INDEX_TYPE(native::eos::StakedBalanceObject, native::eos::StakedBalanceMultiIndex)
+
+FC_REFLECT(native::eos::ProducerSlate, (votes)(size))
+FC_REFLECT(native::eos::StakedBalanceObject,
+           (id)(ownerName)(stakedBalance)(unstakingBalance)(lastUnstakingTime)(producerVotes))
@@ -29,12 +29,12 @@ std::array<types::AccountName, config::BlocksPerRound> native_contract_chain_ini
 
 void native_contract_chain_initializer::register_types(chain_controller& chain, chainbase::database& db) {
    // Install the native contract's indexes; we can't do anything until our objects are recognized
-   db.add_index<native::eos::StakedBalanceMultiIndex>();
-   db.add_index<native::eos::ProducerVotesMultiIndex>();
-   db.add_index<native::eos::ProxyVoteMultiIndex>();
-   db.add_index<native::eos::ProducerScheduleMultiIndex>();
+   chain.add_index<native::eos::StakedBalanceMultiIndex>();
+   chain.add_index<native::eos::ProducerVotesMultiIndex>();
+   chain.add_index<native::eos::ProxyVoteMultiIndex>();
+   chain.add_index<native::eos::ProducerScheduleMultiIndex>();
 
-   db.add_index<native::eos::BalanceMultiIndex>();
+   chain.add_index<native::eos::BalanceMultiIndex>();
 
 #define SET_APP_HANDLER( contract, scope, action ) \
    chain.set_apply_handler( #contract, #scope, #action, &BOOST_PP_CAT(native::contract::apply_, BOOST_PP_CAT(scope, BOOST_PP_CAT(_,action) ) ) )
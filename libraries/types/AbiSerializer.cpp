@@ -37,6 +37,27 @@ namespace eos { namespace types {
       setAbi(abi);
    }
 
+   AbiSerializer::AbiSerializer( const AbiSerializer& other )
+   :typedefs(other.typedefs), structs(other.structs), actions(other.actions), tables(other.tables),
+    built_in_types(other.built_in_types) {
+      if( !other.plans.empty() )
+         compilePlans();
+   }
+
+   AbiSerializer& AbiSerializer::operator=( const AbiSerializer& other ) {
+      if( this != &other ) {
+         typedefs       = other.typedefs;
+         structs        = other.structs;
+         actions        = other.actions;
+         tables         = other.tables;
+         built_in_types = other.built_in_types;
+         plans.clear();
+         if( !other.plans.empty() )
+            compilePlans();
+      }
+      return *this;
+   }
+
    void AbiSerializer::configureBuiltInTypes() {
       //PublicKey.hpp
       built_in_types.emplace("PublicKey",     packUnpack<PublicKey>());
@@ -122,6 +143,77 @@ namespace eos { namespace types {
       FC_ASSERT( structs.size() == abi.structs.size() );
       FC_ASSERT( actions.size() == abi.actions.size() );
       FC_ASSERT( tables.size() == abi.tables.size() );
+
+      compilePlans();
+   }
+
+   void AbiSerializer::compilePlans() {
+      plans.clear();
+      for( const auto& st : structs )
+         compilePlan( st.first );
+   }
+
+   const AbiSerializer::struct_plan* AbiSerializer::compilePlan( const TypeName& type ) {
+      auto itr = plans.find( type );
+      if( itr != plans.end() ) {
+         // An incomplete plan is either being compiled further up the stack or failed to compile
+         return itr->second.complete ? &itr->second : nullptr;
+      }
+
+      // Built-in types take precedence over structs of the same name
+      if( built_in_types.find( type ) != built_in_types.end() ) return nullptr;
+      auto st = structs.find( type );
+      if( st == structs.end() ) return nullptr;
+
+      auto& plan = plans[type];
+      if( st->second.base != TypeName() ) {
+         const auto* base = compilePlan( resolveType( st->second.base ) );
+         if( !base ) return nullptr;
+         plan.fields = base->fields;
+      }
+      for( const auto& field : st->second.fields ) {
+         auto rtype = resolveType( field.type );
+         auto btype = built_in_types.find( arrayType(rtype) );
+         if( btype != built_in_types.end() ) {
+            plan.fields.push_back( field_plan{ field.name, &btype->second, isArray(rtype), nullptr } );
+         } else {
+            const auto* nested = compilePlan( rtype );
+            if( !nested ) return nullptr;
+            plan.fields.push_back( field_plan{ field.name, nullptr, false, nested } );
+         }
+      }
+      plan.complete = true;
+      return &plan;
+   }
+
+   const AbiSerializer::struct_plan* AbiSerializer::findPlan( const TypeName& type )const {
+      auto itr = plans.find( type );
+      if( itr != plans.end() && itr->second.complete ) return &itr->second;
+      return nullptr;
+   }
+
+   void AbiSerializer::unpackPlan( const struct_plan& plan, fc::datastream<const char*>& stream, fc::mutable_variant_object& obj )const {
+      for( const auto& field : plan.fields ) {
+         if( field.built_in ) {
+            obj( field.name, field.built_in->first( stream, field.is_array ) );
+         } else {
+            fc::mutable_variant_object mvo;
+            unpackPlan( *field.nested, stream, mvo );
+            obj( field.name, fc::variant( std::move(mvo) ) );
+         }
+      }
+   }
+
+   void AbiSerializer::packPlan( const struct_plan& plan, const fc::variant& var, fc::datastream<char*>& ds )const {
+      const auto& vo = var.get_object();
+      for( const auto& field : plan.fields ) {
+         auto itr = vo.find( String(field.name) );
+         FC_ASSERT( itr != vo.end(), "Missing '${f}' in variant object", ("f",field.name) );
+         if( field.built_in )
+            field.built_in->second( itr->value(), ds, field.is_array );
+         else
+            packPlan( *field.nested, itr->value(), ds );
+      }
    }
    
    bool AbiSerializer::isArray( const TypeName& type )const {
@@ -193,7 +285,10 @@ namespace eos { namespace types {
       }
       
       fc::mutable_variant_object mvo;
-      binaryToVariant( rtype, stream, mvo );
+      if( const auto* plan = findPlan( rtype ) )
+         unpackPlan( *plan, stream, mvo );
+      else
+         binaryToVariant( rtype, stream, mvo );
       return fc::variant( std::move(mvo) );
    }
 
@@ -209,6 +304,8 @@ namespace eos { namespace types {
       auto btype = built_in_types.find(arrayType(rtype));
       if( btype != built_in_types.end() ) {
          btype->second.second(var, ds, isArray(rtype));
+      } else if( const auto* plan = findPlan( rtype ) ) {
+         packPlan( *plan, var, ds );
       } else {
          
          const auto& st = getStruct( rtype );
@@ -7,6 +7,7 @@ using std::map;
 using std::string;
 using std::function;
 using std::pair;
+using std::vector;
 
 /**
  *  Describes the binary representation message and table contents so that it can
@@ -15,6 +16,10 @@ using std::pair;
 struct AbiSerializer {
    AbiSerializer(){ configureBuiltInTypes(); }
    AbiSerializer( const Abi& abi );
+   AbiSerializer( const AbiSerializer& other );
+   AbiSerializer( AbiSerializer&& other ) = default;
+   AbiSerializer& operator=( const AbiSerializer& other );
+   AbiSerializer& operator=( AbiSerializer&& other ) = default;
    void setAbi( const Abi& abi );
 
    map<TypeName, TypeName> typedefs;
@@ -50,6 +55,33 @@ struct AbiSerializer {
 
    private:
    void binaryToVariant(const TypeName& type, fc::datastream<const char*>& stream, fc::mutable_variant_object& obj )const;
+
+   /**
+    *  A struct flattened into the list of fields it is packed as, base struct fields first, with every field type
+    *  resolved to either a built-in pack/unpack pair or the plan of a nested struct. setAbi compiles a plan for each
+    *  struct it can, and structs with a plan are converted without any of the name lookups done by the general path.
+    */
+   struct struct_plan;
+   struct field_plan {
+      FieldName                                    name;
+      const pair<unpack_function, pack_function>*  built_in = nullptr;
+      bool                                         is_array = false;
+      const struct_plan*                           nested   = nullptr;
+   };
+   struct struct_plan {
+      vector<field_plan> fields;
+      bool               complete = false;
+   };
+
+   /// Plans point into built_in_types and each other, so they are rebuilt rather than copied
+   map<TypeName, struct_plan> plans;
+
+   void compilePlans();
+   const struct_plan* compilePlan( const TypeName& type );
+   const struct_plan* findPlan( const TypeName& type )const;
+
+   void unpackPlan( const struct_plan& plan, fc::datastream<const char*>& stream, fc::mutable_variant_object& obj )const;
+   void packPlan( const struct_plan& plan, const fc::variant& var, fc::datastream<char*>& ds )const;
 };
 
 } } // eos::types
@@ -0,0 +1,68 @@
+#pragma once
+#include <fc/bloom_filter.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace eos { namespace utilities {
+
+   /**
+    * A set of recently inserted items with bounded memory, backed by two bloom filters used as generations.
+    *
+    * Items are inserted into the current generation. When it holds capacity items, the older generation is
+    * cleared and becomes the current one, so the most recent capacity items are always remembered, and at most
+    * 2 * capacity are. contains() is never wrong about a remembered item; it reports an item it was never given
+    * with about the requested false positive probability.
+    */
+   class rolling_bloom_filter {
+      public:
+         /**
+          * @param capacity the number of most recent items that are guaranteed to be remembered
+          * @param false_positive_probability the chance that contains() reports an item that was never inserted
+          * @param seed selects the hash functions, so that filters with different seeds have different false positives
+          */
+         rolling_bloom_filter( uint32_t capacity, double false_positive_probability, uint64_t seed )
+         :capacity( std::max( capacity, 1u ) )
+         {
+            FC_ASSERT( false_positive_probability > 0 && false_positive_probability < 1,
+                       "false positive probability must be between 0 and 1" );
+            fc::bloom_parameters params;
+            params.projected_element_count = this->capacity;
+            // an item is looked up in both generations, so each contributes half of the false positives
+            params.false_positive_probability = false_positive_probability / 2;
+            // the seeds the bloom filter rejects are replaced by its default seed
+            params.random_seed = ( seed == 0 || seed == ~0ull )? params.random_seed : seed;
+            FC_ASSERT( params.compute_optimal_parameters(), "invalid bloom filter parameters" );
+            generations[0] = fc::bloom_filter( params );
+            generations[1] = generations[0];
+         }
+
+         template<typename T>
+         bool contains( const T& item )const {
+            return generations[current].contains( item ) || generations[!current].contains( item );
+         }
+
+         template<typename T>
+         void insert( const T& item ) {
+            if( generations[current].element_count() >= capacity ) {
+               current = !current;
+               generations[current].clear();
+            }
+            generations[current].insert( item );
+         }
+
+         void clear() {
+            generations[0].clear();
+            generations[1].clear();
+         }
+
+         /// The memory used by the bit tables, in bytes
+         uint64_t memory_size()const {
+            return ( generations[0].size() + generations[1].size() ) / 8;
+         }
+
+      private:
+         uint32_t         capacity;
+         fc::bloom_filter generations[2];
+         bool             current = false;
+   };
+
+} } // eos::utilities
@@ -126,6 +126,25 @@ namespace Runtime
 
 	void invokeFunction2(FunctionInstance* function,const std::vector<Value>& parameters);
 
+	// A FunctionInstance whose invoke thunk has been resolved ahead of time, so it can be called without any lookup,
+	// signature check or allocation.
+	struct BoundFunction
+	{
+		FunctionInstance* function = nullptr;
+		void* nativeFunction = nullptr;
+		void (*invokeThunk)(void*,U64*) = nullptr;
+		Uptr numParameters = 0;
+		IR::ResultType ret = IR::ResultType::none;
+	};
+
+	// Binds a FunctionInstance for invokeBoundFunction. May compile an invoke thunk for the function's type, so it
+	// must not be called concurrently with other calls that create runtime objects.
+	RUNTIME_API BoundFunction bindFunction(FunctionInstance* function);
+
+	// Invokes a bound function with its parameters as 64-bit values, followed by a slot that receives the result if
+	// the function has one. Throws a Runtime::Exception if a trap occurs.
+	RUNTIME_API void invokeBoundFunction(const BoundFunction& function,U64* arguments);
+
   void test( int a );
 	Result testPointerPass(int64_t function, int64_t test2);
 
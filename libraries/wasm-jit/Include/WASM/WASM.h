@@ -11,6 +11,9 @@ namespace Serialization { struct InputStream; struct OutputStream; }
 
 namespace WASM
 {
+   // Identifies the instrumentation serializeWithInjection adds; must change whenever the injected code does
+   static const U32 injectionVersion = 1;
+
    WEBASSEMBLY_API void serialize(Serialization::InputStream& stream,IR::Module& module);
    WEBASSEMBLY_API void serializeWithInjection(Serialization::InputStream& stream,IR::Module& module);
    WEBASSEMBLY_API void serialize(Serialization::OutputStream& stream,const IR::Module& module);
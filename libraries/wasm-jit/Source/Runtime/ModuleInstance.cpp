@@ -3,6 +3,7 @@
 #include "RuntimePrivate.h"
 #include "IR/Module.h"
 
+#include <algorithm>
 #include <string.h>
 
 namespace Runtime
@@ -194,6 +195,7 @@ namespace Runtime
 	ModuleInstance::~ModuleInstance()
 	{
 		delete jitModule;
+		moduleInstances.erase(std::remove(moduleInstances.begin(),moduleInstances.end(),this),moduleInstances.end());
 	}
 
 	MemoryInstance* getDefaultMemory(ModuleInstance* moduleInstance) { return moduleInstance->defaultMemory; }
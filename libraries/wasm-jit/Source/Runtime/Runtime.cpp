@@ -131,6 +131,31 @@ namespace Runtime
 		else { handleHardwareTrap(trapType,std::move(trapCallStack),trapOperand); }
 	}
 
+	BoundFunction bindFunction(FunctionInstance* function)
+	{
+		BoundFunction bound;
+		bound.function = function;
+		bound.nativeFunction = function->nativeFunction;
+		bound.invokeThunk = LLVMJIT::getInvokeThunk(function->type);
+		bound.numParameters = function->type->parameters.size();
+		bound.ret = function->type->ret;
+		return bound;
+	}
+
+	void invokeBoundFunction(const BoundFunction& function,U64* arguments)
+	{
+		Platform::HardwareTrapType trapType;
+		Platform::CallStack trapCallStack;
+		Uptr trapOperand;
+		trapType = Platform::catchHardwareTraps(trapCallStack,trapOperand,
+			[&]
+			{
+				(*function.invokeThunk)(function.nativeFunction,arguments);
+			});
+
+		if(trapType != Platform::HardwareTrapType::none) { handleHardwareTrap(trapType,std::move(trapCallStack),trapOperand); }
+	}
+
 	const FunctionType* getFunctionType(FunctionInstance* function)
 	{
 		return function->type;
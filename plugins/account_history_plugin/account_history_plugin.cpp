@@ -38,30 +38,51 @@ using get_transactions_results = account_history_apis::read_only::get_transactio
 class account_history_plugin_impl {
 public:
    ProcessedTransaction get_transaction(const chain::transaction_id_type&  transaction_id) const;
-   get_transactions_results get_transactions(const AccountName&  account_name, const optional<uint32_t>& skip_seq, const optional<uint32_t>& num_seq) const;
+   get_transactions_results get_transactions(const AccountName&  account_name, const optional<uint32_t>& skip_seq, const optional<uint32_t>& num_seq, bool oldest_first) const;
    vector<AccountName> get_key_accounts(const public_key_type& public_key) const;
    vector<AccountName> get_controlled_accounts(const AccountName& controlling_account) const;
+   void start_indexing(chain::chain_controller& chain);
    void applied_block(const signed_block&);
 
-   chain_plugin* chain_plug;
+   /// The chain whose blocks are indexed
+   chain::chain_controller* chain = nullptr;
    static const int64_t DEFAULT_TRANSACTION_TIME_LIMIT;
-   int64_t transactions_time_limit = DEFAULT_TRANSACTION_TIME_LIMIT;
+   int64_t transactions_time_limit = DEFAULT_TRANSACTION_TIME_LIMIT * 1000;
    std::set<AccountName> filter_on;
 
 private:
-   struct block_comp
+   struct transaction_locator
    {
-      bool operator()(const block_id_type& a, const block_id_type& b) const
-      {
-         return chain::block_header::num_from_id(a) > chain::block_header::num_from_id(b);
-      }
+      block_id_type block_id;
+      uint32_t      block_num;
+      uint16_t      cycle_index;
+      uint16_t      thread_index;
+      uint32_t      trx_index;
+      uint32_t      block_offset;
+   };
+
+   struct history_entry
+   {
+      uint32_t            seq_num;
+      transaction_id_type transaction_id;
+      transaction_locator locator;
    };
-   typedef std::multimap<block_id_type, transaction_id_type, block_comp> block_transaction_id_map;
 
-   optional<block_id_type> find_block_id(const chainbase::database& db, const transaction_id_type& transaction_id) const;
-   ProcessedTransaction find_transaction(const chain::transaction_id_type&  transaction_id, const signed_block& block) const;
+   /// The block a lookup read last, so that further transactions of the same block are read without fetching it again
+   struct block_cache
+   {
+      block_id_type                            block_id;
+      optional<chain::block_log::packed_block> packed; ///< set if the block is in the block log
+      optional<signed_block>                   block;  ///< set otherwise
+   };
+
+   optional<transaction_locator> find_locator(const chainbase::database& db, const transaction_id_type& transaction_id) const;
+   ProcessedTransaction read_transaction(const chain::transaction_id_type&  transaction_id, const transaction_locator& locator, block_cache& cache) const;
+   ProcessedTransaction find_transaction(const chain::transaction_id_type&  transaction_id, const signed_block& block, const transaction_locator& locator) const;
+   ProcessedTransaction unpack_transaction(const chain::transaction_id_type&  transaction_id, const chain::block_log::packed_block& block, const transaction_locator& locator) const;
    bool is_scope_relevant(const eos::types::Vector<AccountName>& scope);
-   get_transactions_results ordered_transactions(const block_transaction_id_map& block_transaction_ids, const fc::time_point& start_time, const uint32_t begin, const uint32_t end) const;
+   vector<history_entry> find_history_page(const chainbase::database& db, const AccountName& account_name, uint32_t begin, const optional<uint32_t>& num_seq, bool oldest_first) const;
+   static uint32_t next_account_seq(const chainbase::database& db, const AccountName& account_name);
    static void add(chainbase::database& db, const vector<types::KeyPermissionWeight>& keys, const AccountName& account_name, const PermissionName& permission);
    template<typename MultiIndex, typename LookupType>
    static void remove(chainbase::database& db, const AccountName& account_name, const PermissionName& permission)
@@ -93,41 +114,79 @@ const PermissionName account_history_plugin_impl::OWNER = "owner";
 const PermissionName account_history_plugin_impl::ACTIVE = "active";
 const PermissionName account_history_plugin_impl::RECOVERY = "recovery";
 
-optional<block_id_type> account_history_plugin_impl::find_block_id(const chainbase::database& db, const transaction_id_type& transaction_id) const
+optional<account_history_plugin_impl::transaction_locator> account_history_plugin_impl::find_locator(const chainbase::database& db, const transaction_id_type& transaction_id) const
 {
-   optional<block_id_type> block_id;
+   optional<transaction_locator> locator;
    const auto& trx_idx = db.get_index<transaction_history_multi_index, by_trx_id>();
    auto transaction_history = trx_idx.find( transaction_id );
    if (transaction_history != trx_idx.end())
-      block_id = transaction_history->block_id;
+      locator = transaction_locator{transaction_history->block_id, transaction_history->block_num,
+                                    transaction_history->cycle_index, transaction_history->thread_index,
+                                    transaction_history->trx_index, transaction_history->block_offset};
 
-   return block_id;
+   return locator;
 }
 
-ProcessedTransaction account_history_plugin_impl::find_transaction(const chain::transaction_id_type&  transaction_id, const chain::signed_block& block) const
+ProcessedTransaction account_history_plugin_impl::find_transaction(const chain::transaction_id_type&  transaction_id, const chain::signed_block& block, const transaction_locator& locator) const
 {
-   for (const auto& cycle : block.cycles)
-      for (const auto& thread : cycle)
-         for (const auto& trx : thread.user_input)
-            if (trx.id() == transaction_id)
-               return trx;
+   if (locator.cycle_index < block.cycles.size())
+   {
+      const auto& cycle = block.cycles[locator.cycle_index];
+      if (locator.thread_index < cycle.size())
+      {
+         const auto& user_input = cycle[locator.thread_index].user_input;
+         if (locator.trx_index < user_input.size() && user_input[locator.trx_index].id() == transaction_id)
+            return user_input[locator.trx_index];
+      }
+   }
 
    // ERROR in indexing logic
    FC_THROW("Transaction with ID ${tid} was indexed as being in block ID ${bid}, but was not found in that block", ("tid", transaction_id)("bid", block.id()));
 }
 
+ProcessedTransaction account_history_plugin_impl::unpack_transaction(const chain::transaction_id_type&  transaction_id, const chain::block_log::packed_block& block, const transaction_locator& locator) const
+{
+   FC_ASSERT(locator.block_offset < block.size, "Transaction with ID ${tid} was indexed past the end of block ${num}",
+             ("tid", transaction_id)("num", locator.block_num));
+
+   ProcessedTransaction trx;
+   fc::datastream<const char*> ds(block.data + locator.block_offset, block.size - locator.block_offset);
+   fc::raw::unpack(ds, trx);
+   FC_ASSERT(trx.id() == transaction_id, "Transaction with ID ${tid} was indexed as being in block ${num}, but was not found in that block",
+             ("tid", transaction_id)("num", locator.block_num));
+   return trx;
+}
+
+ProcessedTransaction account_history_plugin_impl::read_transaction(const chain::transaction_id_type&  transaction_id, const transaction_locator& locator, block_cache& cache) const
+{
+   if (cache.block_id != locator.block_id)
+   {
+      cache = block_cache{locator.block_id};
+      // Irreversible blocks are read straight out of the block log, and only the transaction itself is unpacked
+      cache.packed = chain->fetch_packed_block_by_number(locator.block_num);
+      if (!cache.packed)
+      {
+         cache.block = chain->fetch_block_by_id(locator.block_id);
+         FC_ASSERT(cache.block, "Transaction with ID ${tid} was indexed as being in block ID ${bid}, but no such block was found", ("tid", transaction_id)("bid", locator.block_id));
+      }
+   }
+
+   if (cache.packed)
+      return unpack_transaction(transaction_id, *cache.packed, locator);
+   return find_transaction(transaction_id, *cache.block, locator);
+}
+
 ProcessedTransaction account_history_plugin_impl::get_transaction(const chain::transaction_id_type&  transaction_id) const
 {
-   const auto& db = chain_plug->chain().get_database();
-   optional<block_id_type> block_id;
+   const auto& db = chain->get_database();
+   optional<transaction_locator> locator;
    db.with_read_lock( [&]() {
-      block_id = find_block_id(db, transaction_id);
+      locator = find_locator(db, transaction_id);
    } );
-   if( block_id.valid() )
+   if( locator.valid() )
    {
-      auto block = chain_plug->chain().fetch_block_by_id(*block_id);
-      FC_ASSERT(block, "Transaction with ID ${tid} was indexed as being in block ID ${bid}, but no such block was found", ("tid", transaction_id)("bid", block_id));
-      return find_transaction(transaction_id, *block);
+      block_cache cache;
+      return read_transaction(transaction_id, *locator, cache);
    }
 
 #warning TODO: lookup of recent transactions
@@ -135,109 +194,27 @@ ProcessedTransaction account_history_plugin_impl::get_transaction(const chain::t
                       "Could not find transaction for: ${id}", ("id", transaction_id.str()));
 }
 
-get_transactions_results account_history_plugin_impl::get_transactions(const AccountName&  account_name, const optional<uint32_t>& skip_seq, const optional<uint32_t>& num_seq) const
+get_transactions_results account_history_plugin_impl::get_transactions(const AccountName&  account_name, const optional<uint32_t>& skip_seq, const optional<uint32_t>& num_seq, bool oldest_first) const
 {
    fc::time_point start_time = fc::time_point::now();
-   const auto& db = chain_plug->chain().get_database();
+   const auto& db = chain->get_database();
 
-   block_transaction_id_map block_transaction_ids;
+   vector<history_entry> page;
    db.with_read_lock( [&]() {
-      const auto& account_idx = db.get_index<account_transaction_history_multi_index, by_account_name>();
-      auto range = account_idx.equal_range( account_name );
-      for (auto obj = range.first; obj != range.second; ++obj)
-      {
-         optional<block_id_type> block_id = find_block_id(db, obj->transaction_id);
-         FC_ASSERT(block_id, "Transaction with ID ${tid} was tracked for ${account}, but no corresponding block id was found", ("tid", obj->transaction_id)("account", account_name));
-         block_transaction_ids.emplace(std::make_pair(*block_id,  obj->transaction_id));
-      }
+      page = find_history_page(db, account_name, skip_seq ? *skip_seq : 0, num_seq, oldest_first);
    } );
 
-   uint32_t begin, end;
-   const auto size = block_transaction_ids.size();
-   if (!skip_seq)
-   {
-      begin = 0;
-      end = size;
-   }
-   else
-   {
-      begin = *skip_seq;
-
-      if (!num_seq)
-         end = size;
-      else
-      {
-         end = begin + *num_seq;
-         if (end > size)
-            end = size;
-      }
-
-      if (begin > size - 1 || begin >= end)
-         return get_transactions_results();
-   }
-
-   return ordered_transactions(block_transaction_ids, start_time, begin, end);
-}
-
-get_transactions_results account_history_plugin_impl::ordered_transactions(const block_transaction_id_map& block_transaction_ids, const fc::time_point& start_time, const uint32_t begin, const uint32_t end) const
-{
    get_transactions_results results;
-   results.transactions.reserve(end - begin);
+   results.transactions.reserve(page.size());
 
-   auto block_transaction = block_transaction_ids.cbegin();
-
-   uint32_t current = 0;
-   // keep iterating through each equal range
-   while (block_transaction != block_transaction_ids.cend() && !time_exceeded(start_time))
+   // consecutive entries are usually in the same block, which is then only fetched once
+   block_cache cache;
+   for (const auto& entry : page)
    {
-      optional<signed_block> block = chain_plug->chain().fetch_block_by_id(block_transaction->first);
-      FC_ASSERT(block, "Transaction with ID ${tid} was indexed as being in block ID ${bid}, but no such block was found", ("tid", block_transaction->second)("bid", block_transaction->first));
-
-      auto range = block_transaction_ids.equal_range(block_transaction->first);
-
-      std::set<transaction_id_type> trans_ids_for_block;
-      for (block_transaction = range.first; block_transaction != range.second; ++block_transaction)
-      {
-         trans_ids_for_block.insert(block_transaction->second);
-      }
+      const auto trx = read_transaction(entry.transaction_id, entry.locator, cache);
+      const auto pretty_trx = chain->transaction_to_variant(trx);
+      results.transactions.emplace_back(ordered_transaction_results{entry.seq_num, entry.transaction_id, pretty_trx});
 
-      const uint32_t trx_after_block = current + trans_ids_for_block.size();
-      if (trx_after_block <= begin)
-      {
-         current = trx_after_block;
-         continue;
-      }
-      for (auto cycle = block->cycles.crbegin(); cycle != block->cycles.crend() && current < trx_after_block; ++cycle)
-      {
-         for (auto thread = cycle->crbegin(); thread != cycle->crend() && current < trx_after_block; ++thread)
-         {
-            for (auto trx = thread->user_input.crbegin(); trx != thread->user_input.crend() && current < trx_after_block; ++trx)
-            {
-               if(trans_ids_for_block.count(trx->id()))
-               {
-                  if(++current > begin)
-                  {
-                     const auto pretty_trx = chain_plug->chain().transaction_to_variant(*trx);
-                     results.transactions.emplace_back(ordered_transaction_results{(current - 1), trx->id(), pretty_trx});
-
-                     if(current >= end)
-                     {
-                        return results;
-                     }
-                  }
-
-                  // just check after finding transaction or transitioning to next block to avoid spending all our time checking
-                  if (time_exceeded(start_time))
-                  {
-                     results.time_limit_exceeded_error = true;
-                     return results;
-                  }
-               }
-            }
-         }
-      }
-
-      // just check after finding transaction or transitioning to next block to avoid spending all our time checking
       if (time_exceeded(start_time))
       {
          results.time_limit_exceeded_error = true;
@@ -248,6 +225,46 @@ get_transactions_results account_history_plugin_impl::ordered_transactions(const
    return results;
 }
 
+vector<account_history_plugin_impl::history_entry> account_history_plugin_impl::find_history_page(const chainbase::database& db, const AccountName& account_name, uint32_t begin, const optional<uint32_t>& num_seq, bool oldest_first) const
+{
+   vector<history_entry> page;
+   const uint32_t size = next_account_seq(db, account_name);
+   if (begin >= size)
+      return page;
+
+   uint32_t end = size;
+   if (num_seq && *num_seq < size - begin)
+      end = begin + *num_seq;
+   page.reserve(end - begin);
+
+   // seq_num counts from the latest transaction unless oldest_first is set, while account_seq always counts from the first
+   const auto& seq_idx = db.get_index<account_transaction_history_multi_index, by_account_seq>();
+   auto obj = seq_idx.find( boost::make_tuple( account_name, oldest_first ? begin : size - 1 - begin ) );
+   for (uint32_t seq_num = begin; seq_num < end; ++seq_num)
+   {
+      FC_ASSERT(obj != seq_idx.end() && obj->account_name == account_name, "History of ${account} is missing transaction ${seq}", ("account", account_name)("seq", seq_num));
+      auto locator = find_locator(db, obj->transaction_id);
+      FC_ASSERT(locator, "Transaction with ID ${tid} is in the history of ${account}, but was not indexed", ("tid", obj->transaction_id)("account", account_name));
+      page.push_back(history_entry{seq_num, obj->transaction_id, *locator});
+      if (oldest_first)
+         ++obj;
+      else if (seq_num + 1 < end)
+         --obj;
+   }
+   return page;
+}
+
+uint32_t account_history_plugin_impl::next_account_seq(const chainbase::database& db, const AccountName& account_name)
+{
+   const auto& seq_idx = db.get_index<account_transaction_history_multi_index, by_account_seq>();
+   auto next = seq_idx.upper_bound( boost::make_tuple( account_name ) );
+   if (next == seq_idx.begin())
+      return 0;
+
+   --next;
+   return next->account_name == account_name ? next->account_seq + 1 : 0;
+}
+
 bool account_history_plugin_impl::time_exceeded(const fc::time_point& start_time) const
 {
    return (fc::time_point::now() - start_time).count() > transactions_time_limit;
@@ -256,7 +273,7 @@ bool account_history_plugin_impl::time_exceeded(const fc::time_point& start_time
 vector<AccountName> account_history_plugin_impl::get_key_accounts(const public_key_type& public_key) const
 {
    std::set<AccountName> accounts;
-   const auto& db = chain_plug->chain().get_database();
+   const auto& db = chain->get_database();
    db.with_read_lock( [&]() {
       const auto& pub_key_idx = db.get_index<public_key_history_multi_index, by_pub_key>();
       auto range = pub_key_idx.equal_range( public_key );
@@ -271,7 +288,7 @@ vector<AccountName> account_history_plugin_impl::get_key_accounts(const public_k
 vector<AccountName> account_history_plugin_impl::get_controlled_accounts(const AccountName& controlling_account) const
 {
    std::set<AccountName> accounts;
-   const auto& db = chain_plug->chain().get_database();
+   const auto& db = chain->get_database();
    db.with_read_lock( [&]() {
       const auto& account_control_idx = db.get_index<account_control_history_multi_index, by_controlling>();
       auto range = account_control_idx.equal_range( controlling_account );
@@ -283,30 +300,66 @@ vector<AccountName> account_history_plugin_impl::get_controlled_accounts(const A
    return vector<AccountName>(accounts.begin(), accounts.end());
 }
 
+void account_history_plugin_impl::start_indexing(chain::chain_controller& chain)
+{
+   this->chain = &chain;
+   auto& db = chain.get_mutable_database();
+   db.add_index<account_control_history_multi_index>();
+   db.add_index<account_transaction_history_multi_index>();
+   db.add_index<public_key_history_multi_index>();
+   db.add_index<transaction_history_multi_index>();
+
+   chain.applied_block.connect ([this](const signed_block& block) {
+      applied_block(block);
+   });
+}
+
 void account_history_plugin_impl::applied_block(const signed_block& block)
 {
    const auto block_id = block.id();
-   auto& db = chain_plug->chain().get_mutable_database();
+   const auto block_num = block.block_num();
+   auto& db = chain->get_mutable_database();
    const bool check_relevance = filter_on.size();
-   for (const auto& cycle : block.cycles)
+   // Track where each transaction lands in the packed block, following the layout fc::raw gives a signed_block
+   uint64_t block_offset = fc::raw::pack_size(static_cast<const chain::signed_block_header&>(block)) +
+                           fc::raw::pack_size(fc::unsigned_int(block.cycles.size()));
+   for (uint32_t cycle_index = 0; cycle_index < block.cycles.size(); ++cycle_index)
    {
-      for (const auto& thread : cycle)
+      const auto& cycle = block.cycles[cycle_index];
+      block_offset += fc::raw::pack_size(fc::unsigned_int(cycle.size()));
+      for (uint32_t thread_index = 0; thread_index < cycle.size(); ++thread_index)
       {
-         for (const auto& trx : thread.user_input)
+         const auto& thread = cycle[thread_index];
+         block_offset += fc::raw::pack_size(thread.generated_input) +
+                         fc::raw::pack_size(fc::unsigned_int(thread.user_input.size()));
+         for (uint32_t trx_index = 0; trx_index < thread.user_input.size(); ++trx_index)
          {
+            const auto& trx = thread.user_input[trx_index];
+            const uint64_t trx_offset = block_offset;
+            block_offset += fc::raw::pack_size(trx);
             if (check_relevance && !is_scope_relevant(trx.scope))
                continue;
 
-            db.create<transaction_history_object>([&block_id,&trx](transaction_history_object& transaction_history) {
+            const auto trx_id = trx.id();
+            FC_ASSERT(trx_offset <= std::numeric_limits<uint32_t>::max(), "Transaction with ID ${tid} lies too far into block ${num} to be indexed",
+                      ("tid", trx_id)("num", block_num));
+            db.create<transaction_history_object>([&](transaction_history_object& transaction_history) {
                transaction_history.block_id = block_id;
-               transaction_history.transaction_id = trx.id();
+               transaction_history.transaction_id = trx_id;
+               transaction_history.block_num = block_num;
+               transaction_history.cycle_index = cycle_index;
+               transaction_history.thread_index = thread_index;
+               transaction_history.trx_index = trx_index;
+               transaction_history.block_offset = trx_offset;
             });
 
             for (const auto& account_name : trx.scope)
             {
-               db.create<account_transaction_history_object>([&trx,&account_name](account_transaction_history_object& account_transaction_history) {
+               const auto account_seq = next_account_seq(db, account_name);
+               db.create<account_transaction_history_object>([&](account_transaction_history_object& account_transaction_history) {
                   account_transaction_history.account_name = account_name;
-                  account_transaction_history.transaction_id = trx.id();
+                  account_transaction_history.account_seq = account_seq;
+                  account_transaction_history.transaction_id = trx_id;
                });
             }
 
@@ -415,16 +468,12 @@ void account_history_plugin::plugin_initialize(const variables_map& options)
 
 void account_history_plugin::plugin_startup()
 {
-   my->chain_plug = app().find_plugin<chain_plugin>();
-   auto& db = my->chain_plug->chain().get_mutable_database();
-   db.add_index<account_control_history_multi_index>();
-   db.add_index<account_transaction_history_multi_index>();
-   db.add_index<public_key_history_multi_index>();
-   db.add_index<transaction_history_multi_index>();
+   start_indexing(app().find_plugin<chain_plugin>()->chain());
+}
 
-   my->chain_plug->chain().applied_block.connect ([&impl = my](const signed_block& block) {
-      impl->applied_block(block);
-   });
+void account_history_plugin::start_indexing(chain::chain_controller& chain)
+{
+   my->start_indexing(chain);
 }
 
 void account_history_plugin::plugin_shutdown()
@@ -436,12 +485,12 @@ namespace account_history_apis {
 read_only::get_transaction_results read_only::get_transaction(const read_only::get_transaction_params& params) const
 {
    auto trx = account_history->get_transaction(params.transaction_id);
-   return { params.transaction_id, account_history->chain_plug->chain().transaction_to_variant(trx) };
+   return { params.transaction_id, account_history->chain->transaction_to_variant(trx) };
 }
 
 read_only::get_transactions_results read_only::get_transactions(const read_only::get_transactions_params& params) const
 {
-   return account_history->get_transactions(params.account_name, params.skip_seq, params.num_seq);
+   return account_history->get_transactions(params.account_name, params.skip_seq, params.num_seq, params.oldest_first && *params.oldest_first);
 }
 
 read_only::get_key_accounts_results read_only::get_key_accounts(const get_key_accounts_params& params) const
@@ -41,6 +41,7 @@ public:
       chain::AccountName  account_name;
       optional<uint32_t>  skip_seq;
       optional<uint32_t>  num_seq;
+      optional<bool>      oldest_first; ///< seq_num 0 is the account's first transaction rather than its latest
    };
    struct ordered_transaction_results {
       uint32_t                    seq_num;
@@ -94,6 +95,12 @@ public:
    void plugin_startup();
    void plugin_shutdown();
 
+   /**
+    * Index the blocks @ref chain applies from now on. plugin_startup does this for the chain of the chain_plugin;
+    * tests call it with a chain of their own.
+    */
+   void start_indexing(chain::chain_controller& chain);
+
    account_history_apis::read_only get_read_only_api() const { return account_history_apis::read_only(account_history_const_ptr(my)); }
    account_history_apis::read_write get_read_write_api() { return account_history_apis::read_write(my); }
 
@@ -106,7 +113,7 @@ private:
 FC_REFLECT(eos::account_history_apis::empty, )
 FC_REFLECT(eos::account_history_apis::read_only::get_transaction_params, (transaction_id) )
 FC_REFLECT(eos::account_history_apis::read_only::get_transaction_results, (transaction_id)(transaction) )
-FC_REFLECT(eos::account_history_apis::read_only::get_transactions_params, (account_name)(skip_seq)(num_seq) )
+FC_REFLECT(eos::account_history_apis::read_only::get_transactions_params, (account_name)(skip_seq)(num_seq)(oldest_first) )
 FC_REFLECT(eos::account_history_apis::read_only::ordered_transaction_results, (seq_num)(transaction_id)(transaction) )
 FC_REFLECT(eos::account_history_apis::read_only::get_transactions_results, (transactions)(time_limit_exceeded_error) )
 FC_REFLECT(eos::account_history_apis::read_only::get_key_accounts_params, (public_key) )
@@ -26,12 +26,14 @@ class account_transaction_history_object : public chainbase::object<chain::accou
 
    id_type                            id;
    AccountName                        account_name;
-   transaction_id_type                transaction_id;
+   uint32_t                           account_seq = 0; ///< counts the account's transactions from 0, oldest first
+   transaction_id_type                transaction_id; ///< located through its transaction_history_object
 };
 
 struct by_id;
 struct by_account_name;
 struct by_account_name_trx_id;
+struct by_account_seq;
 using account_transaction_history_multi_index = chainbase::shared_multi_index_container<
    account_transaction_history_object,
    indexed_by<
@@ -43,6 +45,12 @@ using account_transaction_history_multi_index = chainbase::shared_multi_index_co
             member<account_transaction_history_object, transaction_id_type, &account_transaction_history_object::transaction_id>
          >,
          composite_key_hash< std::hash<AccountName>, std::hash<transaction_id_type> >
+      >,
+      ordered_unique<tag<by_account_seq>,
+         composite_key< account_transaction_history_object,
+            member<account_transaction_history_object, AccountName, &account_transaction_history_object::account_name>,
+            member<account_transaction_history_object, uint32_t, &account_transaction_history_object::account_seq>
+         >
       >
    >
 >;
@@ -53,5 +61,5 @@ typedef chainbase::generic_index<account_transaction_history_multi_index> accoun
 
 CHAINBASE_SET_INDEX_TYPE( eos::account_transaction_history_object, eos::account_transaction_history_multi_index )
 
-FC_REFLECT( eos::account_transaction_history_object, (account_name)(transaction_id) )
+FC_REFLECT( eos::account_transaction_history_object, (account_name)(account_seq)(transaction_id) )
 
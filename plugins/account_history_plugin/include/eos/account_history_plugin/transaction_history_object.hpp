@@ -13,6 +13,14 @@ class transaction_history_object : public chainbase::object<chain::transaction_h
    id_type             id;
    block_id_type       block_id;
    transaction_id_type transaction_id;
+
+   /// Where the transaction sits in its block, so it can be read back without scanning the block
+   uint32_t            block_num = 0;
+   uint16_t            cycle_index = 0;
+   uint16_t            thread_index = 0;
+   uint32_t            trx_index = 0;
+   /// Byte offset of the packed transaction from the start of the packed block
+   uint32_t            block_offset = 0;
 };
 
 struct by_id;
@@ -31,5 +39,5 @@ typedef chainbase::generic_index<transaction_history_multi_index> transaction_hi
 
 CHAINBASE_SET_INDEX_TYPE( eos::transaction_history_object, eos::transaction_history_multi_index )
 
-FC_REFLECT( eos::transaction_history_object, (block_id)(transaction_id) )
+FC_REFLECT( eos::transaction_history_object, (block_id)(transaction_id)(block_num)(cycle_index)(thread_index)(trx_index)(block_offset) )
 
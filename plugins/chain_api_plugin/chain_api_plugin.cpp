@@ -22,12 +22,17 @@ chain_api_plugin::~chain_api_plugin(){}
 void chain_api_plugin::set_program_options(options_description&, options_description&) {}
 void chain_api_plugin::plugin_initialize(const variables_map&) {}
 
-#define CALL(api_name, api_handle, api_namespace, call_name) \
+template<typename Call>
+static auto call_unlocked(Call&& call) { return call(); }
+
+/// LOCK runs the call itself; parsing the request and serializing the result happen outside of it
+#define CALL(api_name, api_handle, api_namespace, call_name, LOCK) \
 {std::string("/v1/" #api_name "/" #call_name), \
    [this, api_handle](string, string body, url_response_callback cb) mutable { \
           try { \
              if (body.empty()) body = "{}"; \
-             auto result = api_handle.call_name(fc::json::from_string(body).as<api_namespace::call_name ## _params>()); \
+             auto params = fc::json::from_string(body).as<api_namespace::call_name ## _params>(); \
+             auto result = LOCK([&]() { return api_handle.call_name(params); }); \
              cb(200, fc::json::to_string(result)); \
           } catch (fc::eof_exception) { \
              cb(400, "Invalid arguments"); \
@@ -38,8 +43,11 @@ void chain_api_plugin::plugin_initialize(const variables_map&) {}
           } \
        }}
 
-#define CHAIN_RO_CALL(call_name) CALL(chain, ro_api, chain_apis::read_only, call_name)
-#define CHAIN_RW_CALL(call_name) CALL(chain, rw_api, chain_apis::read_write, call_name)
+// Read-only calls run on the http worker threads, so they must hold the database read lock. That lock covers the fork
+// database and the block log as well, which get_block and get_info read, only because the chain_controller changes
+// them under with_write_lock alone; see chain_controller::_fork_db
+#define CHAIN_RO_CALL(call_name) CALL(chain, ro_api, chain_apis::read_only, call_name, my->db.get_database().with_read_lock)
+#define CHAIN_RW_CALL(call_name) CALL(chain, rw_api, chain_apis::read_write, call_name, call_unlocked)
 
 void chain_api_plugin::plugin_startup() {
    ilog( "starting chain_api_plugin" );
@@ -47,7 +55,7 @@ void chain_api_plugin::plugin_startup() {
    auto ro_api = app().get_plugin<chain_plugin>().get_read_only_api();
    auto rw_api = app().get_plugin<chain_plugin>().get_read_write_api();
 
-   app().get_plugin<http_plugin>().add_api({
+   app().get_plugin<http_plugin>().add_read_only_api({
       CHAIN_RO_CALL(get_info),
       CHAIN_RO_CALL(get_block),
       CHAIN_RO_CALL(get_account),
@@ -55,7 +63,9 @@ void chain_api_plugin::plugin_startup() {
       CHAIN_RO_CALL(get_table_rows),
       CHAIN_RO_CALL(abi_json_to_bin),
       CHAIN_RO_CALL(abi_bin_to_json),
-      CHAIN_RO_CALL(get_required_keys),
+      CHAIN_RO_CALL(get_required_keys)
+   });
+   app().get_plugin<http_plugin>().add_api({
       CHAIN_RW_CALL(push_block),
       CHAIN_RW_CALL(push_transaction),
       CHAIN_RW_CALL(push_transactions)
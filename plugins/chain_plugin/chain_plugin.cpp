@@ -5,6 +5,7 @@
 #include <eos/chain/producer_object.hpp>
 #include <eos/chain/config.hpp>
 #include <eos/chain/types.hpp>
+#include <eos/chain/wasm_interface.hpp>
 
 #include <eos/native_contract/native_contract_chain_initializer.hpp>
 #include <eos/native_contract/native_contract_chain_administrator.hpp>
@@ -41,7 +42,10 @@ public:
    bfs::path                        genesis_file;
    chain::Time                      genesis_timestamp;
    uint32_t                         skip_flags = chain_controller::skip_nothing;
+   chain_controller::replay_trust   replay_trust = chain_controller::replay_trust::signatures;
    bool                             readonly = false;
+   fc::optional<fc::path>           snapshot_to_load;
+   fc::optional<fc::path>           snapshot_to_write;
    flat_map<uint32_t,block_id_type> loaded_checkpoints;
 
    fc::optional<fork_database>      fork_db;
@@ -65,10 +69,19 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
          ("block-log-dir", bpo::value<bfs::path>()->default_value("blocks"),
           "the location of the block log (absolute path or relative to application data dir)")
          ("checkpoint,c", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
+         ("wasm-cache-size", bpo::value<uint32_t>()->default_value(config::DefaultMaxWasmInstances),
+          "Maximum number of contracts kept instantiated in memory")
          ;
    cli.add_options()
          ("replay-blockchain", bpo::bool_switch()->default_value(false),
           "clear chain database and replay all blocks")
+         ("replay-trust", bpo::value<string>()->default_value("signatures"),
+          "what to trust in blocks replayed from the block log: nothing, signatures or everything")
+         ("snapshot", bpo::value<bfs::path>(),
+          "clear chain database and load the chain state from a snapshot, then replay the block log from the block it "
+          "was written at")
+         ("write-snapshot", bpo::value<bfs::path>(),
+          "once the chain has started, write a snapshot of its state to the given file")
          ("resync-blockchain", bpo::bool_switch()->default_value(false),
           "clear chain database and block log")
          ("skip-transaction-signatures", bpo::bool_switch()->default_value(false),
@@ -105,10 +118,32 @@ void chain_plugin::plugin_initialize(const variables_map& options) {
          my->block_log_dir = bld;
    }
 
+   if (options.count("wasm-cache-size"))
+      chain::wasm_interface::set_max_instances(options.at("wasm-cache-size").as<uint32_t>());
+
+   if (options.count("replay-trust")) {
+      auto trust = options.at("replay-trust").as<string>();
+      if (trust == "nothing")
+         my->replay_trust = chain_controller::replay_trust::nothing;
+      else if (trust == "signatures")
+         my->replay_trust = chain_controller::replay_trust::signatures;
+      else if (trust == "everything")
+         my->replay_trust = chain_controller::replay_trust::everything;
+      else
+         FC_THROW_EXCEPTION(fc::invalid_arg_exception, "Unknown replay trust level ${t}", ("t", trust));
+   }
+
    if (options.at("replay-blockchain").as<bool>()) {
       ilog("Replay requested: wiping database");
       app().get_plugin<database_plugin>().wipe_database();
    }
+   if (options.count("snapshot")) {
+      my->snapshot_to_load = fc::path(options.at("snapshot").as<bfs::path>());
+      ilog("Snapshot requested: wiping database");
+      app().get_plugin<database_plugin>().wipe_database();
+   }
+   if (options.count("write-snapshot"))
+      my->snapshot_to_write = fc::path(options.at("write-snapshot").as<bfs::path>());
    if (options.at("resync-blockchain").as<bool>()) {
       ilog("Resync requested: wiping blocks");
       app().get_plugin<database_plugin>().wipe_database();
@@ -160,7 +195,13 @@ void chain_plugin::plugin_startup()
    my->block_logger = block_log(my->block_log_dir);
    my->chain_id = genesis.compute_chain_id();
    my->chain = chain_controller(db, *my->fork_db, *my->block_logger,
-                                initializer, native_contract::make_administrator());
+                                initializer, native_contract::make_administrator(), my->replay_trust,
+                                my->snapshot_to_load);
+
+   // The chain has just been opened, so the head block is irreversible and a node started from the snapshot will
+   // find it in its block log
+   if (my->snapshot_to_write)
+      my->chain->write_snapshot(*my->snapshot_to_write);
 
    if(!my->readonly) {
       ilog("starting chain in read/write mode");
@@ -227,18 +268,6 @@ read_only::get_info_results read_only::get_info(const read_only::get_info_params
    };
 }
 
-types::Abi getAbi( const chain_controller& db, const Name& account ) {
-   const auto& d = db.get_database();
-   const auto& code_accnt  = d.get<account_object,by_name>( account );
-
-   eos::types::Abi abi;
-   if( code_accnt.abi.size() > 4 ) {
-      fc::datastream<const char*> ds( code_accnt.abi.data(), code_accnt.abi.size() );
-      fc::raw::unpack( ds, abi );
-   }
-   return abi;
-}
-
 string getTableType( const types::Abi& abi, const Name& tablename ) {
    for( const auto& t : abi.tables ) {
       if( t.table == tablename )
@@ -250,26 +279,27 @@ string getTableType( const types::Abi& abi, const Name& tablename ) {
 read_only::get_table_rows_result read_only::get_table_rows( const read_only::get_table_rows_params& p )const {
    const auto& d = db.get_database();
 
-   const types::Abi abi = getAbi( db, p.code );
-   auto table_type = getTableType( abi, p.table );
+   const auto abi = db.get_abi( p.code );
+   FC_ASSERT( abi, "Account ${code} has no ABI", ("code",p.code) );
+   auto table_type = getTableType( abi->abi, p.table );
    auto table_key = PRIMARY;
 
    if( table_type == KEYi64 ) {
-      return get_table_rows_ex<chain::key_value_index, chain::by_scope_primary>(p,abi);
+      return get_table_rows_ex<chain::key_value_index, chain::by_scope_primary>(p,abi->serializer);
    } else if( table_type == KEYi128i128 ) { 
       if( table_key == PRIMARY )
-         return get_table_rows_ex<chain::key128x128_value_index, chain::by_scope_primary>(p,abi);
+         return get_table_rows_ex<chain::key128x128_value_index, chain::by_scope_primary>(p,abi->serializer);
       if( table_key == SECONDARY )
-         return get_table_rows_ex<chain::key128x128_value_index, chain::by_scope_secondary>(p,abi);
+         return get_table_rows_ex<chain::key128x128_value_index, chain::by_scope_secondary>(p,abi->serializer);
    } else if( table_type == KEYi64i64i64 ) {
       if( table_key == PRIMARY )
-         return get_table_rows_ex<chain::key64x64x64_value_index, chain::by_scope_primary>(p,abi);
+         return get_table_rows_ex<chain::key64x64x64_value_index, chain::by_scope_primary>(p,abi->serializer);
       if( table_key == SECONDARY )
-         return get_table_rows_ex<chain::key64x64x64_value_index, chain::by_scope_secondary>(p,abi);
+         return get_table_rows_ex<chain::key64x64x64_value_index, chain::by_scope_secondary>(p,abi->serializer);
       if( table_key == TERTIARY )
-         return get_table_rows_ex<chain::key64x64x64_value_index, chain::by_scope_tertiary>(p,abi);
+         return get_table_rows_ex<chain::key64x64x64_value_index, chain::by_scope_tertiary>(p,abi->serializer);
    }
-   FC_ASSERT( false, "invalid table type/key ${type}/${key}", ("type",table_type)("key",table_key)("abi",abi));
+   FC_ASSERT( false, "invalid table type/key ${type}/${key}", ("type",table_type)("key",table_key)("abi",abi->abi));
 }
 
 read_only::get_block_results read_only::get_block(const read_only::get_block_params& params) const {
@@ -301,11 +331,28 @@ read_write::push_transaction_results read_write::push_transaction(const read_wri
 read_write::push_transactions_results read_write::push_transactions(const read_write::push_transactions_params& params) {
    FC_ASSERT( params.size() <= 1000, "Attempt to push too many transactions at once" );
 
+   // Convert the whole batch first, so the signing keys of every transaction can be recovered in parallel
+   // before they are pushed one at a time
+   vector<chain::SignedTransaction> inputs;
+   vector<optional<fc::exception>> errors(params.size());
+   inputs.reserve(params.size());
+   for( size_t i = 0; i < params.size(); ++i ) {
+      try {
+        inputs.emplace_back( db.transaction_from_variant( params[i] ) );
+      } catch ( const fc::exception& e ) {
+        inputs.emplace_back();
+        errors[i] = e;
+      }
+   }
+   db.prevalidate_signatures( inputs );
+
    push_transactions_results result;
    result.reserve(params.size());
-   for( const auto& item : params ) {
+   for( size_t i = 0; i < params.size(); ++i ) {
       try {
-        result.emplace_back( push_transaction( item ) ); 
+        if( errors[i] ) throw *errors[i];
+        auto ptrx = db.push_transaction( inputs[i], skip_flags );
+        result.emplace_back( read_write::push_transaction_results{ inputs[i].id(), db.transaction_to_variant( ptrx ) } );
       } catch ( const fc::exception& e ) {
         result.emplace_back( read_write::push_transaction_results{ chain::transaction_id_type(), 
                           fc::mutable_variant_object( "error", e.to_detail_string() ) } );
@@ -324,12 +371,8 @@ read_only::get_code_results read_only::get_code( const get_code_params& params )
       result.wast = chain::wasm_to_wast( (const uint8_t*)accnt.code.data(), accnt.code.size() );
       result.code_hash = fc::sha256::hash( accnt.code.data(), accnt.code.size() );
    }
-   if( accnt.abi.size() > 4 ) {
-      eos::types::Abi abi;
-      fc::datastream<const char*> ds( accnt.abi.data(), accnt.abi.size() );
-      fc::raw::unpack( ds, abi );
-      result.abi = std::move(abi);
-   }
+   if( auto abi = db.get_abi( params.name ) )
+      result.abi = abi->abi;
    return result;
 }
 
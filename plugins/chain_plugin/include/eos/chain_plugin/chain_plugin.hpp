@@ -191,13 +191,9 @@ public:
    }
  
    template <typename IndexType, typename Scope>
-   read_only::get_table_rows_result get_table_rows_ex( const read_only::get_table_rows_params& p, const types::Abi& abi )const {
+   read_only::get_table_rows_result get_table_rows_ex( const read_only::get_table_rows_params& p, const types::AbiSerializer& abis )const {
       read_only::get_table_rows_result result;
       const auto& d = db.get_database();
-      const auto& code_account = d.get<chain::account_object,chain::by_name>( p.code );
-   
-      types::AbiSerializer abis;
-      abis.setAbi(abi);
    
       const auto& idx = d.get_index<IndexType, Scope>();
       auto lower = idx.lower_bound( boost::make_tuple(p.scope, p.code, p.table   ) );
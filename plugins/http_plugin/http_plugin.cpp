@@ -74,17 +74,66 @@ namespace eos {
 
    using websocket_server_type = websocketpp::server<detail::asio_with_stub_log>;
 
+   constexpr auto def_http_threads = 2;
+
    class http_plugin_impl {
       public:
+         struct registered_handler {
+            url_handler handler;
+            bool        read_only = false;
+         };
+
          //shared_ptr<std::thread>  http_thread;
          //asio::io_service         http_ios;
-         map<string,url_handler>  url_handlers;
+         map<string,registered_handler>  url_handlers;
          optional<tcp::endpoint>  listen_endpoint;
          string                   access_control_allow_origin;
          string                   access_control_allow_headers;
          bool                     access_control_allow_credentials = false;
 
          websocket_server_type    server;
+
+         /// Runs read-only handlers, and the serialization of their responses, off the application thread
+         uint16_t                             thread_pool_size = def_http_threads;
+         asio::io_service                     thread_pool_ios;
+         optional<asio::io_service::work>     thread_pool_work;
+         std::vector<std::thread>             thread_pool;
+
+         /// Calls handler and reports any exception it throws through cb
+         static void invoke(const url_handler& handler, const string& resource, const string& body,
+                            const url_response_callback& cb) {
+            try {
+               handler(resource, body, cb);
+            } catch( const fc::exception& e ) {
+               elog( "http: ${e}", ("e",e.to_detail_string()));
+               cb(websocketpp::http::status_code::internal_server_error, e.to_detail_string());
+            } catch( const std::exception& e ) {
+               elog( "http: ${e}", ("e",e.what()));
+               cb(websocketpp::http::status_code::internal_server_error, e.what());
+            } catch( ... ) {
+               cb(websocketpp::http::status_code::internal_server_error, "unknown exception");
+            }
+         }
+
+         /**
+          * Runs a read-only handler on the thread pool. The response is deferred until the handler calls back, and
+          * is then sent from the application thread, which owns the connection. The handler runs alongside block
+          * production, so it relies on the chain changing its state, fork database included, only under the
+          * database write lock.
+          */
+         void dispatch_read_only(websocket_server_type::connection_ptr con, const url_handler& handler,
+                                 string resource, string body) {
+            con->defer_http_response();
+            thread_pool_ios.post([con, handler, resource, body]() {
+               invoke(handler, resource, body, [con](int code, string response) {
+                  app().get_io_service().post([con, code, response]() {
+                     con->set_body(response);
+                     con->set_status(websocketpp::http::status_code::value(code));
+                     con->send_http_response();
+                  });
+               });
+            });
+         }
    };
 
    http_plugin::http_plugin():my(new http_plugin_impl()){}
@@ -114,10 +163,14 @@ namespace eos {
                 if (v) ilog("configured http with Access-Control-Allow-Credentials: true");
              })->default_value(false),
              "Specify if Access-Control-Allow-Credentials: true should be returned on each request.")
+
+            ("http-threads", bpo::value<uint16_t>()->default_value(def_http_threads),
+             "Number of worker threads for read-only API calls; 0 handles every call on the application thread.")
             ;
    }
 
    void http_plugin::plugin_initialize(const variables_map& options) {
+      my->thread_pool_size = options.at("http-threads").as<uint16_t>();
       if(options.count("http-server-endpoint")) {
         #if 0
          auto lipstr = options.at("http-server-endpoint").as< string >();
@@ -168,8 +221,10 @@ namespace eos {
                      auto body = con->get_request_body();
                      auto resource = con->get_uri()->get_resource();
                      auto handler_itr = my->url_handlers.find(resource);
-                     if(handler_itr != my->url_handlers.end()) {
-                        handler_itr->second(resource, body, [con,this](int code, string body) {
+                     if(handler_itr != my->url_handlers.end() && handler_itr->second.read_only && my->thread_pool_size) {
+                        my->dispatch_read_only(con, handler_itr->second.handler, resource, body);
+                     } else if(handler_itr != my->url_handlers.end()) {
+                        handler_itr->second.handler(resource, body, [con,this](int code, string body) {
                            con->set_body(body);
                            con->set_status(websocketpp::http::status_code::value(code));
                         });
@@ -192,6 +247,10 @@ namespace eos {
                   }
                });
 
+               my->thread_pool_work.emplace(my->thread_pool_ios);
+               for (uint16_t i = 0; i < my->thread_pool_size; ++i)
+                  my->thread_pool.emplace_back([this]() { my->thread_pool_ios.run(); });
+
                ilog("start listening for http requests");
                my->server.listen(*my->listen_endpoint);
                my->server.start_accept();
@@ -214,6 +273,12 @@ namespace eos {
      // if(my->http_thread) {
          if(my->server.is_listening())
              my->server.stop_listening();
+
+         my->thread_pool_work.reset();
+         my->thread_pool_ios.stop();
+         for (auto& thread : my->thread_pool)
+            thread.join();
+         my->thread_pool.clear();
      //    my->http_ios.stop();
      //    my->http_thread->join();
      //    my->http_thread.reset();
@@ -223,7 +288,14 @@ namespace eos {
    void http_plugin::add_handler(const string& url, const url_handler& handler) {
       ilog( "add api url: ${c}", ("c",url) );
       app().get_io_service().post([=](){
-        my->url_handlers.insert(std::make_pair(url,handler));
+        my->url_handlers.insert(std::make_pair(url,http_plugin_impl::registered_handler{handler, false}));
+      });
+   }
+
+   void http_plugin::add_read_only_handler(const string& url, const url_handler& handler) {
+      ilog( "add read-only api url: ${c}", ("c",url) );
+      app().get_io_service().post([=](){
+        my->url_handlers.insert(std::make_pair(url,http_plugin_impl::registered_handler{handler, true}));
       });
    }
 }
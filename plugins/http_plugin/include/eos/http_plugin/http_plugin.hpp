@@ -43,6 +43,10 @@ namespace eos {
     *  thread.  The callback can be called from any thread and will 
     *  automatically propagate the call to the http thread.
     *
+    *  Handlers registered as read-only are instead called on a pool of
+    *  http-threads worker threads, so that reads of the chain do not hold up
+    *  block production. Such a handler must take any locks it needs itself.
+    *
     *  The HTTP service will run in its own thread with its own io_service to
     *  make sure that HTTP request processing does not interfer with other
     *  plugins.  
@@ -66,6 +70,13 @@ namespace eos {
               add_handler(call.first, call.second);
         }
 
+        /// Register a handler which may run concurrently with the application thread and other read-only handlers
+        void add_read_only_handler(const string& url, const url_handler&);
+        void add_read_only_api(const api_description& api) {
+           for (const auto& call : api)
+              add_read_only_handler(call.first, call.second);
+        }
+
       private:
         std::unique_ptr<class http_plugin_impl> my;
    };
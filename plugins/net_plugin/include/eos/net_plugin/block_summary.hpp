@@ -0,0 +1,110 @@
+#pragma once
+#include <eos/net_plugin/protocol.hpp>
+
+#include <unordered_map>
+
+namespace eos {
+
+   /// The user input of a block in order, counting across all threads
+   template<typename Block>
+   auto flatten_user_input( Block& sb ) -> vector<decltype(&sb.cycles[0][0].user_input[0])> {
+      vector<decltype(&sb.cycles[0][0].user_input[0])> user_input;
+      for( auto& cyc : sb.cycles )
+         for( auto& thr : cyc )
+            for( auto& ui : thr.user_input )
+               user_input.push_back( &ui );
+      return user_input;
+   }
+
+   /// @return the summary of a block, in which its user input is identified by short id
+   inline block_summary_message make_block_summary( const signed_block& sb ) {
+      block_summary_message bsm;
+      bsm.header = sb;
+      for( const auto& cyc : sb.cycles ) {
+         bsm.cycles.emplace_back();
+         for( const auto& thr : cyc ) {
+            compact_thread ct;
+            ct.generated_input = thr.generated_input;
+            for( const auto& ui : thr.user_input )
+               ct.user_input.push_back( compact_transaction{ short_trx_id( ui.id() ), ui.output } );
+            bsm.cycles.back().push_back( std::move(ct) );
+         }
+      }
+      return bsm;
+   }
+
+   /**
+    * A block rebuilt from a summary, waiting for the user input that was not found locally
+    */
+   struct partial_block {
+      signed_block      block;
+      vector<uint32_t>  missing; ///< positions of the missing user input, counting across all threads in order
+      vector<uint64_t>  missing_ids; ///< the short ids the summary gave for them
+      fc::time_point    requested; ///< when the missing user input was asked for
+
+      /**
+       * Rebuilds the block of a summary from the transactions available locally
+       * @param known transactions by short id; a short id shared by several transactions maps to nullptr, so that
+       * the transaction is asked for rather than guessed
+       */
+      static partial_block rebuild( const block_summary_message& summary,
+                                    const std::unordered_map<uint64_t, const SignedTransaction*>& known ) {
+         partial_block pb;
+         static_cast<signed_block_header&>(pb.block) = summary.header;
+         uint32_t index = 0;
+         for( const auto& cyc : summary.cycles ) {
+            pb.block.cycles.emplace_back();
+            for( const auto& ct : cyc ) {
+               thread thr;
+               thr.generated_input = ct.generated_input;
+               for( const auto& cu : ct.user_input ) {
+                  auto itr = known.find( cu.short_id );
+                  if( itr != known.end() && itr->second ) {
+                     thr.user_input.emplace_back( *itr->second );
+                  } else {
+                     thr.user_input.emplace_back();
+                     pb.missing.push_back( index );
+                     pb.missing_ids.push_back( cu.short_id );
+                  }
+                  thr.user_input.back().output = cu.output;
+                  ++index;
+               }
+               pb.block.cycles.back().push_back( std::move(thr) );
+            }
+         }
+         return pb;
+      }
+
+      /**
+       * Fills in the missing user input with the transactions a peer sent for it
+       * @return false if they are not the transactions that were asked for
+       */
+      bool fill( const vector<SignedTransaction>& trxs ) {
+         if( trxs.size() != missing.size() )
+            return false;
+         for( size_t i = 0; i < missing.size(); ++i )
+            if( short_trx_id( trxs[i].id() ) != missing_ids[i] )
+               return false;
+
+         auto user_input = flatten_user_input( block );
+         for( size_t i = 0; i < missing.size(); ++i ) {
+            auto& ui = *user_input[missing[i]];
+            auto output = std::move(ui.output);
+            ui = ProcessedTransaction( trxs[i] );
+            ui.output = std::move(output);
+         }
+         missing.clear();
+         missing_ids.clear();
+         return true;
+      }
+
+      /**
+       * @return true if the block has all of its user input, and it is the user input of the block the summary was
+       * made from; a short id that matched a different transaction shows up as a merkle root mismatch
+       */
+      bool matches_header()const {
+         return missing.empty() && block.calculate_merkle_root() == block.transaction_merkle_root;
+      }
+   };
+
+} // eos
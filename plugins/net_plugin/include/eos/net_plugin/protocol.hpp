@@ -28,9 +28,46 @@ namespace eos {
       vector<transaction_id_type> req_trx;
    };
 
+   /// Identifies a transaction within a block summary by the first 64 bits of its id
+   inline uint64_t short_trx_id( const transaction_id_type& id ) {
+      return id._hash[0];
+   }
+
+   struct compact_transaction {
+      uint64_t                short_id;
+      vector<MessageOutput>   output;
+   };
+
+   struct compact_thread {
+      vector<ProcessedGeneratedTransaction> generated_input;
+      vector<compact_transaction>           user_input;
+   };
+
+   /**
+    * A block with its user input transactions replaced by their short ids, for peers which already have most of
+    * them. The receiver rebuilds the block from the transactions it knows, asks for the ones it is missing with a
+    * block_transactions_request_message, and falls back to a block_request_message for the whole block if the
+    * rebuilt block does not match the header.
+    */
    struct block_summary_message {
-      block_id_type             block;
-      vector<transaction_id_type> trx_ids;
+      signed_block_header             header;
+      vector<vector<compact_thread>>  cycles;
+   };
+
+   /// Asks for the user input transactions of a block by their position in it, counting across all threads in order
+   struct block_transactions_request_message {
+      block_id_type     block;
+      vector<uint32_t>  indexes;
+   };
+
+   /// The transactions asked for by a block_transactions_request_message, in the order they were asked for
+   struct block_transactions_message {
+      block_id_type              block;
+      vector<SignedTransaction>  trxs;
+   };
+
+   struct block_request_message {
+      block_id_type block;
    };
 
    struct sync_request_message {
@@ -44,7 +81,10 @@ namespace eos {
                                       sync_request_message,
                                       block_summary_message,
                                       SignedTransaction,
-                                      signed_block>;
+                                      signed_block,
+                                      block_transactions_request_message,
+                                      block_transactions_message,
+                                      block_request_message>;
 
 } // namespace eos
 
@@ -56,7 +96,12 @@ FC_REFLECT( eos::handshake_message,
             (head_num)(head_id)
             (os)(agent) )
 
-FC_REFLECT( eos::block_summary_message, (block)(trx_ids) )
+FC_REFLECT( eos::compact_transaction, (short_id)(output) )
+FC_REFLECT( eos::compact_thread, (generated_input)(user_input) )
+FC_REFLECT( eos::block_summary_message, (header)(cycles) )
+FC_REFLECT( eos::block_transactions_request_message, (block)(indexes) )
+FC_REFLECT( eos::block_transactions_message, (block)(trxs) )
+FC_REFLECT( eos::block_request_message, (block) )
 FC_REFLECT( eos::notice_message, (known_trx) )
 FC_REFLECT( eos::request_message, (req_trx) )
 FC_REFLECT( eos::sync_request_message, (start_block)(end_block) )
@@ -108,8 +153,9 @@ State:
 
       if notice message update list of transactions known by remote peer
       if trx message then insert into global state as unvalidated
-      if blk summary message then insert into global state *if* we know of all dependent transactions
-         else close connection
+      if blk summary message then rebuild the block from the pending transactions
+         request the transactions that are not known from the peer
+         request the whole block if the rebuilt block does not match its merkle root
 
 
     if my head block < the LIB of a peer and my head block age > block interval * round_size/2 then
@@ -2,9 +2,13 @@
 
 #include <eos/net_plugin/net_plugin.hpp>
 #include <eos/net_plugin/protocol.hpp>
+#include <eos/net_plugin/block_summary.hpp>
+#include <eos/utilities/rolling_bloom_filter.hpp>
 #include <eos/chain/chain_controller.hpp>
 #include <eos/chain/exceptions.hpp>
 #include <eos/chain/block.hpp>
+#include <eos/chain/fork_database.hpp>
+#include <eos/chain/producer_object.hpp>
 
 #include <fc/network/ip.hpp>
 #include <fc/io/raw.hpp>
@@ -13,9 +17,12 @@
 #include <fc/crypto/rand.hpp>
 #include <fc/exception/exception.hpp>
 
+#include <unordered_map>
+
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 
 namespace eos {
   using std::vector;
@@ -36,6 +43,21 @@ namespace eos {
 
   using socket_ptr = std::shared_ptr<tcp::socket>;
 
+  /**
+   * A message packed for the wire, size prefix included. Broadcasts pack a message once and queue the same buffer
+   * to every peer, so it must not be modified once shared.
+   */
+  using shared_message = std::shared_ptr<const vector<char>>;
+
+  static shared_message pack_message( const net_message& m ) {
+    uint32_t message_size = fc::raw::pack_size( m );
+    auto buffer = std::make_shared<vector<char>>( message_size + sizeof(message_size) );
+    fc::datastream<char*> ds( buffer->data(), buffer->size() );
+    ds.write( (char*)&message_size, sizeof(message_size) );
+    fc::raw::pack( ds, m );
+    return buffer;
+  }
+
   /**
    * default value initializers
    */
@@ -45,34 +67,16 @@ namespace eos {
   constexpr auto     def_conn_retry_wait = std::chrono::seconds (30);
   constexpr auto     def_txn_expire_wait = std::chrono::seconds (3);
   constexpr auto     def_resp_expected_wait = std::chrono::seconds (1);
-  constexpr auto     def_network_version = 0;
-  constexpr auto     def_sync_rec_span = 10;
+  constexpr auto     def_network_version = 1;
+  constexpr auto     def_sync_rec_span = 100; // blocks per sync request
+  constexpr auto     def_sync_reqs_per_peer = 2; // sync requests kept outstanding with each peer
   constexpr auto     def_max_just_send = 1300 * 3; // "mtu" * 3
-  constexpr auto     def_send_whole_blocks = true;
-
-
-  /**
-   *  Index by id
-   *  Index by is_known, block_num, validated_time, this is the order we will broadcast
-   *  to peer.
-   *  Index by is_noticed, validated_time
-   *
-   */
-  struct transaction_state {
-    transaction_id_type id;
-    bool                is_known_by_peer = false; ///< true if we sent or received this trx to this peer or received notice from peer
-    bool                is_noticed_to_peer = false; ///< have we sent peer notice we know it (true if we receive from this peer)
-    UInt16              block_num = -1; ///< the block number the transaction was included in
-    time_point          validated_time; ///< infinity for unvalidated
-    time_point          requested_time; /// incase we fetch large trx
-  };
+  constexpr auto     def_send_whole_blocks = true; // summaries are opt in, and only for peers that understand them
+  constexpr auto     def_max_write_batch = 64; // queued messages gathered into one write
+  constexpr auto     def_known_trx_per_peer = 100000; // transactions remembered as known by each peer
+  constexpr auto     def_known_trx_false_positive_rate = 1e-6;
+  constexpr auto     def_max_partial_blocks = 4; // summaries kept waiting for transactions per peer
 
-  typedef multi_index_container<
-    transaction_state,
-    indexed_by<
-      ordered_unique< tag<by_id>, member<transaction_state, transaction_id_type, &transaction_state::id > >
-      >
-    > transaction_state_index;
 
   /**
    *
@@ -97,35 +101,41 @@ namespace eos {
   struct sync_state {
     sync_state(uint32_t start = 0, uint32_t end = 0, uint32_t last_acted = 0)
       :start_block ( start ), end_block( end ), last( last_acted ),
-       start_time (time_point::now()), block_cache()
+       start_time (time_point::now())
     {}
     uint32_t     start_block;
     uint32_t     end_block;
     uint32_t     last; ///< last sent or received
-    time_point   start_time; ///< time request made or received
-    vector< vector<char> > block_cache;
+    time_point   start_time; ///< time request made or received, or the last block of it arrived
   };
 
   struct handshake_initializer {
     static void populate (handshake_message &hello);
   };
 
+  uint64_t random_seed() {
+    uint64_t seed;
+    fc::rand_pseudo_bytes( (char*)&seed, sizeof(seed) );
+    return seed;
+  }
+
   class connection : public std::enable_shared_from_this<connection> {
   public:
     connection( string endpoint,
-                size_t send_buf_size = def_buffer_size,
+                uint32_t known_trx_capacity,
+                double known_trx_false_positive_rate,
                 size_t recv_buf_size = def_buffer_size )
       : block_state(),
-        trx_state(),
+        known_trxs( known_trx_capacity, known_trx_false_positive_rate, random_seed() ),
         sync_received(),
         sync_requested(),
         socket( std::make_shared<tcp::socket>( std::ref( app().get_io_service() ))),
         pending_message_size(0),
         pending_message_buffer(recv_buf_size),
-        send_buffer(send_buf_size),
         remote_node_id(),
         last_handshake(),
         out_queue(),
+        writing (false),
         connecting (false),
         syncing (false),
         peer_addr (endpoint),
@@ -136,19 +146,20 @@ namespace eos {
     }
 
     connection( socket_ptr s,
-                size_t send_buf_size = def_buffer_size,
+                uint32_t known_trx_capacity,
+                double known_trx_false_positive_rate,
                 size_t recv_buf_size = def_buffer_size )
       : block_state(),
-        trx_state(),
+        known_trxs( known_trx_capacity, known_trx_false_positive_rate, random_seed() ),
         sync_received(),
         sync_requested(),
         socket( s ),
         pending_message_size(0),
         pending_message_buffer(recv_buf_size),
-        send_buffer(send_buf_size),
         remote_node_id(),
         last_handshake(),
         out_queue(),
+        writing (false),
         connecting (false),
         syncing (false),
         peer_addr (),
@@ -173,25 +184,26 @@ namespace eos {
     }
 
     block_state_index              block_state;
-    transaction_state_index        trx_state;
+    /// transactions we sent to this peer or learned it has; each peer has its own seed, so a false positive only
+    /// withholds a transaction from one peer
+    utilities::rolling_bloom_filter known_trxs;
+    map<block_id_type, partial_block> partial_blocks; ///< summaries from this peer waiting for requested transactions
     vector<sync_state>             sync_received;  // we are requesting info from this peer
     vector<sync_state>             sync_requested; // this peer is requesting info from us
     socket_ptr                     socket;
 
     uint32_t                       pending_message_size;
     vector<char>                   pending_message_buffer;
-    uint32_t                       send_message_size;
-    vector<char>                   send_buffer;
-    vector<char>                   blk_buffer;
-    size_t                         message_size;
 
     fc::sha256                     remote_node_id;
     handshake_message              last_handshake;
-    std::deque<net_message>        out_queue;
+    std::deque<shared_message>     out_queue; ///< messages waiting for the write in progress to finish
+    bool                           writing;
     bool                           connecting;
     bool                           syncing;
     string                         peer_addr;
-    unique_ptr<boost::asio::steady_timer> response_expected;
+    unique_ptr<boost::asio::steady_timer> response_expected; ///< deadline for the next block of sync_received
+    time_point                     sync_stalled_until; ///< no ranges are handed to this peer before then
 
     bool ready () {
       return (socket->is_open() && !connecting);
@@ -205,13 +217,15 @@ namespace eos {
       sync_received.clear();
       sync_requested.clear();
       block_state.clear();
-      trx_state.clear();
+      known_trxs.clear();
+      partial_blocks.clear();
     }
 
     void close () {
       connecting = false;
       syncing = false;
       out_queue.clear();
+      response_expected->cancel();
       if (socket) {
         socket->close();
       }
@@ -224,12 +238,20 @@ namespace eos {
     }
 
     void send( const net_message& m ) {
+      send( pack_message( m ) );
+    }
+
+    void send( const shared_message& m ) {
       out_queue.push_back( m );
-      if( out_queue.size() == 1 ) {
+      if( !writing ) {
         send_next_message();
       }
     }
 
+    /**
+     * Writes everything queued, up to def_max_write_batch messages, with a single gathering write. The batch keeps
+     * its buffers alive until the write completes, even if the connection is closed and its queue cleared meanwhile.
+     */
     void send_next_message() {
       if( !out_queue.size() ) {
         if (sync_requested.size() > 0) {
@@ -238,22 +260,21 @@ namespace eos {
         return;
       }
 
-      auto& m = out_queue.front();
-      send_message_size = fc::raw::pack_size( m );
-      fc::datastream<char*> ds( send_buffer.data(), send_message_size + sizeof(send_message_size) );
-      ds.write( (char*)&send_message_size, sizeof(send_message_size) );
-      fc::raw::pack( ds, m );
+      auto batch = std::make_shared<vector<shared_message>>();
+      vector<boost::asio::const_buffer> buffers;
+      while( out_queue.size() && batch->size() < def_max_write_batch ) {
+        batch->push_back( std::move( out_queue.front() ) );
+        buffers.push_back( boost::asio::buffer( *batch->back() ) );
+        out_queue.pop_front();
+      }
 
-      boost::asio::async_write( *socket, boost::asio::buffer( send_buffer, send_message_size + sizeof(send_message_size) ),
-                   [this]( boost::system::error_code ec, std::size_t /*bytes_transferred*/ ) {
+      writing = true;
+      boost::asio::async_write( *socket, buffers,
+                   [this, batch]( boost::system::error_code ec, std::size_t /*bytes_transferred*/ ) {
+                     writing = false;
                      if( ec ) {
                        elog( "Error sending message: ${msg}", ("msg",ec.message() ) );
                      } else  {
-                       if (!out_queue.size()) {
-                         elog ("out_queue underflow!");
-                       } else {
-                         out_queue.pop_front();
-                       }
                        send_next_message();
                      }
                    });
@@ -286,9 +307,11 @@ namespace eos {
     transaction_id_type id;
     fc::time_point      received;
     fc::time_point_sec  expires;
-    // vector<char>        packed_transaction; //just for the moment
     uint32_t            block_num = -1; /// block transaction was included in
     bool                validated = false; /// whether or not our node has validated it
+    std::shared_ptr<const SignedTransaction> trx; /// kept so that block summaries can be rebuilt from it
+
+    uint64_t short_id()const { return short_trx_id (id); }
   };
 
   struct update_block_num {
@@ -301,6 +324,7 @@ namespace eos {
 
   struct by_expiry;
   struct by_block_num;
+  struct by_short_id;
 
   typedef multi_index_container<
     node_transaction_state,
@@ -321,7 +345,13 @@ namespace eos {
         tag<by_block_num>,
         member< node_transaction_state,
                 uint32_t,
-                &node_transaction_state::block_num > >
+                &node_transaction_state::block_num > >,
+
+      hashed_non_unique<
+        tag<by_short_id>,
+        const_mem_fun< node_transaction_state,
+                       uint64_t,
+                       &node_transaction_state::short_id > >
       >
     >
   node_transaction_index;
@@ -341,12 +371,14 @@ namespace eos {
 
     std::set< connection_ptr >    connections;
     bool                          done = false;
-    uint32_t                      sync_head;
-    uint32_t                      sync_req_head;
+    uint32_t                      sync_head; ///< highest block a peer has told us about
+    uint32_t                      sync_req_head; ///< highest block requested from any peer
     uint32_t                      sync_req_span;
+    std::deque<sync_state>        sync_unassigned; ///< requested ranges whose peer went away, to be requested again
 
     unique_ptr<boost::asio::steady_timer> connector_check;
     unique_ptr<boost::asio::steady_timer> transaction_check;
+    unique_ptr<boost::asio::steady_timer> partial_block_check;
     boost::asio::steady_timer::duration   connector_period;
     boost::asio::steady_timer::duration   txn_exp_period;
     boost::asio::steady_timer::duration   resp_expected_period;
@@ -359,6 +391,8 @@ namespace eos {
     chain_plugin*                 chain_plug;
     size_t                        just_send_it_max;
     bool                          send_whole_blocks;
+    uint32_t                      known_trx_capacity;
+    double                        known_trx_false_positive_rate;
 
     node_transaction_index        local_txns;
     vector<transaction_id_type>   pending_notify;
@@ -428,7 +462,7 @@ namespace eos {
           if( !ec ) {
             if( max_client_count == 0 || num_clients < max_client_count ) {
               ++num_clients;
-              connection_ptr c = std::make_shared<connection>( socket );
+              connection_ptr c = std::make_shared<connection>( socket, known_trx_capacity, known_trx_false_positive_rate );
               connections.insert( c );
               start_session( c );
             } else {
@@ -481,110 +515,168 @@ namespace eos {
 
     template<typename VerifierFunc>
     void send_all (const net_message &msg, VerifierFunc verify) {
+      shared_message packed; // packed on first use and shared by every peer
       for (auto &c : connections) {
         if (c->ready_and_willing() && verify (c)) {
-          c->send(msg);
+          if (!packed) {
+            packed = pack_message(msg);
+          }
+          c->send(packed);
         }
       }
     }
 
-    bool get_sync_req (connection_ptr c) {
-
-      if (sync_req_head == sync_head) {
-        return true;
-      }
-      uint32_t first = sync_req_head + 1;
-      uint32_t last = (first + sync_req_span -1);
-      if (last < sync_head)
-        last = sync_head;
-      c->sync_received.emplace_back (first, last, sync_req_head);
-      sync_request_message srm = {first, last };
-      c->send (srm);
-      sync_req_head = last;
-      return (sync_req_head == sync_head);
+    bool sync_fully_requested () const {
+      return sync_req_head == sync_head && sync_unassigned.empty();
     }
 
-    void set_sync_head (connection_ptr c, uint32_t target) {
-      bool stable = (sync_head == sync_req_head);
-      if (stable) {
-        sync_req_head = chain_plug->chain().head_block_num();
+    /**
+     * Keeps up to def_sync_reqs_per_peer ranges of the missing blocks outstanding with a peer. Ranges given up by a
+     * closed connection are requested again first; new ranges are cut from the rest, no further than the peer's own
+     * head and no further past ours than the fork database will hold blocks that arrive ahead of their parents.
+     * @return true once everything up to sync_head has been requested
+     */
+    bool get_sync_req (connection_ptr c) {
+      if (c->sync_stalled_until > time_point::now()) {
+        return sync_fully_requested();
       }
-      ilog ("Catching up with chain, our head is ${cc}, theirs is ${t}",
-            ("cc",sync_req_head)("t",target));
-      if (target >  sync_head) {
-        sync_head = target;
-        if (stable) {
-          for (auto &ci : connections) {
-            if (ci->ready()) {
-              if (get_sync_req (ci)) {
-                break;
-              }
-            }
+      uint32_t peer_head = c->last_handshake.head_num;
+      uint32_t window = chain_plug->chain().head_block_num() + fork_database::MAX_BLOCK_REORDERING;
+      while (c->sync_received.size() < def_sync_reqs_per_peer && !sync_fully_requested()) {
+        if (!sync_unassigned.empty() && sync_unassigned.front().end_block <= peer_head) {
+          c->sync_received.push_back (sync_unassigned.front());
+          c->sync_received.back().start_time = time_point::now();
+          sync_unassigned.pop_front();
+        }
+        else {
+          uint32_t last = std::min (std::min (sync_req_head + sync_req_span, sync_head), std::min (peer_head, window));
+          if (last <= sync_req_head) {
+            break;
           }
-        } else {
-          get_sync_req (c);
+          c->sync_received.emplace_back (sync_req_head + 1, last, sync_req_head);
+          sync_req_head = last;
         }
+        sync_request_message srm = {c->sync_received.back().last + 1, c->sync_received.back().end_block};
+        c->send (srm);
+        start_sync_timer (c);
       }
+      return sync_fully_requested();
     }
 
-    struct postcache : public fc::visitor<void> {
-      connection_ptr c;
-      chain_plugin * chain_plug;
-      postcache (connection_ptr conn, chain_plugin *cp) : c(conn), chain_plug (cp) {}
+    /**
+     * Gives the peer resp_expected_period to send the next block of the ranges it owes us
+     */
+    void start_sync_timer (connection_ptr c) {
+      if (c->sync_received.empty()) {
+        c->response_expected->cancel();
+        return;
+      }
+      c->response_expected->expires_from_now (resp_expected_period);
+      c->response_expected->async_wait ([this, c](boost::system::error_code ec) {
+          if (!ec) {
+            sync_timeout (c);
+          }
+        });
+    }
 
-      void operator()(const signed_block &block) const
-      {
-        chain_plug->accept_block (block,true);
+    /**
+     * The peer stopped sending the blocks it was asked for. Its ranges go to the other peers, and it is given no
+     * new ones for a while.
+     */
+    void sync_timeout (connection_ptr c) {
+      wlog ("peer ${p} stopped sending requested blocks", ("p", c->peer_addr));
+      requeue_sync_ranges (c);
+      c->sync_stalled_until = time_point::now() + resp_expected_wait();
+      requeue_dropped_blocks ();
+      request_sync_blocks ();
+    }
+
+    /// Moves what is left of the ranges requested from a peer to sync_unassigned
+    void requeue_sync_ranges (connection_ptr c) {
+      uint32_t head = chain_plug->chain().head_block_num();
+      for (const auto &ss : c->sync_received) {
+        if (ss.end_block > head) {
+          sync_unassigned.emplace_back (std::max (ss.last, head) + 1, ss.end_block, std::max (ss.last, head));
+        }
       }
+      c->sync_received.clear();
+      c->response_expected->cancel();
+    }
 
-      template <typename T>
-      void operator()(const T &msg) const
-      {
-        //no-op
+    /**
+     * The fork database drops blocks that arrive too far ahead of the head, or while it already holds as many
+     * unlinked blocks as it will. When no outstanding request covers the block after our head any more, everything
+     * from there up to the first block still expected is requested again.
+     */
+    void requeue_dropped_blocks () {
+      uint32_t head = chain_plug->chain().head_block_num();
+      if (head >= sync_req_head || head >= sync_head) {
+        return;
+      }
+      uint32_t next_expected = sync_req_head + 1;
+      auto expect = [&](const sync_state &ss) {
+        if (ss.end_block > head) {
+          next_expected = std::min (next_expected, std::max (ss.last, head) + 1);
+        }
+      };
+      for (const auto &c : connections) {
+        for (const auto &ss : c->sync_received) {
+          expect (ss);
+        }
       }
+      for (const auto &ss : sync_unassigned) {
+        expect (ss);
+      }
+      if (next_expected > head + 1) {
+        uint32_t last = std::min (next_expected - 1, head + sync_req_span);
+        ilog ("requesting blocks ${f} to ${l} again", ("f", head + 1)("l", last));
+        sync_unassigned.emplace_front (head + 1, last, head);
+      }
+    }
 
-    };
+    /**
+     * Spreads the missing range across every connected peer, so that catching up is not bound by a single peer's
+     * round trips. Blocks that arrive ahead of the head are held by the fork database until they link.
+     */
+    void request_sync_blocks () {
+      for (auto &c : connections) {
+        if (c->ready() && get_sync_req (c)) {
+          break;
+        }
+      }
+    }
 
-    void apply_cached_blocks (connection_ptr conn) {
-      bool keep_going = true;
-      while (keep_going) {
-        keep_going = false;
-        for (auto &c : connections) {
-          try {
-            auto ss = c->sync_received.begin();
-            if (ss == c->sync_received.end()) {
-              get_sync_req(c);
-              continue;
-            }
-            uint32_t start = 1 + chain_plug->chain().head_block_num();
-            if (start == ss->start_block) {
-              if (ss->last < start || ss->block_cache.empty()) {
-                return;
-              }
+    void set_sync_head (connection_ptr c, uint32_t target) {
+      if (sync_fully_requested()) {
+        sync_req_head = std::max (sync_req_head, chain_plug->chain().head_block_num());
+      }
+      ilog ("Catching up with chain, our head is ${cc}, theirs is ${t}",
+            ("cc",chain_plug->chain().head_block_num())("t",target));
+      if (target > sync_head) {
+        sync_head = target;
+      }
+      request_sync_blocks ();
+    }
 
-              for (auto & blk : ss->block_cache) {
-                auto block = fc::raw::unpack<net_message>( blk );
-                postcache pc(c,chain_plug);
-                block.visit (pc);
-                ++start;
-                ss->start_block++;
-              }
-              ss->block_cache.clear();
-              if (start > ss->end_block) {
-                c->sync_received.erase(ss);
-                if (c->sync_received.empty()) {
-                  get_sync_req(c);
-                }
-                keep_going = true;
-              }
-            }
-          } catch (...) {
-              elog ("caught something trying to accept blocks");
-            // not a problem. We found the list but no blocks were cached
-            return;
+    /**
+     * Records the arrival of a requested block, retiring the request it completes and restarting the peer's
+     * deadline.
+     * @return true if the block completed one of this peer's outstanding requests
+     */
+    bool sync_block_received (connection_ptr c, uint32_t num) {
+      for (auto ss = c->sync_received.begin(); ss != c->sync_received.end(); ++ss) {
+        if (num > ss->last && num <= ss->end_block) {
+          ss->last = num;
+          ss->start_time = time_point::now();
+          bool done = num == ss->end_block;
+          if (done) {
+            c->sync_received.erase(ss);
           }
+          start_sync_timer (c);
+          return done;
         }
       }
+      return false;
     }
 
     void handle_message (connection_ptr c, const handshake_message &msg) {
@@ -630,6 +722,7 @@ namespace eos {
         c->remote_node_id = msg.node_id;
       }
 
+      c->last_handshake = msg;
       uint32_t head = cc.head_block_num ();
       if ( msg.head_num  >  head) {
         set_sync_head(c, msg.head_num);
@@ -637,7 +730,6 @@ namespace eos {
       else {
         c->syncing = head != msg.head_num;
       }
-      c->last_handshake = msg;
     }
 
     void handle_message (connection_ptr c, const notice_message &msg) {
@@ -647,10 +739,8 @@ namespace eos {
       request_message req;
 
       for (const auto& t : msg.known_trx) {
-        const auto &tx = c->trx_state.find(t);
-        if (tx == c->trx_state.end()) {
-          c->trx_state.insert((transaction_state){t,true,true,(uint32_t)-1,
-                fc::time_point(),fc::time_point()});
+        if (!c->known_trxs.contains(t)) {
+          c->known_trxs.insert(t);
           fwd.known_trx.push_back(t);
           req.req_trx.push_back(t);
         }
@@ -673,13 +763,8 @@ namespace eos {
       auto conn_ndx = connections.begin();
       for (auto t: msg.req_trx) {
         auto txn = local_txns.get<by_id>().find(t);
-        if (txn != local_txns.end()) {
-          chain_controller &cc = chain_plug->chain();
-          try {
-            send_now.push_back(cc.get_recent_transaction(t));
-          } catch (...) {
-            elog( "failed to retieve transaction");
-          }
+        if (txn != local_txns.end() && txn->trx) {
+          send_now.push_back(*txn->trx);
         }
         else {
           int cycle_count = 2;
@@ -697,8 +782,7 @@ namespace eos {
               ++conn_ndx;
               continue;
             }
-            auto txn = conn_ndx->get()->trx_state.get<by_id>().find(t);
-            if (txn != conn_ndx->get()->trx_state.end()) {
+            if (conn_ndx->get()->known_trxs.contains(t)) {
 
               //forward_to[conn_ndx]->push_back(t);
               break;
@@ -717,41 +801,174 @@ namespace eos {
 
     void handle_message (connection_ptr c, const sync_request_message &msg) {
       c->sync_requested.emplace_back (msg.start_block,msg.end_block,msg.start_block-1);
-      c->write_block_backlog ();
+      if (!c->writing) {
+        c->write_block_backlog ();
+      }
+    }
+
+    /// Send a block to every peer but the one it came from, whole or as a summary
+    void relay_block (connection_ptr from, const signed_block &sb) {
+      auto others = [from](connection_ptr c) -> bool {
+        return c != from;
+      };
+      if (send_whole_blocks) {
+        send_all (sb, others);
+      }
+      else {
+        send_all (make_block_summary(sb), others);
+      }
     }
 
+    /**
+     * Rebuild the block of a summary from the pending transactions, and ask the peer for the transactions that are
+     * not pending here, or whose short id matches more than one pending transaction. Summaries are checked before
+     * they are kept, and a peer holding def_max_partial_blocks of them is asked for further blocks whole.
+     */
     void handle_message (connection_ptr c, const block_summary_message &msg) {
-      const auto& itr = c->block_state.get<by_id>();
-      auto bs = itr.find(msg.block);
-      if (bs == c->block_state.end()) {
-        c->block_state.insert (block_state({msg.block,true,true,fc::time_point()}));
-        send_all (msg, [c](connection_ptr cptr) -> bool {
-            return cptr != c;
+      block_id_type id = msg.header.id();
+      if (c->block_state.find(id) == c->block_state.end()) {
+        c->block_state.insert (block_state({id,true,true,fc::time_point()}));
+      }
+
+      chain_controller &cc = chain_plug->chain();
+      for (auto itr = c->partial_blocks.begin(); itr != c->partial_blocks.end(); ) {
+        if (cc.is_known_block(itr->first))
+          itr = c->partial_blocks.erase(itr);
+        else
+          ++itr;
+      }
+      if (sync_head > cc.head_block_num() || cc.is_known_block(id) || c->partial_blocks.count(id)) {
+        return;
+      }
+
+      // only summaries of blocks that could soon extend our chain, signed by their producer, are kept waiting
+      uint32_t num = msg.header.block_num();
+      if (num <= cc.last_irreversible_block_num() ||
+          num > cc.head_block_num() + fork_database::MAX_BLOCK_REORDERING) {
+        return;
+      }
+      if (!is_producer_signed (msg.header)) {
+        elog ("block summary #${n} is not signed by producer ${p}", ("n", num)("p", msg.header.producer));
+        return;
+      }
+
+      std::unordered_map<uint64_t, const SignedTransaction*> known;
+      for (const auto &cyc : msg.cycles)
+        for (const auto &thr : cyc)
+          for (const auto &ct : thr.user_input)
+            known.emplace (ct.short_id, nullptr);
+      if (!known.empty()) {
+        // a short id matching several different transactions is left missing
+        std::unordered_map<uint64_t, transaction_id_type> seen;
+        auto offer = [&known,&seen](const transaction_id_type &id, const SignedTransaction &trx) {
+          auto sid = short_trx_id (id);
+          auto itr = known.find (sid);
+          if (itr == known.end())
+            return;
+          auto s = seen.emplace (sid, id);
+          if (s.second)
+            itr->second = &trx;
+          else if (s.first->second != id)
+            itr->second = nullptr;
+        };
+        cc.pending().visit_in_arrival_order ([&offer](const transaction_pool::entry &e) {
+            offer (e.id, e.trx);
+            return true;
           });
-      } else {
-        if (!bs->is_known) {
-          block_state value = *bs;
-          value.is_known= true;
-          c->block_state.insert (std::move(value));
-          send_all (msg, [c](connection_ptr cptr) -> bool {
-              return cptr != c;
-            });
+        // transactions relayed recently may have left the pending pool for a block on another fork
+        auto &relayed = local_txns.get<by_short_id>();
+        for (const auto &k : known) {
+          auto range = relayed.equal_range (k.first);
+          for (auto itr = range.first; itr != range.second; ++itr)
+            if (itr->trx)
+              offer (itr->id, *itr->trx);
         }
       }
-#warning ("TODO: reconstruct actual block from cached transactions")
-      signed_block sb;
-      chain_controller &cc = chain_plug->chain();
-      if (!cc.is_known_block(msg.block) ) {
-        try {
-          chain_plug->accept_block(sb, false);
-        } catch (const unlinkable_block_exception &ex) {
-          elog ("   caught unlinkable block exception #${n}",("n",sb.block_num()));
-           close (c);
-        } catch (const assert_exception &ex) {
-          // received a block due to out of sequence
-          elog ("  caught assertion #${n}",("n",sb.block_num()));
+
+      partial_block pb = partial_block::rebuild (msg, known);
+      if (pb.missing.empty()) {
+        accept_rebuilt_block (c, pb);
+      }
+      else if (c->partial_blocks.size() >= def_max_partial_blocks) {
+        c->send (block_request_message{id});
+      }
+      else {
+        c->send (block_transactions_request_message{id, pb.missing});
+        pb.requested = time_point::now();
+        c->partial_blocks.emplace (id, std::move(pb));
+      }
+    }
+
+    /// @return true if the header is signed by the key of the producer it names
+    bool is_producer_signed (const signed_block_header &header) {
+      try {
+        return header.validate_signee (chain_plug->chain().get_producer (header.producer).signing_key);
+      } catch (const fc::exception &ex) {
+        return false;
+      }
+    }
+
+    void handle_message (connection_ptr c, const block_transactions_request_message &msg) {
+      auto sb = chain_plug->chain().fetch_block_by_id (msg.block);
+      if (!sb) {
+        elog ("peer requested transactions of unknown block ${b}", ("b", msg.block));
+        return;
+      }
+      auto user_input = flatten_user_input (*sb);
+      block_transactions_message reply = {msg.block};
+      for (auto i : msg.indexes) {
+        if (i >= user_input.size()) {
+          elog ("peer requested transaction ${i} of a block with ${n}", ("i", i)("n", user_input.size()));
           close (c);
+          return;
         }
+        reply.trxs.emplace_back (*user_input[i]);
+      }
+      c->send (reply);
+    }
+
+    void handle_message (connection_ptr c, const block_transactions_message &msg) {
+      auto itr = c->partial_blocks.find (msg.block);
+      if (itr == c->partial_blocks.end()) {
+        return;
+      }
+      partial_block pb = std::move(itr->second);
+      c->partial_blocks.erase (itr);
+
+      if (!pb.fill (msg.trxs)) {
+        c->send (block_request_message{msg.block});
+        return;
+      }
+      accept_rebuilt_block (c, pb);
+    }
+
+    void handle_message (connection_ptr c, const block_request_message &msg) {
+      auto sb = chain_plug->chain().fetch_block_by_id (msg.block);
+      if (sb) {
+        c->send (*sb);
+      }
+      else {
+        elog ("peer requested unknown block ${b}", ("b", msg.block));
+      }
+    }
+
+    void accept_rebuilt_block (connection_ptr c, const partial_block &pb) {
+      const signed_block &sb = pb.block;
+      if (!pb.matches_header()) {
+        // a short id matched a different transaction than the one in the block
+        c->send (block_request_message{sb.id()});
+        return;
+      }
+      for (auto ui : flatten_user_input (sb)) {
+        c->known_trxs.insert (ui->id());
+      }
+      try {
+        chain_plug->accept_block(sb, false);
+        relay_block (c, sb);
+      } catch (const unlinkable_block_exception &ex) {
+        elog ("unable to accept block #${n}",("n",sb.block_num()));
+      } catch (const assert_exception &ex) {
+        elog ("unable to accept block on assert exception #${n}",("n",sb.block_num()));
       }
     }
 
@@ -761,20 +978,8 @@ namespace eos {
         return;
       }
 
-      auto tx = c->trx_state.find(txnid);
-      if (tx == c->trx_state.end()) {
-        c->trx_state.insert((transaction_state){txnid,true,true,msg.refBlockNum,
-              fc::time_point(),fc::time_point()});
-      } else {
-        struct trx_mod {
-          UInt16 block;
-          trx_mod( UInt16 bn) : block(bn) {}
-          void operator () (transaction_state &t) {
-            t.is_known_by_peer = true;
-            t.block_num = block;
-          }
-        };
-        c->trx_state.modify(tx,trx_mod(msg.refBlockNum));
+      if (!c->known_trxs.contains(txnid)) {
+        c->known_trxs.insert(txnid);
       }
 
       try {
@@ -789,63 +994,46 @@ namespace eos {
 
     void handle_message (connection_ptr c, const signed_block &msg) {
       chain_controller &cc = chain_plug->chain();
+      uint32_t num = msg.block_num();
+      uint32_t head = cc.head_block_num();
+      bool syncing = sync_head > head;
+      bool request_done = syncing && sync_block_received(c, num);
       try {
         if (cc.is_known_block(msg.id())) {
+          if (request_done) {
+            requeue_dropped_blocks();
+            get_sync_req(c);
+          }
           return;
         }
       } catch (...) {
       }
-      uint32_t num = msg.block_num();
-      bool syncing = sync_head > cc.head_block_num();
-      bool get_more = false;
       if (syncing) {
-        for( auto &ss : c->sync_received) {
-          if (num > ss.end_block) {
-            continue;
-          }
-          ss.last = num;
-          get_more = num == ss.end_block;
-          if (num == cc.head_block_num()+1) {
-            try {
-              chain_plug->accept_block(msg, true);
-              auto s0 = c->sync_received.begin();
-              if (s0->start_block == s0->end_block) {
-                c->sync_received.erase(s0);
-                apply_cached_blocks(c);
-              }
-              else {
-                s0->start_block++;
-              }
-            } catch (const unlinkable_block_exception &ex) {
-              elog ("unable to accept block #${n} syncing",("n",num));
-              //close (c);
-            } catch (const assert_exception &ex) {
-              elog ("unable to accept block on assert exception #${n}",("n",num));
-              //close (c);
-            }
-
-          } else {
-            ss.block_cache.emplace_back(std::move(c->blk_buffer));
-          }
-          break;
+        try {
+          chain_plug->accept_block(msg, true);
+        } catch (const unlinkable_block_exception &ex) {
+          // held by the fork database until the blocks before it arrive
+        } catch (const assert_exception &ex) {
+          elog ("unable to accept block on assert exception #${n}",("n",num));
+          //close (c);
         }
-        if ( chain_plug->chain().head_block_num() == sync_head) {
+        if ( cc.head_block_num() >= sync_head) {
           handshake_message hello;
           handshake_initializer::populate(hello);
           send_all (hello, [c](connection_ptr conn) -> bool {
               return true;
             });
-        } else if (get_more) {
-          get_sync_req( c );
+        } else if (request_done || cc.head_block_num() != head) {
+          // a finished request frees this peer, and a moving head opens the window for everyone
+          if (request_done) {
+            requeue_dropped_blocks();
+          }
+          request_sync_blocks();
         }
         return;
       }
-      else {
-          send_all (msg, [c](connection_ptr conn) -> bool {
-            return (c != conn);
-          });
 
-      }
+      relay_block (c, msg);
       try {
         chain_plug->accept_block(msg, syncing);
       } catch (const unlinkable_block_exception &ex) {
@@ -857,26 +1045,6 @@ namespace eos {
       }
     }
 
-    struct precache : public fc::visitor<void> {
-      connection_ptr c;
-      precache (connection_ptr conn) : c(conn) {}
-
-      void operator()(const signed_block &msg) const
-      {
-        c->blk_buffer.resize(c->message_size);
-        memcpy(c->blk_buffer.data(),c->pending_message_buffer.data(), c->message_size);
-      }
-
-      template <typename T>
-      void operator()(const T &msg) const
-      {
-        //no-op
-      }
-
-    };
-
-
-
     struct msgHandler : public fc::visitor<void> {
       net_plugin_impl &impl;
       connection_ptr c;
@@ -895,10 +1063,7 @@ namespace eos {
           [this,c]( boost::system::error_code ec, std::size_t bytes_transferred ) {
             if( !ec ) {
               try {
-                c->message_size = bytes_transferred;
                 auto msg = fc::raw::unpack<net_message>( c->pending_message_buffer );
-                precache pc( c );
-                msg.visit (pc);
                 start_read_message( c );
 
                 msgHandler m(*this, c);
@@ -940,11 +1105,49 @@ namespace eos {
         });
     }
 
+    void start_partial_block_timer () {
+      partial_block_check->expires_from_now (resp_expected_period);
+      partial_block_check->async_wait ([&](boost::system::error_code ec) {
+          if (!ec) {
+            expire_partial_blocks ();
+          }
+          else {
+            elog ("Error from partial block check monitor: ${m}", ("m", ec.message()));
+            start_partial_block_timer ();
+          }
+        });
+    }
+
     void start_monitors () {
       connector_check.reset(new boost::asio::steady_timer (app().get_io_service()));
       transaction_check.reset(new boost::asio::steady_timer (app().get_io_service()));
+      partial_block_check.reset(new boost::asio::steady_timer (app().get_io_service()));
       start_conn_timer();
       start_txn_timer();
+      start_partial_block_timer();
+    }
+
+    /// Peers that did not send the transactions missing from a summary in time are asked for the whole block
+    void expire_partial_blocks () {
+      start_partial_block_timer ();
+      auto expired = time_point::now() - resp_expected_wait();
+      for (auto &c : connections) {
+        for (auto itr = c->partial_blocks.begin(); itr != c->partial_blocks.end(); ) {
+          if (itr->second.requested <= expired) {
+            if (c->ready()) {
+              c->send (block_request_message{itr->first});
+            }
+            itr = c->partial_blocks.erase (itr);
+          }
+          else {
+            ++itr;
+          }
+        }
+      }
+    }
+
+    fc::microseconds resp_expected_wait () const {
+      return fc::microseconds (std::chrono::duration_cast<std::chrono::microseconds> (resp_expected_period).count());
     }
 
     void expire_txns () {
@@ -987,6 +1190,12 @@ namespace eos {
         --num_clients;
       }
       c->close();
+
+      // whatever this peer still owed us goes to the others
+      requeue_sync_ranges (c);
+      if (!sync_unassigned.empty()) {
+        request_sync_blocks();
+      }
     }
 
     void send_all_txn (const SignedTransaction& txn) {
@@ -998,28 +1207,25 @@ namespace eos {
       uint16_t bn = static_cast<uint16_t>(txn.refBlockNum);
       node_transaction_state nts = {txnid,time_point::now(),
                                     txn.expiration,
-                                    bn, true};
+                                    bn, true,
+                                    std::make_shared<const SignedTransaction>(txn)};
       local_txns.insert(nts);
 
       if (fc::raw::pack_size(txn) <= just_send_it_max) {
-        send_all (txn, [txn, txnid](connection_ptr c) -> bool {
-            const auto& bs = c->trx_state.find(txnid);
-            bool unknown = bs == c->trx_state.end();
+        send_all (txn, [txnid](connection_ptr c) -> bool {
+            bool unknown = !c->known_trxs.contains(txnid);
             if (unknown)
-              c->trx_state.insert(transaction_state({txnid,true,true,(uint32_t)-1,
-                      fc::time_point(),fc::time_point() }));
+              c->known_trxs.insert(txnid);
             return unknown;
           });
       }
       else {
         pending_notify.push_back (txnid);
         notice_message nm = {pending_notify};
-        send_all (nm, [txn, txnid](connection_ptr c) -> bool {
-            const auto& bs = c->trx_state.find(txnid);
-            bool unknown = bs == c->trx_state.end();
+        send_all (nm, [txnid](connection_ptr c) -> bool {
+            bool unknown = !c->known_trxs.contains(txnid);
             if (unknown)
-              c->trx_state.insert(transaction_state({txnid,false,true,(uint32_t)-1,
-                      fc::time_point(),fc::time_point() }));
+              c->known_trxs.insert(txnid);
             return unknown;
           });
         pending_notify.clear();
@@ -1034,48 +1240,27 @@ namespace eos {
     }
 
     void broadcast_block_impl (const chain::signed_block &sb) {
-      if (send_whole_blocks) {
-        send_all (sb,[](connection_ptr c) -> bool { return true; });
-      }
-      chain_controller &cc = chain_plug->chain();
-
-      vector<transaction_id_type> trxs;
-      if (!sb.cycles.empty()) {
-        for (const auto& cyc : sb.cycles) {
-          for (const auto& thr : cyc) {
-            for (auto ui : thr.user_input) {
-              auto &txn = cc.get_recent_transaction (ui.id());
-              auto &id_iter = local_txns.get<by_id>();
-              auto lt = id_iter.find(ui.id());
-              if (lt != local_txns.end()) {
-                id_iter.modify (lt, update_block_num(txn.refBlockNum));
-              } else {
-                transaction_id_type txnid = txn.id();
-                if( local_txns.get<by_id>().find( txnid ) == local_txns.end () ) { //not found
-                  uint16_t bn = static_cast<uint16_t>(txn.refBlockNum);
-                  node_transaction_state nts = {txnid,time_point::now(),
-                                                txn.expiration, bn, true};
-                  local_txns.insert(nts);
-                }
-              }
-              trxs.push_back (ui.id());
+      for (const auto& cyc : sb.cycles) {
+        for (const auto& thr : cyc) {
+          for (const auto& ui : thr.user_input) {
+            // the block carries the transaction itself, so it need not be looked up
+            transaction_id_type txnid = ui.id();
+            auto &id_iter = local_txns.get<by_id>();
+            auto lt = id_iter.find(txnid);
+            if (lt != local_txns.end()) {
+              id_iter.modify (lt, update_block_num(ui.refBlockNum));
+            } else {
+              uint16_t bn = static_cast<uint16_t>(ui.refBlockNum);
+              node_transaction_state nts = {txnid,time_point::now(),
+                                            ui.expiration, bn, true,
+                                            std::make_shared<const SignedTransaction>(ui)};
+              local_txns.insert(nts);
             }
           }
         }
       }
 
-      if (!send_whole_blocks) {
-        block_summary_message bsm = {sb.id(), trxs};
-        send_all (bsm,[sb](connection_ptr c) -> bool {
-            return true;
-            const auto& bs = c->block_state.find(sb.id());
-            if (bs == c->block_state.end()) {
-              c->block_state.insert ((block_state){sb.id(),true,true,fc::time_point()});
-              return true;
-            }
-            return false;
-          });
-      }
+      relay_block (connection_ptr(), sb);
     }
 
   }; // class net_plugin_impl
@@ -1133,6 +1318,10 @@ namespace eos {
       ("remote-endpoint", bpo::value< vector<string> >()->composing(), "The IP address and port of a remote peer to sync with.")
       ("public-endpoint", bpo::value<string>(), "Overrides the advertised listen endpointlisten ip address.")
       ("agent-name", bpo::value<string>()->default_value("EOS Test Agent"), "The name supplied to identify this node amongst the peers.")
+      ("sync-fetch-span", bpo::value<uint32_t>()->default_value(def_sync_rec_span), "Number of blocks requested from a peer at a time while catching up.")
+      ("send-whole-blocks", bpo::value<bool>()->default_value(def_send_whole_blocks), "Relay whole blocks; if false, relay summaries from which peers rebuild blocks out of the transactions they already have.")
+      ("known-trx-per-peer", bpo::value<uint32_t>()->default_value(def_known_trx_per_peer), "Number of recent transactions remembered as known by each peer; bounds the memory used per peer.")
+      ("known-trx-false-positive-rate", bpo::value<double>()->default_value(def_known_trx_false_positive_rate), "Chance that a transaction a peer does not know is taken to be known by it, and not relayed to it.")
       ;
   }
 
@@ -1189,6 +1378,14 @@ namespace eos {
     if (options.count("agent-name")) {
       my->user_agent_name = options.at ("agent-name").as< string > ();
     }
+    if (options.count("sync-fetch-span")) {
+      my->sync_req_span = std::max (options.at ("sync-fetch-span").as< uint32_t > (), 1u);
+    }
+    my->send_whole_blocks = options.at ("send-whole-blocks").as< bool > ();
+    my->known_trx_capacity = options.at ("known-trx-per-peer").as< uint32_t > ();
+    my->known_trx_false_positive_rate = options.at ("known-trx-false-positive-rate").as< double > ();
+    FC_ASSERT (my->known_trx_false_positive_rate > 0 && my->known_trx_false_positive_rate < 1,
+               "known-trx-false-positive-rate must be between 0 and 1");
     my->chain_plug = app().find_plugin<chain_plugin>();
     my->chain_plug->get_chain_id(my->chain_id);
     fc::rand_pseudo_bytes(my->node_id.data(), my->node_id.data_size());
@@ -1207,7 +1404,7 @@ namespace eos {
     my->start_monitors();
 
     for( auto seed_node : my->supplied_peers ) {
-      connection_ptr c = std::make_shared<connection>(seed_node);
+      connection_ptr c = std::make_shared<connection>(seed_node, my->known_trx_capacity, my->known_trx_false_positive_rate);
       my->connections.insert (c);
       my->connect( c );
     }
@@ -106,6 +106,12 @@ void producer_plugin::set_program_options(
          ("private-key", boost::program_options::value<vector<string>>()->composing()->multitoken()->default_value({fc::json::to_string(private_key_default)},
                                                                                                 fc::json::to_string(private_key_default)),
           "Tuple of [PublicKey, WIF private key] (may specify multiple times)")
+         ("block-scheduler", boost::program_options::value<string>()->default_value("single-thread"),
+          "How transactions are arranged into cycles and threads in produced blocks: single-thread or read-write-sets")
+         ("scheduler-threads-per-cycle", boost::program_options::value<uint32_t>()->default_value(config::DefaultMaxThreadsPerCycle),
+          "Most threads in one cycle of a block produced with the read-write-sets scheduler")
+         ("scheduler-max-cycles", boost::program_options::value<uint32_t>()->default_value(config::DefaultMaxCyclesPerBlock),
+          "Most cycles in a block produced with the read-write-sets scheduler")
          ;
    command_line_options.add(producer_options);
    config_file_options.add(producer_options);
@@ -140,6 +146,18 @@ void producer_plugin::plugin_initialize(const boost::program_options::variables_
          my->_private_keys[key_id_to_wif_pair.first] = *private_key;
       }
    }
+
+   auto scheduler = options.at("block-scheduler").as<string>();
+   if (scheduler == "read-write-sets") {
+      chain::schedule_shape shape;
+      shape.max_threads_per_cycle = options.at("scheduler-threads-per-cycle").as<uint32_t>();
+      shape.max_cycles = options.at("scheduler-max-cycles").as<uint32_t>();
+      FC_ASSERT(shape.max_threads_per_cycle > 0 && shape.max_cycles > 0,
+                "The block scheduler needs at least one thread and one cycle", ("shape", shape));
+      my->_production_scheduler = chain::block_schedule::by_read_write_sets_with(shape);
+   } else {
+      FC_ASSERT(scheduler == "single-thread", "Unknown block scheduler ${s}", ("s", scheduler));
+   }
 } FC_LOG_AND_RETHROW() }
 
 void producer_plugin::plugin_startup()
@@ -103,8 +103,9 @@ flat_set<public_key_type> testing_fixture::available_keys() const {
 }
 
 testing_blockchain::testing_blockchain(chainbase::database& db, fork_database& fork_db, block_log& blocklog,
-                                   chain_initializer_interface& initializer, testing_fixture& fixture)
-   : chain_controller(db, fork_db, blocklog, initializer, native_contract::make_administrator()),
+                                   chain_initializer_interface& initializer, testing_fixture& fixture,
+                                   replay_trust trust, const optional<fc::path>& snapshot)
+   : chain_controller(db, fork_db, blocklog, initializer, native_contract::make_administrator(), trust, snapshot),
      db(db),
      fixture(fixture) {}
 
@@ -143,7 +143,9 @@ protected:
 class testing_blockchain : public chain_controller {
 public:
    testing_blockchain(chainbase::database& db, fork_database& fork_db, block_log& blocklog,
-                     chain_initializer_interface& initializer, testing_fixture& fixture);
+                     chain_initializer_interface& initializer, testing_fixture& fixture,
+                     replay_trust trust = replay_trust::signatures,
+                     const optional<fc::path>& snapshot = optional<fc::path>());
 
    /**
     * @brief Publish the provided contract to the blockchain, owned by owner
@@ -34,6 +34,7 @@
 #include <eos/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
+#include <fc/scoped_exit.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -48,6 +49,12 @@
 #include <exchange/exchange.wast.hpp>
 #include <infinite/infinite.wast.hpp>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace eos;
 using namespace chain;
 
@@ -488,6 +495,53 @@ BOOST_FIXTURE_TEST_CASE(create_exchange, testing_fixture) {
    } FC_LOG_AND_RETHROW() 
 }
 
+// Test that a node applying the threads of a cycle at the same time ends up in the producer's state
+BOOST_FIXTURE_TEST_CASE(parallel_cycle_threads, testing_fixture)
+{ try {
+   Make_Blockchains((chain)(chain2))
+   Make_Network(net, (chain)(chain2))
+   chain.produce_blocks(2);
+   Make_Account(chain, currency);
+   Make_Account(chain, alice);
+   Make_Account(chain, bob);
+   Make_Account(chain, carol);
+   Make_Account(chain, dave);
+   chain.produce_blocks(1);
+
+   SetCode(chain, "currency", currency_wast);
+   chain.produce_blocks(1);
+   TransferCurrency(chain, "currency", "alice", 1000);
+   TransferCurrency(chain, "currency", "carol", 1000);
+   chain.produce_blocks(1);
+
+   // Transfers within {alice, bob} and within {carol, dave} do not conflict, so they are threads of one cycle
+   for (uint64_t i = 1; i <= 10; ++i) {
+      TransferCurrency(chain, "alice", "bob", i);
+      TransferCurrency(chain, "carol", "dave", 2 * i);
+   }
+   chain.produce_blocks(1);
+
+   auto block = chain.fetch_block_by_number(chain.head_block_num());
+   BOOST_REQUIRE(block);
+   BOOST_REQUIRE_EQUAL(block->cycles.size(), 1);
+   BOOST_CHECK_EQUAL(block->cycles[0].size(), 2);
+   BOOST_CHECK_EQUAL(chain2.head_block_id().str(), chain.head_block_id().str());
+
+   auto balance = [](const testing_blockchain& chain, AccountName owner) -> uint64_t {
+      const auto* row = chain.get_database().find<key_value_object, by_scope_primary>(
+         boost::make_tuple(owner, AccountName("currency"), AccountName("account"), AccountName("account")));
+      BOOST_REQUIRE(row != nullptr);
+      BOOST_REQUIRE_EQUAL(row->value.size(), sizeof(uint64_t));
+      return *reinterpret_cast<const uint64_t*>(row->value.data());
+   };
+   for (auto node : {&chain, &chain2}) {
+      BOOST_CHECK_EQUAL(balance(*node, "alice"), 1000 - 55);
+      BOOST_CHECK_EQUAL(balance(*node, "bob"), 55);
+      BOOST_CHECK_EQUAL(balance(*node, "carol"), 1000 - 110);
+      BOOST_CHECK_EQUAL(balance(*node, "dave"), 110);
+   }
+} FC_LOG_AND_RETHROW() }
+
 //Test account script float rejection
 BOOST_FIXTURE_TEST_CASE(create_script_w_float, testing_fixture)
 { try {
@@ -1183,4 +1237,172 @@ BOOST_FIXTURE_TEST_CASE(create_script_w_loop, testing_fixture)
       }
 } FC_LOG_AND_RETHROW() }
 
+/// Test that a contract cannot run past the time limit by making many cheap checks before expensive ones
+BOOST_FIXTURE_TEST_CASE(checktime_cheap_then_expensive, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      Make_Account(chain, slowdown);
+      chain.produce_blocks(1);
+
+      SetCode(chain, "slowdown", R"(
+(module
+  (import "env" "sha256" (func $sha256 (param i32 i32 i32)))
+  (memory 2)
+  (export "memory" (memory 0))
+  (export "init" (func $init))
+  (export "apply" (func $apply))
+  (func $init)
+  (func $apply (param $0 i64) (param $1 i64)
+    (local $i i32)
+    (block $cheap_done
+      (loop $cheap
+        (br_if $cheap_done (i32.ge_u (get_local $i) (i32.const 200000)))
+        (set_local $i (i32.add (get_local $i) (i32.const 1)))
+        (br $cheap)
+      )
+    )
+    (loop $expensive
+      (call $sha256 (i32.const 0) (i32.const 65536) (i32.const 65536))
+      (br $expensive)
+    )
+  )
+)
+)");
+
+      eos::chain::SignedTransaction trx;
+      trx.scope = sort_names({"slowdown","inita"});
+      transaction_emplace_message(trx, "slowdown",
+                         vector<types::AccountPermission>{ {"slowdown","active"} },
+                         "transfer", types::transfer{"slowdown", "inita", 1, ""});
+      trx.expiration = chain.head_block_time() + 100;
+      transaction_set_reference_block(trx, chain.head_block_id());
+
+      auto start = fc::time_point::now();
+      BOOST_CHECK_THROW(chain.push_transaction(trx), eos::chain::checktime_exceeded);
+      auto elapsed = fc::time_point::now() - start;
+      BOOST_TEST_MESSAGE("contract stopped after " << elapsed.count() << " us");
+      BOOST_CHECK(elapsed < fc::milliseconds(100));
+} FC_LOG_AND_RETHROW() }
+
+/// Measure the cost of dispatching a message to a contract that does nothing
+BOOST_FIXTURE_TEST_CASE(noop_contract_dispatch, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain.produce_blocks(10);
+      Make_Account(chain, noop);
+      chain.produce_blocks(1);
+
+      SetCode(chain, "noop", R"(
+(module
+  (memory 1)
+  (export "memory" (memory 0))
+  (export "init" (func $init))
+  (export "apply" (func $apply))
+  (func $init)
+  (func $apply (param $0 i64) (param $1 i64))
+)
+)");
+
+      Transaction trx;
+      trx.scope = {"noop"};
+      Message msg;
+      msg.code = "noop";
+      msg.type = "transfer";
+      apply_context context(chain, chain.get_mutable_database(), trx, msg, "noop");
+
+      // The first call loads and instantiates the contract; the ones timed below find it loaded
+      auto& wasm = wasm_interface::get();
+      wasm.apply(context);
+      BOOST_REQUIRE(wasm.current_module != nullptr);
+
+      const uint32_t count = 100000;
+      auto start = fc::time_point::now();
+      for (uint32_t i = 0; i < count; ++i)
+         wasm.apply(context);
+      auto elapsed = fc::time_point::now() - start;
+      BOOST_TEST_MESSAGE("noop contract: " << double(elapsed.count()) / count << " us per apply");
+
+      // The entry point alone, called through the binding resolved at load and through a lookup on every call
+      auto function = Runtime::asFunctionNullable(Runtime::getInstanceExport(wasm.current_module, "apply"));
+      BOOST_REQUIRE(function != nullptr);
+      auto bound = Runtime::bindFunction(function);
+      U64 args[3] = {uint64_t(msg.code), uint64_t(msg.type)};
+      start = fc::time_point::now();
+      for (uint32_t i = 0; i < count; ++i)
+         Runtime::invokeBoundFunction(bound, args);
+      auto bound_elapsed = fc::time_point::now() - start;
+
+      std::vector<Runtime::Value> values = {U64(msg.code), U64(msg.type)};
+      Runtime::invokeFunction(function, values);
+      start = fc::time_point::now();
+      for (uint32_t i = 0; i < count; ++i)
+         Runtime::invokeFunction(function, values);
+      auto unbound_elapsed = fc::time_point::now() - start;
+
+      BOOST_TEST_MESSAGE("noop contract: " << double(bound_elapsed.count()) / count << " us per invokeBoundFunction, "
+                         << double(unbound_elapsed.count()) / count << " us per invokeFunction");
+} FC_LOG_AND_RETHROW() }
+
+#if defined(__linux__)
+/**
+ * Measure the ways of restoring the first 64KiB of contract memory, as vm_call does before every call into a
+ * contract, followed by the contract writing to some of its pages: copying the initial image back, remapping it
+ * privately from a memfd, and dropping the written pages with madvise. This is the benchmark behind the decision
+ * to keep copying.
+ */
+BOOST_AUTO_TEST_CASE(contract_memory_reset_cost)
+{ try {
+   const size_t page_size = sysconf(_SC_PAGESIZE);
+   const size_t region = 1 << 16;
+   const size_t init_size = 1000;
+   const uint32_t resets = 100000;
+   vector<char> init_memory(init_size);
+   for (size_t i = 0; i < init_size; ++i)
+      init_memory[i] = char(i % 251 + 1);
+
+   // The initial image, init_memory followed by zeros, in a file that can be mapped privately
+   int fd = syscall(SYS_memfd_create, "contract_memory", 0);
+   BOOST_REQUIRE(fd >= 0);
+   auto close_fd = fc::make_scoped_exit([fd]() { close(fd); });
+   BOOST_REQUIRE_EQUAL(ftruncate(fd, region), 0);
+   BOOST_REQUIRE_EQUAL(pwrite(fd, init_memory.data(), init_size, 0), ssize_t(init_size));
+
+   char* memory = (char*)mmap(nullptr, region, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+   BOOST_REQUIRE(memory != MAP_FAILED);
+   auto unmap = fc::make_scoped_exit([memory, region]() { munmap(memory, region); });
+
+   vector<pair<string, std::function<void()>>> strategies = {
+      {"memcpy", [&]() {
+         memset(memory + init_size, 0, region - init_size);
+         memcpy(memory, init_memory.data(), init_size);
+      }},
+      {"mmap MAP_FIXED", [&]() {
+         FC_ASSERT(mmap(memory, region, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == memory);
+      }},
+      {"madvise MADV_DONTNEED", [&]() {
+         FC_ASSERT(madvise(memory, region, MADV_DONTNEED) == 0);
+      }}
+   };
+
+   for (uint32_t dirty_pages : {1, 2, 4, 16}) {
+      for (const auto& strategy : strategies) {
+         auto start = fc::time_point::now();
+         for (uint32_t r = 0; r < resets; ++r) {
+            strategy.second();
+            for (uint32_t p = 0; p < dirty_pages; ++p)
+               memory[p * page_size] ^= 1;
+         }
+         auto elapsed = fc::time_point::now() - start;
+         BOOST_TEST_MESSAGE(dirty_pages << " dirty pages, " << strategy.first << ": "
+                            << double(elapsed.count()) / resets << "us per reset");
+
+         strategy.second();
+         BOOST_CHECK(memcmp(memory, init_memory.data(), init_size) == 0);
+         BOOST_CHECK(std::all_of(memory + init_size, memory + region, [](char c) { return c == 0; }));
+      }
+   }
+} FC_LOG_AND_RETHROW() }
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
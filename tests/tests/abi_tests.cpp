@@ -379,4 +379,106 @@ BOOST_FIXTURE_TEST_CASE(general, testing_fixture)
 } FC_LOG_AND_RETHROW() }
 
 
+// Convert the same rows with compiled plans and with the general path, which is what a serializer whose maps
+// are filled in without setAbi uses, and compare the results and timings
+BOOST_FIXTURE_TEST_CASE(compiled_plans, testing_fixture)
+{ try {
+
+   const char* order_abi = R"=====(
+   {
+       "types": [{"newTypeName": "Quantity", "type": "UInt64"}],
+       "structs": [{
+           "name": "OrderID",
+           "base": "",
+           "fields": { "name": "AccountName", "id": "UInt64" }
+         },{
+           "name": "Order",
+           "base": "OrderID",
+           "fields": {
+             "price": "Quantity",
+             "quantity": "Quantity",
+             "expiration": "Time",
+             "fills": "UInt32[]",
+             "memo": "String",
+             "previous": "OrderID"
+           }
+         }
+       ],
+       "actions": [],
+       "tables": []
+   }
+   )=====";
+
+   const char* order = R"=====(
+   {
+     "name": "inita", "id": 7, "price": 1000, "quantity": 25, "expiration": "2021-12-20T15:30",
+     "fills": [1, 2, 3], "memo": "ola ke ase", "previous": { "name": "initb", "id": 6 }
+   }
+   )=====";
+
+   AbiSerializer compiled(fc::json::from_string(order_abi).as<Abi>());
+   AbiSerializer general;
+   general.typedefs = compiled.typedefs;
+   general.structs  = compiled.structs;
+
+   auto var = fc::json::from_string(order);
+   auto bin = compiled.variantToBinary("Order", var);
+   BOOST_CHECK(bin == general.variantToBinary("Order", var));
+   BOOST_CHECK_EQUAL(fc::json::to_string(compiled.binaryToVariant("Order", bin)),
+                     fc::json::to_string(general.binaryToVariant("Order", bin)));
+   BOOST_CHECK_EQUAL(compiled.binaryToVariant("Order", bin)["previous"]["id"].as_uint64(), 6);
+
+   // A copy has its own plans, which must still work once the original is gone
+   auto copy = std::make_unique<AbiSerializer>(compiled);
+   AbiSerializer copied(*copy);
+   copy.reset();
+   BOOST_CHECK(copied.variantToBinary("Order", var) == bin);
+
+   const int rows = 10000;
+   auto time_unpack = [&](const AbiSerializer& abis) {
+      auto start = fc::time_point::now();
+      for( int i = 0; i < rows; ++i )
+         abis.binaryToVariant("Order", bin);
+      return (fc::time_point::now() - start).count() / 1000000.0;
+   };
+   auto time_pack = [&](const AbiSerializer& abis) {
+      auto start = fc::time_point::now();
+      for( int i = 0; i < rows; ++i )
+         abis.variantToBinary("Order", var);
+      return (fc::time_point::now() - start).count() / 1000000.0;
+   };
+
+   auto compiled_unpack = time_unpack(compiled);
+   auto general_unpack  = time_unpack(general);
+   auto compiled_pack   = time_pack(compiled);
+   auto general_pack    = time_pack(general);
+   idump((rows)(compiled_unpack)(general_unpack)(compiled_pack)(general_pack));
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE(abi_cache, testing_fixture)
+{ try {
+   Make_Blockchain(chain)
+
+   auto eos_abi = chain.get_abi(config::EosContractName);
+   BOOST_REQUIRE(eos_abi);
+   BOOST_CHECK(chain.get_abi(config::EosContractName) == eos_abi);
+   BOOST_CHECK(!chain.get_abi("inita"));
+
+   // Setting an ABI on the account must replace the cached one
+   auto abi = fc::json::from_string(my_abi).as<Abi>();
+   auto& db = chain.get_mutable_database();
+   db.modify(db.get<account_object,by_name>("inita"), [&](auto& a) { a.set_abi(abi); });
+   auto inita_abi = chain.get_abi("inita");
+   BOOST_REQUIRE(inita_abi);
+   BOOST_CHECK(inita_abi->serializer.isStruct("A"));
+   BOOST_CHECK(chain.get_abi("inita") == inita_abi);
+
+   abi.structs.clear();
+   db.modify(db.get<account_object,by_name>("inita"), [&](auto& a) { a.set_abi(abi); });
+   BOOST_CHECK(chain.get_abi("inita") != inita_abi);
+   BOOST_CHECK(!chain.get_abi("inita")->serializer.isStruct("A"));
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <eos/account_history_plugin/account_history_plugin.hpp>
+#include <eos/chain/chain_controller.hpp>
+#include <eos/chain/exceptions.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../common/database_fixture.hpp"
+
+namespace eos {
+using namespace chain;
+using read_only = account_history_apis::read_only;
+
+/// Pushes a transfer of amount from sender to recipient and returns its id; the scope is the two accounts
+static transaction_id_type transfer(testing_blockchain& chain, AccountName sender, AccountName recipient, uint64_t amount) {
+   SignedTransaction trx;
+   trx.scope = sort_names({sender, recipient});
+   transaction_emplace_message(trx, config::EosContractName,
+                               vector<types::AccountPermission>{ {sender, "active"} },
+                               "transfer", types::transfer{sender, recipient, amount, ""});
+   trx.expiration = chain.head_block_time() + 100;
+   transaction_set_reference_block(trx, chain.head_block_id());
+   chain.push_transaction(trx);
+   return trx.id();
+}
+
+/// @return the transaction as the block it is in holds it, in the form the history API returns transactions
+static string transaction_in_block(testing_blockchain& chain, uint32_t block_num, const transaction_id_type& id) {
+   auto block = chain.fetch_block_by_number(block_num);
+   BOOST_REQUIRE(block);
+   for (const auto& cycle : block->cycles)
+      for (const auto& thread : cycle)
+         for (const auto& trx : thread.user_input)
+            if (trx.id() == id)
+               return fc::json::to_string(chain.transaction_to_variant(trx));
+   BOOST_FAIL("transaction is not in block " << block_num);
+   return string();
+}
+
+BOOST_AUTO_TEST_SUITE(account_history_tests)
+
+// Check that get_transaction reads back the transactions of irreversible blocks out of the block log, and those of
+// reversible blocks out of the fork database
+BOOST_FIXTURE_TEST_CASE(get_transaction_round_trip, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      account_history_plugin history;
+      history.start_indexing(chain);
+      auto api = history.get_read_only_api();
+
+      // several transactions of one block, so that the later ones lie past the start of the packed block
+      vector<transaction_id_type> old_ids;
+      for (uint64_t amount = 1; amount <= 3; ++amount)
+         old_ids.push_back(transfer(chain, "inita", "initb", amount));
+      chain.produce_blocks();
+      const auto old_block_num = chain.head_block_num();
+
+      chain.produce_blocks(50);
+      auto recent_id = transfer(chain, "inita", "initb", 4);
+      chain.produce_blocks();
+      const auto recent_block_num = chain.head_block_num();
+
+      BOOST_REQUIRE(old_block_num <= chain.last_irreversible_block_num());
+      BOOST_REQUIRE(chain.fetch_packed_block_by_number(old_block_num));
+      BOOST_REQUIRE(recent_block_num > chain.last_irreversible_block_num());
+      BOOST_REQUIRE(!chain.fetch_packed_block_by_number(recent_block_num));
+
+      for (const auto& id : old_ids) {
+         auto result = api.get_transaction({id});
+         BOOST_CHECK_EQUAL(result.transaction_id.str(), id.str());
+         BOOST_CHECK_EQUAL(fc::json::to_string(result.transaction), transaction_in_block(chain, old_block_num, id));
+      }
+
+      auto result = api.get_transaction({recent_id});
+      BOOST_CHECK_EQUAL(result.transaction_id.str(), recent_id.str());
+      BOOST_CHECK_EQUAL(fc::json::to_string(result.transaction), transaction_in_block(chain, recent_block_num, recent_id));
+
+      BOOST_CHECK_THROW(api.get_transaction({transaction_id_type()}), unknown_transaction_exception);
+} FC_LOG_AND_RETHROW() }
+
+// Check paging through an account's history from either end, and that its sequence numbers follow a popped block
+BOOST_FIXTURE_TEST_CASE(get_transactions_paging, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      account_history_plugin history;
+      history.start_indexing(chain);
+      auto api = history.get_read_only_api();
+
+      Make_Account(chain, alice);
+      chain.produce_blocks();
+
+      // alice's history, oldest first: two transactions in one block and three in the next
+      vector<transaction_id_type> ids;
+      for (uint64_t amount = 1; amount <= 5; ++amount) {
+         ids.push_back(transfer(chain, "inita", "alice", amount));
+         if (amount == 2)
+            chain.produce_blocks();
+      }
+      chain.produce_blocks();
+
+      auto page = [&api](optional<uint32_t> skip_seq, optional<uint32_t> num_seq, bool oldest_first) {
+         auto results = api.get_transactions({"alice", skip_seq, num_seq, oldest_first});
+         BOOST_CHECK(!results.time_limit_exceeded_error.valid());
+         vector<string> page_ids;
+         for (const auto& trx : results.transactions) {
+            BOOST_CHECK_EQUAL(trx.seq_num, (skip_seq ? *skip_seq : 0) + page_ids.size());
+            page_ids.push_back(trx.transaction_id.str());
+         }
+         return page_ids;
+      };
+      auto history_of = [](const vector<transaction_id_type>& ids, std::initializer_list<size_t> indexes) {
+         vector<string> expected;
+         for (auto i : indexes)
+            expected.push_back(ids[i].str());
+         return expected;
+      };
+      const optional<uint32_t> all;
+
+      // the whole history
+      BOOST_CHECK(page(all, all, false) == history_of(ids, {4, 3, 2, 1, 0}));
+      BOOST_CHECK(page(all, all, true) == history_of(ids, {0, 1, 2, 3, 4}));
+
+      // a page from the middle
+      BOOST_CHECK(page(1, 2, false) == history_of(ids, {3, 2}));
+      BOOST_CHECK(page(1, 2, true) == history_of(ids, {1, 2}));
+
+      // skip_seq at and past the end
+      BOOST_CHECK(page(4, all, false) == history_of(ids, {0}));
+      BOOST_CHECK(page(4, all, true) == history_of(ids, {4}));
+      BOOST_CHECK(page(5, all, false).empty());
+      BOOST_CHECK(page(5, all, true).empty());
+      BOOST_CHECK(page(100, 2, false).empty());
+
+      // num_seq without skip_seq
+      BOOST_CHECK(page(all, 2, false) == history_of(ids, {4, 3}));
+      BOOST_CHECK(page(all, 2, true) == history_of(ids, {0, 1}));
+      BOOST_CHECK(page(all, 10, false) == history_of(ids, {4, 3, 2, 1, 0}));
+      BOOST_CHECK(page(all, 0, false).empty());
+
+      // Popping the last block undoes the history it added, so the next transaction takes the first free sequence
+      // number again
+      chain.pop_block();
+      chain.clear_pending();
+      BOOST_CHECK(page(all, all, false) == history_of(ids, {1, 0}));
+      BOOST_CHECK_THROW(api.get_transaction({ids[4]}), unknown_transaction_exception);
+
+      ids.resize(2);
+      ids.push_back(transfer(chain, "inita", "alice", 6));
+      chain.produce_blocks();
+      BOOST_CHECK(page(all, all, true) == history_of(ids, {0, 1, 2}));
+      BOOST_CHECK(page(2, 1, true) == history_of(ids, {2}));
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace eos
@@ -94,6 +94,11 @@ public:
       const std::initializer_list<AccountName>& scopes;
    };
 
+   struct read_write_transaction {
+      std::vector<AccountName> scope;
+      std::vector<AccountName> readscope;
+   };
+
 protected:
    auto create_transactions( const std::initializer_list<test_transaction>& transactions ) {
       std::vector<SignedTransaction> result;
@@ -106,6 +111,17 @@ protected:
       return result;
    }
 
+   auto create_read_write_transactions( const std::vector<read_write_transaction>& transactions ) {
+      std::vector<SignedTransaction> result;
+      for (const auto& t: transactions) {
+         SignedTransaction st;
+         st.scope = t.scope;
+         st.readscope = t.readscope;
+         result.emplace_back(st);
+      }
+      return result;
+   }
+
    auto create_pending( const std::vector<SignedTransaction>& transactions ) {
       std::vector<pending_transaction> result;
       for (const auto& t: transactions) {
@@ -128,6 +144,16 @@ public:
       } FC_LOG_AND_RETHROW()
    }
 
+   template<typename SCHED_FN, typename ...VALIDATORS>
+   void schedule_and_validate_read_write(SCHED_FN sched_fn, const std::vector<read_write_transaction>& transactions, VALIDATORS ...validators) {
+      try {
+         auto signed_transactions = create_read_write_transactions(transactions);
+         auto pending = create_pending(signed_transactions);
+         auto schedule = sched_fn(pending, properties_policy.properties);
+         validate(schedule, validators...);
+      } FC_LOG_AND_RETHROW()
+   }
+
 private:
    template<typename VALIDATOR>
    void validate(const block_schedule& schedule, VALIDATOR validator) {
@@ -170,6 +196,12 @@ struct small_block_properties : public base_properties {
    }
 };
 
+struct large_block_properties : public base_properties {
+   large_block_properties() {
+      properties.configuration.maxBlockSize = config::DefaultMaxBlockSize;
+   }
+};
+
 typedef compose_fixture<default_properties> default_fixture;
 
 /*
@@ -190,6 +222,15 @@ static uint cycle_count(const block_schedule& schedule) {
    return schedule.cycles.size();
 }
 
+static uint max_thread_count(const block_schedule& schedule) {
+   uint result = 0;
+   for (const auto& c : schedule.cycles) {
+      result = std::max<uint>(result, c.size());
+   }
+
+   return result;
+}
+
 
 
 static bool schedule_is_valid(const block_schedule& schedule) {
@@ -223,6 +264,37 @@ static bool schedule_is_valid(const block_schedule& schedule) {
    return true;
 }
 
+// Within a cycle, a scope written by one thread may not be read or written by any other thread
+static bool schedule_respects_read_write_sets(const block_schedule& schedule) {
+   for (const auto& c : schedule.cycles) {
+      std::map<AccountName, std::set<size_t>> writers;
+      std::map<AccountName, std::set<size_t>> readers;
+      for (size_t t = 0; t < c.size(); t++) {
+         for (const auto& pt: c[t].transactions) {
+            for (const auto& s : pt.visit(scope_extracting_visitor())) {
+               writers[s].insert(t);
+            }
+            for (const auto& s : pt.visit(readscope_extracting_visitor())) {
+               readers[s].insert(t);
+            }
+         }
+      }
+
+      for (const auto& w : writers) {
+         auto threads = w.second;
+         auto r = readers.find(w.first);
+         if (r != readers.end()) {
+            threads.insert(r->second.begin(), r->second.end());
+         }
+         if (threads.size() > 1) {
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
 /*
  * Test Cases
  */
@@ -377,4 +449,202 @@ BOOST_FIXTURE_TEST_CASE(some_conflicts_shuffled, default_fixture) {
    }
 }
 
+BOOST_FIXTURE_TEST_CASE(read_write_sets_shared_readers, default_fixture) {
+   // transactions which only read a scope may run side by side, but not alongside a writer of it
+   schedule_and_validate_read_write(
+      block_schedule::by_read_write_sets,
+      {
+         {{0x1ULL}, {}},
+         {{0x2ULL}, {0x1ULL}},
+         {{0x3ULL}, {0x1ULL}},
+         {{0x4ULL}, {0x1ULL}},
+         {{0x1ULL}, {}}
+      },
+      EXPECT(schedule_respects_read_write_sets),
+      EXPECT(transaction_count, 5),
+      EXPECT(cycle_count, 3),
+      EXPECT(max_thread_count, 3)
+   );
+
+   schedule_and_validate_read_write(
+      block_schedule::by_read_write_sets,
+      {
+         {{0x2ULL}, {0x1ULL}},
+         {{0x3ULL}, {0x1ULL}},
+         {{0x4ULL}, {0x1ULL, 0x5ULL}},
+         {{0x6ULL}, {0x5ULL}},
+         {{}, {0x1ULL, 0x5ULL}}
+      },
+      EXPECT(schedule_respects_read_write_sets),
+      EXPECT(transaction_count, 5),
+      EXPECT(cycle_count, 1)
+   );
+}
+
+BOOST_FIXTURE_TEST_CASE(read_write_sets_shape, default_fixture) {
+   // conflicting transactions share a thread up to its share of the cost, then move on to the next cycle
+   schedule_and_validate_read_write(
+      block_schedule::by_read_write_sets_with(schedule_shape{2, 2}),
+      {
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}}
+      },
+      EXPECT(schedule_respects_read_write_sets),
+      EXPECT(transaction_count, 5),
+      EXPECT(cycle_count, 2),
+      EXPECT(max_thread_count, 1)
+   );
+
+   // transactions which do not fit in the allowed cycles are left for a later block
+   schedule_and_validate_read_write(
+      block_schedule::by_read_write_sets_with(schedule_shape{2, 1}),
+      {
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}},
+         {{0x1ULL}, {}}
+      },
+      EXPECT(schedule_respects_read_write_sets),
+      EXPECT(transaction_count, 3),
+      EXPECT(cycle_count, 1)
+   );
+
+   // independent transactions are spread evenly over the allowed threads
+   schedule_and_validate_read_write(
+      block_schedule::by_read_write_sets_with(schedule_shape{4, 1}),
+      {
+         {{0x1ULL}, {}}, {{0x2ULL}, {}}, {{0x3ULL}, {}}, {{0x4ULL}, {}},
+         {{0x5ULL}, {}}, {{0x6ULL}, {}}, {{0x7ULL}, {}}, {{0x8ULL}, {}}
+      },
+      EXPECT(schedule_respects_read_write_sets),
+      EXPECT(transaction_count, 8),
+      EXPECT(cycle_count, 1),
+      EXPECT(max_thread_count, 4)
+   );
+}
+
+BOOST_FIXTURE_TEST_CASE(read_write_sets_shuffled, default_fixture) {
+   // stochastically verify that the read/write set scheduler produces valid schedules for any arrival order
+   for (int i = 0; i < 1000; i++) {
+      schedule_and_validate_read_write(
+         shuffled(block_schedule::by_read_write_sets),
+         {
+            {{0x1ULL, 0x2ULL}, {0x10ULL}},
+            {{0x3ULL, 0x2ULL}, {0x10ULL}},
+            {{0x5ULL}, {0x1ULL, 0x10ULL}},
+            {{0x7ULL, 0x10ULL}, {}},
+            {{0x1ULL, 0x7ULL}, {0x5ULL}},
+            {{0x11ULL}, {0x2ULL}},
+            {{0x13ULL}, {0x2ULL, 0x3ULL}},
+            {{}, {0x7ULL, 0x11ULL}},
+            {{0x2ULL}, {0x13ULL}}
+         },
+         EXPECT(schedule_respects_read_write_sets),
+         EXPECT(transaction_count, 9)
+      );
+   }
+}
+
+/*
+ * Scheduling benchmark over synthetic workloads
+ *
+ * Reports the shape of the schedules each scheduler builds and the time taken to build them. The schedulers which
+ * only know about write scopes are given each transaction's read scopes as write scopes, as they would need to be for
+ * their schedules to be correct.
+ */
+struct synthetic_workload {
+   const char* name;
+   bool read_heavy;
+   std::vector<SignedTransaction> read_write;
+   std::vector<SignedTransaction> write_only;
+};
+
+static synthetic_workload make_workload(const char* name, size_t count, uint64_t accounts, uint64_t hot_accounts,
+                                        size_t writes, size_t reads) {
+   std::mt19937_64 rng(count * 31 + accounts * 7 + hot_accounts + writes * 3 + reads);
+   std::uniform_int_distribution<uint64_t> account(1, accounts);
+   std::uniform_int_distribution<uint64_t> hot_account(accounts + 1, accounts + std::max<uint64_t>(hot_accounts, 1));
+
+   synthetic_workload result{name, hot_accounts > 0 && reads > 0};
+   for (size_t i = 0; i < count; i++) {
+      std::set<AccountName> scope;
+      std::set<AccountName> readscope;
+      while (scope.size() < writes) {
+         scope.insert(account(rng));
+      }
+      while (readscope.size() < reads) {
+         readscope.insert(hot_accounts ? hot_account(rng) : account(rng));
+         for (const auto& s : scope) {
+            readscope.erase(s);
+         }
+      }
+
+      SignedTransaction rw;
+      rw.scope.assign(scope.begin(), scope.end());
+      rw.readscope.assign(readscope.begin(), readscope.end());
+      result.read_write.emplace_back(rw);
+
+      SignedTransaction wo;
+      scope.insert(readscope.begin(), readscope.end());
+      wo.scope.assign(scope.begin(), scope.end());
+      result.write_only.emplace_back(wo);
+   }
+
+   return result;
+}
+
+BOOST_FIXTURE_TEST_CASE(scheduler_benchmark, compose_fixture<large_block_properties>) {
+   std::vector<synthetic_workload> workloads;
+   workloads.emplace_back(make_workload("independent", 4000, 1000000, 0, 2, 0));
+   workloads.emplace_back(make_workload("hot reads", 4000, 1000000, 4, 1, 2));
+   workloads.emplace_back(make_workload("contended", 4000, 500, 0, 2, 0));
+   workloads.emplace_back(make_workload("contended reads", 4000, 500, 0, 1, 3));
+
+   large_block_properties large_block;
+   const auto& properties = large_block.properties;
+
+   struct scheduler_run {
+      const char* name;
+      block_schedule::factory scheduler;
+      bool read_write;
+   };
+   std::vector<scheduler_run> schedulers = {
+      {"by_threading_conflicts", block_schedule::by_threading_conflicts, false},
+      {"by_cycling_conflicts", block_schedule::by_cycling_conflicts, false},
+      {"by_read_write_sets", block_schedule::by_read_write_sets, true}
+   };
+
+   for (const auto& workload : workloads) {
+      auto read_write = create_pending(workload.read_write);
+      auto write_only = create_pending(workload.write_only);
+
+      std::map<std::string, uint> cycles;
+      for (const auto& run : schedulers) {
+         auto start = fc::time_point::now();
+         auto schedule = run.scheduler(run.read_write ? read_write : write_only, properties);
+         auto elapsed = fc::time_point::now() - start;
+
+         BOOST_TEST_MESSAGE(workload.name << ": " << run.name << " scheduled " << transaction_count(schedule)
+                            << " transactions in " << cycle_count(schedule) << " cycles of up to "
+                            << max_thread_count(schedule) << " threads in " << elapsed.count() << "us");
+         BOOST_CHECK_EQUAL(transaction_count(schedule), workload.read_write.size());
+         if (run.read_write) {
+            BOOST_CHECK(schedule_respects_read_write_sets(schedule));
+         } else {
+            BOOST_CHECK(schedule_is_valid(schedule));
+         }
+         cycles[run.name] = cycle_count(schedule);
+      }
+
+      // Readers of a hot scope have to be serialized by the schedulers which only know about writes
+      if (workload.read_heavy) {
+         BOOST_CHECK_LT(cycles["by_read_write_sets"], cycles["by_threading_conflicts"]);
+      }
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
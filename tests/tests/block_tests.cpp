@@ -43,6 +43,9 @@
 #include <WASM/WASM.h>
 #include <Runtime/Runtime.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace eos;
 using namespace chain;
 
@@ -336,6 +339,31 @@ BOOST_FIXTURE_TEST_CASE(forked_network, testing_fixture)
       BOOST_CHECK_EQUAL(chain1.head_block_id().str(), chain2.head_block_id().str());
 } FC_LOG_AND_RETHROW() }
 
+// Test that blocks arriving ahead of their parents are held until they link, then applied in order
+BOOST_FIXTURE_TEST_CASE(out_of_order_blocks, testing_fixture)
+{ try {
+      Make_Blockchains((chain1)(chain2))
+
+      chain1.produce_blocks(5);
+      BOOST_CHECK_EQUAL(chain1.head_block_num(), 5);
+
+      for (uint32_t num = 5; num > 1; --num) {
+         BOOST_CHECK_THROW(chain2.push_block(*chain1.fetch_block_by_number(num)), unlinkable_block_exception);
+         BOOST_CHECK_EQUAL(chain2.head_block_num(), 0);
+         BOOST_CHECK(chain2.is_known_block(chain1.fetch_block_by_number(num)->id()));
+      }
+
+      chain2.push_block(*chain1.fetch_block_by_number(1));
+      BOOST_CHECK_EQUAL(chain2.head_block_num(), 5);
+      BOOST_CHECK_EQUAL(chain1.head_block_id().str(), chain2.head_block_id().str());
+
+      // Both chains keep building on the same head
+      Make_Network(net, (chain1)(chain2))
+      chain1.produce_blocks();
+      BOOST_CHECK_EQUAL(chain2.head_block_num(), 6);
+      BOOST_CHECK_EQUAL(chain1.head_block_id().str(), chain2.head_block_id().str());
+} FC_LOG_AND_RETHROW() }
+
 // Check that the recent_slots_filled bitmap is being updated correctly
 BOOST_FIXTURE_TEST_CASE( rsf_missed_blocks, testing_fixture )
 { try {
@@ -536,6 +564,109 @@ BOOST_FIXTURE_TEST_CASE(reindex, testing_fixture)
       }
 } FC_LOG_AND_RETHROW() }
 
+// Test that the block log replays to the same state at every trust level
+BOOST_FIXTURE_TEST_CASE(replay_trust_levels, testing_fixture)
+{ try {
+      block_id_type head_id;
+      Asset alice_balance;
+      {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+
+         chain.produce_blocks(10);
+         Make_Account(chain, alice);
+         Transfer_Asset(chain, inita, alice, Asset(100));
+         chain.produce_blocks(100);
+         head_id = chain.get_block_id_for_num(chain.last_irreversible_block_num());
+         alice_balance = chain.get_liquid_balance("alice");
+      }
+
+      for (auto trust : {chain_controller::replay_trust::nothing,
+                         chain_controller::replay_trust::signatures,
+                         chain_controller::replay_trust::everything}) {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this, trust);
+
+         BOOST_CHECK_EQUAL(chain.head_block_id().str(), head_id.str());
+         BOOST_CHECK_NE((db.find<account_object, by_name>("alice")), nullptr);
+         BOOST_CHECK_EQUAL(chain.get_liquid_balance("alice"), alice_balance);
+      }
+
+      {
+         // Copy the log, changing the merkle root of its last block
+         block_log full_log(get_temp_dir("log"));
+         block_log log(get_temp_dir("corrupt_log"));
+         auto last = block_header::num_from_id(head_id);
+         for (uint32_t num = 1; num < last; ++num)
+            log.append(*full_log.read_block_by_num(num));
+         auto corrupt = *full_log.read_block_by_num(last);
+         corrupt.transaction_merkle_root = fc::digest("not the merkle root");
+         log.append(corrupt);
+      }
+
+      for (auto trust : {chain_controller::replay_trust::nothing,
+                         chain_controller::replay_trust::signatures}) {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("corrupt_log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         BOOST_CHECK_THROW(testing_blockchain(db, fdb, log, initr, *this, trust), fc::exception);
+      }
+} FC_LOG_AND_RETHROW() }
+
+// Test loading the chain state from a snapshot and replaying the rest of the block log on top of it
+BOOST_FIXTURE_TEST_CASE(snapshot_restore, testing_fixture)
+{ try {
+      auto snapshot_file = get_temp_dir("snapshot") / "state.bin";
+      block_id_type snapshot_id, head_id;
+      {
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log log(get_temp_dir("log"));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+
+         chain.produce_blocks(10);
+         Make_Account(chain, alice);
+         chain.produce_blocks(100);
+         snapshot_id = chain.get_block_id_for_num(chain.last_irreversible_block_num());
+         Make_Account(chain, bob);
+         chain.produce_blocks(100);
+         head_id = chain.get_block_id_for_num(chain.last_irreversible_block_num());
+      }
+      {
+         // Stop at the snapshot block by replaying from a log truncated there
+         chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+         block_log full_log(get_temp_dir("log"));
+         block_log log(get_temp_dir("partial_log"));
+         for (uint32_t num = 1; num <= block_header::num_from_id(snapshot_id); ++num)
+            log.append(*full_log.read_block_by_num(num));
+         fork_database fdb;
+         native_contract::native_contract_chain_initializer initr(genesis_state());
+         testing_blockchain chain(db, fdb, log, initr, *this);
+
+         BOOST_CHECK_EQUAL(chain.head_block_id().str(), snapshot_id.str());
+         chain.write_snapshot(snapshot_file);
+      }
+
+      chainbase::database db(get_temp_dir(), chainbase::database::read_write, TEST_DB_SIZE);
+      block_log log(get_temp_dir("log"));
+      fork_database fdb;
+      native_contract::native_contract_chain_initializer initr(genesis_state());
+      testing_blockchain chain(db, fdb, log, initr, *this, chain_controller::replay_trust::signatures, snapshot_file);
+
+      BOOST_CHECK_EQUAL(chain.head_block_id().str(), head_id.str());
+      BOOST_CHECK_NE((db.find<account_object, by_name>("alice")), nullptr);
+      BOOST_CHECK_NE((db.find<account_object, by_name>("bob")), nullptr);
+      chain.produce_blocks(10);
+} FC_LOG_AND_RETHROW() }
+
 // Test wiping a database and resyncing with an ongoing network
 BOOST_FIXTURE_TEST_CASE(wipe, testing_fixture)
 { try {
@@ -607,4 +738,73 @@ BOOST_FIXTURE_TEST_CASE(irrelevant_sig_soft_check, testing_fixture) {
    } FC_LOG_AND_RETHROW()
 }
 
+// Test reading packed blocks out of the block log while it is being appended to
+BOOST_FIXTURE_TEST_CASE(block_log_packed_reads, testing_fixture)
+{ try {
+      vector<signed_block> blocks(10);
+      for (int i = 0; i < blocks.size(); ++i) {
+         blocks[i].timestamp = fc::time_point_sec(i * config::BlockIntervalSeconds);
+         if (i > 0)
+            blocks[i].previous = blocks[i - 1].id();
+      }
+
+      {
+         block_log log(get_temp_dir("log"));
+         log.append(blocks[0]);
+         auto first = log.read_packed_block_by_num(1);
+         BOOST_REQUIRE(first.valid());
+
+         for (int i = 1; i < blocks.size(); ++i)
+            log.append(blocks[i]);
+
+         // The earlier read is still valid after the log has grown
+         BOOST_CHECK(first->unpack().id() == blocks[0].id());
+         BOOST_CHECK(!log.read_packed_block_by_num(blocks.size() + 1).valid());
+      }
+
+      block_log log(get_temp_dir("log"));
+      BOOST_REQUIRE(log.head().valid());
+      BOOST_CHECK(log.head()->id() == blocks.back().id());
+      for (int i = 0; i < blocks.size(); ++i) {
+         auto packed = log.read_packed_block_by_num(i + 1);
+         BOOST_REQUIRE(packed.valid());
+         BOOST_CHECK(vector<char>(packed->data, packed->data + packed->size) == fc::raw::pack(blocks[i]));
+         BOOST_CHECK(log.read_block_by_num(i + 1)->id() == blocks[i].id());
+      }
+} FC_LOG_AND_RETHROW() }
+
+// Test that every block read while another thread appends to the log is read whole and nothing past it
+BOOST_FIXTURE_TEST_CASE(block_log_concurrent_reads, testing_fixture)
+{ try {
+      vector<signed_block> blocks(200);
+      for (int i = 0; i < blocks.size(); ++i) {
+         blocks[i].timestamp = fc::time_point_sec(i * config::BlockIntervalSeconds);
+         if (i > 0)
+            blocks[i].previous = blocks[i - 1].id();
+      }
+
+      block_log log(get_temp_dir("log"));
+      std::atomic<bool> done(false);
+      uint32_t mismatches = 0;
+      std::thread reader([&] {
+         while (!done) {
+            for (uint32_t num = 1; num <= blocks.size(); ++num) {
+               auto packed = log.read_packed_block_by_num(num);
+               if (!packed)
+                  break;
+               if (vector<char>(packed->data, packed->data + packed->size) != fc::raw::pack(blocks[num - 1]))
+                  ++mismatches;
+            }
+         }
+      });
+
+      for (const auto& b : blocks)
+         log.append(b);
+      done = true;
+      reader.join();
+
+      BOOST_CHECK_EQUAL(mismatches, 0);
+      BOOST_CHECK(log.read_block_by_num(blocks.size())->id() == blocks.back().id());
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2017, Respective Authors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <eos/chain_plugin/chain_plugin.hpp>
+#include <eos/chain/chain_controller.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include "../common/database_fixture.hpp"
+
+namespace eos {
+using namespace chain;
+
+/**
+ * Reads the head block the way the read-only chain API calls do when served over HTTP: get_info and get_block, under
+ * the database read lock, as CHAIN_RO_CALL takes it
+ * @return false if the block returned is not the head block get_info reported
+ */
+static bool read_head_block(const testing_blockchain& chain, const chain_apis::read_only& api) {
+   return chain.get_database().with_read_lock([&]() {
+      auto info = api.get_info({});
+      auto block = api.get_block({fc::to_string(info.head_block_num)});
+      return block.id == info.head_block_id && block.block_num == info.head_block_num;
+   });
+}
+
+BOOST_AUTO_TEST_SUITE(chain_api_tests)
+
+// With http-threads=0, read-only calls are served on the application thread, in between blocks
+BOOST_FIXTURE_TEST_CASE(read_only_calls_inline, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain_apis::read_only api(chain);
+
+      for (int i = 0; i < 50; ++i) {
+         chain.produce_blocks();
+         BOOST_CHECK(read_head_block(chain, api));
+      }
+} FC_LOG_AND_RETHROW() }
+
+// With http-threads>0, read-only calls run on worker threads while blocks are produced and made irreversible
+BOOST_FIXTURE_TEST_CASE(read_only_calls_during_production, testing_fixture)
+{ try {
+      Make_Blockchain(chain);
+      chain_apis::read_only api(chain);
+      chain.produce_blocks();
+
+      const int http_threads = 2;
+      std::atomic<bool> producing{true};
+      std::atomic<uint32_t> reads{0}, failures{0};
+      vector<std::thread> workers;
+      for (int t = 0; t < http_threads; ++t)
+         workers.emplace_back([&]() {
+            while (producing) {
+               try {
+                  if (!read_head_block(chain, api))
+                     ++failures;
+               } catch (...) {
+                  ++failures;
+               }
+               ++reads;
+            }
+         });
+
+      chain.produce_blocks(100);
+      producing = false;
+      for (auto& worker : workers)
+         worker.join();
+
+      BOOST_CHECK_GT(chain.last_irreversible_block_num(), 0);
+      BOOST_CHECK_GT(reads.load(), 0);
+      BOOST_CHECK_EQUAL(failures.load(), 0);
+      BOOST_CHECK(read_head_block(chain, api));
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace eos
@@ -24,6 +24,7 @@
 
 #include <eos/chain/chain_controller.hpp>
 #include <eos/chain/account_object.hpp>
+#include <eos/chain/message_handling_contexts.hpp>
 
 #include <chainbase/chainbase.hpp>
 
@@ -87,4 +88,52 @@ BOOST_FIXTURE_TEST_CASE(get_blocks, testing_fixture)
       // Check that block 21 can now be found
       BOOST_CHECK_EQUAL(chain.get_block_id_for_num(21), chain.head_block_id());
 } FC_LOG_AND_RETHROW() }
+
+// Check that table cursors stay within their table and step past records removed from under them
+BOOST_FIXTURE_TEST_CASE(table_cursors, testing_fixture)
+{ try {
+      Make_Blockchain(chain)
+      Transaction trx;
+      trx.scope = {"inita"};
+      Message msg;
+      apply_context context(chain, chain.get_mutable_database(), trx, msg, "inita");
+
+      char value = 'x';
+      for (uint64_t key = 1; key <= 5; ++key) {
+         context.store_record<key_value_object>("inita", "inita", "orders", &key, &value, 1);
+         context.store_record<key_value_object>("inita", "inita", "trades", &key, &value, 1);
+      }
+
+      struct { uint64_t key; char value; } record;
+      record.key = 2;
+      auto handle = context.lower_bound_cursor<key_value_index, by_scope_primary>("inita", "inita", "orders", &record.key);
+      BOOST_REQUIRE(handle >= 0);
+      auto& cursor = context.get_cursor(handle);
+
+      BOOST_CHECK_EQUAL(cursor.read(reinterpret_cast<char*>(&record), 9), 9);
+      BOOST_CHECK_EQUAL(record.key, 2);
+      BOOST_CHECK_EQUAL(record.value, 'x');
+
+      uint64_t removed = 3;
+      context.remove_record<key_value_object>("inita", "inita", "orders", &removed, nullptr, 0);
+      BOOST_CHECK(cursor.next());
+      cursor.read(reinterpret_cast<char*>(&record), 9);
+      BOOST_CHECK_EQUAL(record.key, 4);
+
+      removed = 4;
+      context.remove_record<key_value_object>("inita", "inita", "orders", &removed, nullptr, 0);
+      BOOST_CHECK_EQUAL(cursor.read(reinterpret_cast<char*>(&record), 9), apply_context::record_cursor::record_removed);
+      BOOST_CHECK(cursor.previous());
+      cursor.read(reinterpret_cast<char*>(&record), 9);
+      BOOST_CHECK_EQUAL(record.key, 2);
+
+      BOOST_CHECK(cursor.next());
+      cursor.read(reinterpret_cast<char*>(&record), 9);
+      BOOST_CHECK_EQUAL(record.key, 5);
+      BOOST_CHECK(!cursor.next());
+      BOOST_CHECK_EQUAL(cursor.read(reinterpret_cast<char*>(&record), 9), apply_context::record_cursor::end_of_table);
+
+      context.close_cursor(handle);
+      BOOST_CHECK_THROW(context.get_cursor(handle), tx_unknown_argument);
+} FC_LOG_AND_RETHROW() }
 } // namespace eos
@@ -1,10 +1,19 @@
 #include <eos/chain/BlockchainConfiguration.hpp>
 #include <eos/chain/authority_checker.hpp>
 #include <eos/chain/authority.hpp>
+#include <eos/chain/exceptions.hpp>
+#include <eos/chain/merkle.hpp>
+#include <eos/chain/signature_cache.hpp>
+#include <eos/chain/transaction_pool.hpp>
+#include <eos/chain/wasm_interface.hpp>
+#include <eos/chain/worker_pool.hpp>
 
 #include <eos/utilities/key_conversion.hpp>
 #include <eos/utilities/rand.hpp>
 
+#include <eos/net_plugin/block_summary.hpp>
+#include <eos/utilities/rolling_bloom_filter.hpp>
+
 #include <fc/io/json.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -265,6 +274,274 @@ BOOST_AUTO_TEST_CASE(authority_checker)
    }
 } FC_LOG_AND_RETHROW() }
 
+/// Test that resolved authorities are evaluated in weight order, and that keys used by an unsatisfied authority are released
+BOOST_AUTO_TEST_CASE(authority_checker_resolved)
+{ try {
+   Make_Key(a);
+   auto& a = a_public_key;
+   Make_Key(b);
+   auto& b = b_public_key;
+   Make_Key(c);
+   auto& c = c_public_key;
+
+   auto R = resolved_authority(Complex_Authority(3, ((a, 1))((b, 3)), (("top", "top", 3))));
+   BOOST_REQUIRE_EQUAL(R.permissions.size(), 3);
+   BOOST_CHECK(R.permissions[0].contains<types::KeyPermissionWeight>());
+   BOOST_CHECK(R.permissions[1].contains<types::AccountPermissionWeight>());
+   BOOST_CHECK(R.permissions[2].contains<types::KeyPermissionWeight>());
+
+   // "top" needs both a and c, so with only a it fails, and must not leave a marked as used
+   auto top = std::make_shared<const resolved_authority>(Complex_Authority(2, ((a, 1))((c, 1)),));
+   auto GetTop = [top](const types::AccountPermission&) { return top; };
+   {
+      auto checker = MakeAuthorityChecker(GetTop, 2, {a});
+      BOOST_CHECK(!checker.satisfied(R));
+      BOOST_CHECK_EQUAL(checker.used_keys().size(), 0);
+   }
+   {
+      auto checker = MakeAuthorityChecker(GetTop, 2, {a, c});
+      BOOST_CHECK(checker.satisfied(R));
+      BOOST_CHECK(checker.all_keys_used());
+   }
+} FC_LOG_AND_RETHROW() }
+
+
+/// Test that the worker pool runs every task and reports failures deterministically
+BOOST_AUTO_TEST_CASE(worker_pool_for_each_index)
+{ try {
+   for (uint32_t threads : {0, 1, 4}) {
+      worker_pool pool(threads);
+      BOOST_CHECK_EQUAL(pool.size(), threads);
+
+      vector<int> hits(100, 0);
+      pool.for_each_index(hits.size(), [&](size_t i) { hits[i] += i; });
+      for (size_t i = 0; i < hits.size(); ++i)
+         BOOST_CHECK_EQUAL(hits[i], i);
+
+      BOOST_CHECK_EQUAL(pool.post([]() { return 42; }).get(), 42);
+
+      // The failure of the lowest index is reported, no matter which task failed first
+      try {
+         pool.for_each_index(hits.size(), [&](size_t i) {
+            if (i % 7 == 3)
+               FC_THROW_EXCEPTION(fc::assert_exception, "task ${i}", ("i", i));
+         });
+         BOOST_FAIL("exception was not rethrown");
+      } catch (const fc::assert_exception& e) {
+         BOOST_CHECK_EQUAL(e.get_log().front().get_data()["i"].as<size_t>(), 3);
+      }
+   }
+} FC_LOG_AND_RETHROW() }
+
+/// Test that every thread executes contracts in its own wasm_interface
+BOOST_AUTO_TEST_CASE(wasm_interface_per_thread)
+{ try {
+   auto& main = wasm_interface::get();
+   BOOST_CHECK_EQUAL(&main, &wasm_interface::get());
+
+   worker_pool pool(2);
+   auto first = pool.post([]() { return &wasm_interface::get(); }).get();
+   BOOST_CHECK(first != &main);
+   BOOST_CHECK(first->current_apply_context == nullptr);
+} FC_LOG_AND_RETHROW() }
+
+/// Test that recovered signing keys are cached by transaction id and only reused for identical signatures
+BOOST_AUTO_TEST_CASE(signature_cache_reuse)
+{ try {
+   Make_Key(a);
+   auto& a = a_private_key;
+   Make_Key(b);
+   auto& b = b_private_key;
+
+   SignedTransaction trx;
+   trx.scope = {N(inita)};
+   trx.sign(a, chain_id_type{});
+
+   worker_pool pool(2);
+   signature_cache cache(2);
+   cache.recover({std::cref(trx)}, pool, chain_id_type{});
+   BOOST_CHECK_EQUAL(cache.size(), 1);
+   BOOST_CHECK(cache.get_signature_keys(trx, chain_id_type{}) == trx.get_signature_keys(chain_id_type{}));
+
+   // Same id, different signatures: the cached keys must not be used
+   trx.sign(b, chain_id_type{});
+   auto keys = cache.get_signature_keys(trx, chain_id_type{});
+   BOOST_CHECK_EQUAL(keys.size(), 2);
+   BOOST_CHECK_EQUAL(keys.count(b_public_key), 1);
+   BOOST_CHECK_EQUAL(cache.size(), 1);
+
+   // The oldest entries are evicted once the cache is full
+   for (auto scope : {N(initb), N(initc)}) {
+      SignedTransaction other;
+      other.scope = {scope};
+      other.sign(a, chain_id_type{});
+      cache.get_signature_keys(other, chain_id_type{});
+   }
+   BOOST_CHECK_EQUAL(cache.size(), 2);
+} FC_LOG_AND_RETHROW() }
+
+/// Test that the incremental merkle tree matches the root calculated over all leaves at once
+BOOST_AUTO_TEST_CASE(incremental_merkle_root)
+{ try {
+   vector<digest_type> leaves;
+   incremental_merkle tree;
+   BOOST_CHECK_EQUAL(tree.get_root().str(), merkle(leaves).str());
+
+   for (int i = 0; i < 100; ++i) {
+      leaves.emplace_back(digest_type::hash(i));
+      tree.append(leaves.back());
+      BOOST_CHECK_EQUAL(tree.leaf_count(), leaves.size());
+      BOOST_REQUIRE_EQUAL(tree.get_root().str(), merkle(leaves).str());
+   }
+
+   BOOST_CHECK_EQUAL(merkle({leaves[0]}).str(), leaves[0].str());
+   BOOST_CHECK_EQUAL(merkle({leaves[0], leaves[1], leaves[2]}).str(),
+                     digest_type::hash(std::make_pair(digest_type::hash(std::make_pair(leaves[0], leaves[1])),
+                                                      digest_type::hash(std::make_pair(leaves[2], leaves[2])))).str());
+} FC_LOG_AND_RETHROW() }
+
+/// Test that the pending transaction pool drops included, expired and over-limit transactions
+BOOST_AUTO_TEST_CASE(transaction_pool_indexes)
+{ try {
+   auto make_trx = [](uint32_t expiration, vector<AccountName> scope) {
+      SignedTransaction trx;
+      trx.expiration = time_point_sec(expiration);
+      trx.scope = std::move(scope);
+      return trx;
+   };
+   vector<SignedTransaction> trxs = {
+      make_trx(10, {"alice"}), make_trx(20, {"bob"}), make_trx(30, {"alice", "carol"}), make_trx(40, {"dave"})
+   };
+
+   transaction_pool pool(3, 1024*1024);
+   for (int i = 0; i < 3; ++i)
+      BOOST_CHECK(pool.add(trxs[i], trxs[i].id()));
+   BOOST_CHECK(!pool.add(trxs[0], trxs[0].id()));
+   BOOST_CHECK_THROW(pool.add(trxs[3], trxs[3].id()), tx_resource_exhausted);
+
+   vector<transaction_id_type> order;
+   pool.visit_in_arrival_order([&](const transaction_pool::entry& e) { order.push_back(e.id); return true; });
+   BOOST_REQUIRE_EQUAL(order.size(), 3);
+   BOOST_CHECK(order[0] == trxs[0].id() && order[1] == trxs[1].id() && order[2] == trxs[2].id());
+
+   // A block including bob's transaction and writing to alice's scope
+   signed_block block;
+   block.cycles.emplace_back(cycle(1));
+   block.cycles[0][0].user_input.emplace_back(trxs[1]);
+   pool.remove_included(block, {trxs[1].id()});
+   BOOST_CHECK(!pool.contains(trxs[1].id()));
+   auto conflicting = pool.take_conflicting();
+   BOOST_REQUIRE_EQUAL(conflicting.size(), 0);
+
+   block.cycles[0][0].user_input[0].scope = {"alice"};
+   pool.remove_included(block, {});
+   conflicting = pool.take_conflicting();
+   BOOST_REQUIRE_EQUAL(conflicting.size(), 2);
+   BOOST_CHECK(conflicting[0] == trxs[0].id() && conflicting[1] == trxs[2].id());
+   BOOST_CHECK_EQUAL(pool.take_conflicting().size(), 0);
+
+   BOOST_CHECK_EQUAL(pool.remove_expired(time_point_sec(10)), 1);
+   BOOST_CHECK_EQUAL(pool.size(), 1);
+   BOOST_CHECK(pool.add(trxs[3], trxs[3].id()));
+   BOOST_CHECK_EQUAL(pool.packed_size(), fc::raw::pack_size(trxs[2]) + fc::raw::pack_size(trxs[3]));
+} FC_LOG_AND_RETHROW() }
+
+/// Test that the rolling bloom filter remembers recent items, forgets older generations and keeps its error rate
+BOOST_AUTO_TEST_CASE(rolling_bloom_filter_generations)
+{ try {
+   const uint32_t capacity = 1000;
+   const double false_positive_rate = 0.001;
+   auto id = [](uint64_t i) { return transaction_id_type::hash(i); };
+   utilities::rolling_bloom_filter filter(capacity, false_positive_rate, 1234);
+
+   // The last capacity inserts are always reported
+   uint32_t forgotten = 0;
+   for (uint64_t i = 0; i < 5 * capacity; ++i) {
+      filter.insert(id(i));
+      if (i % 100 == 0)
+         for (uint64_t j = (i >= capacity ? i - capacity + 1 : 0); j <= i; ++j)
+            forgotten += !filter.contains(id(j));
+   }
+   BOOST_CHECK_EQUAL(forgotten, 0);
+
+   // The generation before the previous one was dropped when the current one was started
+   uint32_t remembered = 0;
+   for (uint64_t i = 0; i < 3 * capacity; ++i)
+      remembered += filter.contains(id(i));
+   BOOST_CHECK_LT(remembered, capacity / 50);
+
+   // Ids that were never inserted are reported at about the configured rate
+   const uint32_t unseen = 200000;
+   uint32_t false_positives = 0;
+   for (uint64_t i = 0; i < unseen; ++i)
+      false_positives += filter.contains(id(10 * capacity + i));
+   BOOST_TEST_MESSAGE("false positive rate: " << double(false_positives) / unseen);
+   BOOST_CHECK_LT(false_positives, 2 * false_positive_rate * unseen);
+
+   filter.clear();
+   BOOST_CHECK(!filter.contains(id(5 * capacity - 1)));
+
+   // The size the net plugin uses by default for every peer
+   utilities::rolling_bloom_filter per_peer(100000, 1e-6, 1234);
+   BOOST_CHECK_GT(per_peer.memory_size(), 700 * 1024);
+   BOOST_CHECK_LT(per_peer.memory_size(), 800 * 1024);
+} FC_LOG_AND_RETHROW() }
+
+/// Test that a block is rebuilt from its summary, and that a wrongly matched transaction is caught by the merkle root
+BOOST_AUTO_TEST_CASE(block_summary_rebuild)
+{ try {
+   vector<SignedTransaction> trxs(4);
+   for (size_t i = 0; i < trxs.size(); ++i) {
+      trxs[i].expiration = time_point_sec(10 + i);
+      trxs[i].scope = {"alice"};
+   }
+
+   // Two cycles, the second with two threads
+   signed_block block;
+   block.cycles.emplace_back(cycle(1));
+   block.cycles.emplace_back(cycle(2));
+   block.cycles[0][0].user_input.emplace_back(trxs[0]);
+   block.cycles[1][0].user_input.emplace_back(trxs[1]);
+   block.cycles[1][1].user_input.emplace_back(trxs[2]);
+   block.transaction_merkle_root = block.calculate_merkle_root();
+
+   auto summary = make_block_summary(block);
+   BOOST_CHECK(summary.header.id() == block.id());
+   BOOST_REQUIRE_EQUAL(summary.cycles.size(), 2);
+   BOOST_REQUIRE_EQUAL(summary.cycles[1].size(), 2);
+   BOOST_CHECK_EQUAL(summary.cycles[1][1].user_input[0].short_id, short_trx_id(trxs[2].id()));
+
+   // The second transaction is not known here
+   std::unordered_map<uint64_t, const SignedTransaction*> known = {
+      {short_trx_id(trxs[0].id()), &trxs[0]}, {short_trx_id(trxs[2].id()), &trxs[2]}
+   };
+   auto pb = partial_block::rebuild(summary, known);
+   BOOST_REQUIRE_EQUAL(pb.missing.size(), 1);
+   BOOST_CHECK_EQUAL(pb.missing[0], 1);
+   BOOST_CHECK_EQUAL(pb.missing_ids[0], short_trx_id(trxs[1].id()));
+   BOOST_CHECK(!pb.matches_header());
+
+   auto wrong = pb;
+   BOOST_CHECK(!wrong.fill({trxs[3]}));
+   BOOST_CHECK(!wrong.fill({}));
+   BOOST_CHECK(wrong.missing.size() == 1);
+
+   BOOST_REQUIRE(pb.fill({trxs[1]}));
+   BOOST_CHECK(pb.matches_header());
+   BOOST_CHECK(pb.block.id() == block.id());
+   BOOST_CHECK(fc::raw::pack(pb.block) == fc::raw::pack(block));
+
+   // A short id taken by another transaction builds a block whose merkle root does not match, so the whole block
+   // is requested
+   known[short_trx_id(trxs[1].id())] = &trxs[3];
+   auto mismatched = partial_block::rebuild(summary, known);
+   BOOST_CHECK(mismatched.missing.empty());
+   BOOST_CHECK(!mismatched.matches_header());
+
+   // An ambiguous short id is asked for
+   known[short_trx_id(trxs[1].id())] = nullptr;
+   BOOST_CHECK_EQUAL(partial_block::rebuild(summary, known).missing.size(), 1);
+} FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
 
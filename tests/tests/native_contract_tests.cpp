@@ -567,4 +567,37 @@ BOOST_FIXTURE_TEST_CASE(auth_links, testing_fixture) { try {
                      }), tx_irrelevant_auth);
 } FC_LOG_AND_RETHROW() }
 
+//Test that authorities resolved from pending changes are forgotten when those changes are discarded
+BOOST_FIXTURE_TEST_CASE(auth_cache_undo, testing_fixture) { try {
+   Make_Blockchain(chain);
+   Make_Account(chain, alice);
+   Make_Account(chain, bob);
+   chain.produce_blocks();
+
+   Make_Key(k1);
+   Make_Key(k2);
+   Set_Authority(chain, alice, "spending", "active", Key_Authority(k1_public_key));
+   chain.produce_blocks();
+
+   SignedTransaction trx;
+   transaction_emplace_message(trx, config::EosContractName,
+                               vector<types::AccountPermission>{{"alice", "spending"}},
+                               "transfer", types::transfer{"alice", "bob", 10, ""});
+   flat_set<public_key_type> candidates = {k1_public_key, k2_public_key};
+   BOOST_CHECK(chain.get_required_keys(trx, candidates) == flat_set<public_key_type>{k1_public_key});
+
+   // Resolve the changed authority while the change is pending
+   Set_Authority(chain, alice, "spending", "active", Key_Authority(k2_public_key));
+   BOOST_CHECK(chain.get_required_keys(trx, candidates) == flat_set<public_key_type>{k2_public_key});
+
+   // Dropping the change brings the old authority back
+   chain.clear_pending();
+   BOOST_CHECK(chain.get_required_keys(trx, candidates) == flat_set<public_key_type>{k1_public_key});
+
+   // Changes that are kept are seen once they are in a block
+   Set_Authority(chain, alice, "spending", "active", Key_Authority(k2_public_key));
+   chain.produce_blocks();
+   BOOST_CHECK(chain.get_required_keys(trx, candidates) == flat_set<public_key_type>{k2_public_key});
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,162 @@
+#include <eos/chain/softfloat.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/multiprecision/cpp_bin_float.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace eos::chain::softfloat;
+
+namespace {
+   typedef boost::multiprecision::cpp_bin_float_50 DOUBLE;
+
+   double to_double(uint64_t u) { double d; memcpy(&d, &u, sizeof(d)); return d; }
+   uint64_t to_bits(double d) { uint64_t u; memcpy(&u, &d, sizeof(u)); return u; }
+   uint64_t canonical(uint64_t u) { return f64_is_nan(u)? canonical_nan : u; }
+
+   /// The intrinsics as they were computed before, with 50 digit multiprecision floats
+   uint64_t reference_add(uint64_t a, uint64_t b) {
+      return to_bits((DOUBLE(to_double(a)) + DOUBLE(to_double(b))).convert_to<double>());
+   }
+   uint64_t reference_mul(uint64_t a, uint64_t b) {
+      return to_bits((DOUBLE(to_double(a)) * DOUBLE(to_double(b))).convert_to<double>());
+   }
+   uint64_t reference_div(uint64_t a, uint64_t b) {
+      return to_bits((DOUBLE(to_double(a)) / DOUBLE(to_double(b))).convert_to<double>());
+   }
+
+   const uint64_t special_values[] = {
+      0x0000000000000000ull, 0x8000000000000000ull, // +-0
+      0x7ff0000000000000ull, 0xfff0000000000000ull, // +-inf
+      0x7ff8000000000000ull, 0xfff8000000000001ull, 0x7ff0000000000001ull, // NaNs
+      0x0000000000000001ull, 0x8000000000000001ull, 0x000fffffffffffffull, // subnormals
+      0x0010000000000000ull, 0x7fefffffffffffffull, 0xffefffffffffffffull, // smallest and largest normals
+      0x3ff0000000000000ull, 0xbff0000000000000ull, 0x3fe0000000000000ull, // 1, -1, 0.5
+      0x4340000000000000ull, 0x43f0000000000000ull, 0x4a60000000000000ull, 0x4a70000000000000ull // 2^53, 2^64, 2^167, 2^168
+   };
+
+   /// Random doubles biased toward the edges: specials, tiny and huge exponents, and short mantissas
+   struct double_generator {
+      std::mt19937_64 rng{42};
+
+      uint64_t operator()() {
+         switch (rng() % 6) {
+            case 0: return special_values[rng() % (sizeof(special_values) / sizeof(special_values[0]))];
+            case 1: return rng();
+            case 2: return with_exponent(0x3ff - 100 + rng() % 200);
+            case 3: return with_exponent(rng() % 60);
+            case 4: return with_exponent(0x7fe - rng() % 60);
+            default: return (with_exponent(0x3ff - 10 + rng() % 140) & 0xfffffffff0000000ull);
+         }
+      }
+      uint64_t with_exponent(uint64_t exponent) { return (rng() & 0x800fffffffffffffull) | (exponent << 52); }
+   };
+}
+
+BOOST_AUTO_TEST_SUITE(softfloat_tests)
+
+/// Test that the soft-float operations give the same bits as the multiprecision intrinsics they replace
+BOOST_AUTO_TEST_CASE(softfloat_matches_multiprecision)
+{
+   double_generator gen;
+   for (int i = 0; i < 200000; ++i) {
+      uint64_t a = gen(), b = gen();
+      if (i % 4 == 0)
+         b = (a & 0x7ff0000000000000ull) | (gen.rng() & 0x800fffffffffffffull);
+
+      BOOST_REQUIRE_EQUAL(f64_add(a, b), reference_add(a, b));
+      BOOST_REQUIRE_EQUAL(f64_mul(a, b), reference_mul(a, b));
+      if (!f64_is_zero(b))
+         BOOST_REQUIRE_EQUAL(f64_div(a, b), reference_div(a, b));
+
+      DOUBLE da(to_double(a)), db(to_double(b));
+      BOOST_REQUIRE_EQUAL(f64_lt(a, b), da < db);
+      BOOST_REQUIRE_EQUAL(f64_lt(b, a), da > db);
+      BOOST_REQUIRE_EQUAL(f64_eq(a, b), da == db);
+
+      int64_t n = int64_t(gen.rng()) >> (gen.rng() % 64);
+      BOOST_REQUIRE_EQUAL(i64_to_f64(n), to_bits(DOUBLE(n).convert_to<double>()));
+
+      if (f64_is_nan(a))
+         BOOST_REQUIRE_THROW(f64_to_ui64(a), fc::exception);
+      else
+         BOOST_REQUIRE_EQUAL(f64_to_ui64(a), da.convert_to<uint64_t>());
+   }
+}
+
+/// Test the operations the multiprecision intrinsics never had against the host, with NaNs made canonical
+BOOST_AUTO_TEST_CASE(softfloat_matches_ieee)
+{
+   double_generator gen;
+   for (int i = 0; i < 200000; ++i) {
+      uint64_t a = gen(), b = gen(), c = gen();
+      double da = to_double(a), db = to_double(b), dc = to_double(c);
+
+      BOOST_REQUIRE_EQUAL(f64_sub(a, b), canonical(to_bits(da - db)));
+      BOOST_REQUIRE_EQUAL(f64_sqrt(a), canonical(to_bits(std::sqrt(da))));
+      BOOST_REQUIRE_EQUAL(f64_le(a, b), da <= db);
+      BOOST_REQUIRE_EQUAL(f64_fma(a, b, c), canonical(to_bits(std::fma(da, db, dc))));
+
+      // Addends that nearly cancel the product exercise the wide intermediate
+      uint64_t cancel = (f64_mul(a, b) ^ 0x8000000000000000ull) ^ (gen.rng() & 7);
+      BOOST_REQUIRE_EQUAL(f64_fma(a, b, cancel), canonical(to_bits(std::fma(da, db, to_double(cancel)))));
+   }
+}
+
+BOOST_AUTO_TEST_CASE(softfloat_edge_cases)
+{
+   const uint64_t one = 0x3ff0000000000000ull, two = 0x4000000000000000ull;
+   const uint64_t inf = 0x7ff0000000000000ull, neg_zero = 0x8000000000000000ull;
+
+   BOOST_CHECK_EQUAL(f64_add(inf, inf ^ neg_zero), canonical_nan);
+   BOOST_CHECK_EQUAL(f64_mul(inf, 0), canonical_nan);
+   BOOST_CHECK_EQUAL(f64_div(0, 0), canonical_nan);
+   BOOST_CHECK_EQUAL(f64_sqrt(one ^ neg_zero), canonical_nan);
+   BOOST_CHECK_EQUAL(f64_sqrt(neg_zero), neg_zero);
+   BOOST_CHECK_EQUAL(f64_add(0xfff8000000000001ull, one), canonical_nan);
+   BOOST_CHECK_EQUAL(f64_sub(one, one), 0u);
+   BOOST_CHECK_EQUAL(f64_fma(one, two, one), 0x4008000000000000ull);
+
+   BOOST_CHECK(f64_eq(0, neg_zero));
+   BOOST_CHECK(!f64_eq(canonical_nan, canonical_nan));
+   BOOST_CHECK(!f64_lt(canonical_nan, one));
+   BOOST_CHECK(!f64_le(one, canonical_nan));
+
+   BOOST_CHECK_EQUAL(f64_to_ui64(0xc00c000000000000ull), 3u); // -3.5
+   BOOST_CHECK_EQUAL(f64_to_ui64(0x43f0000000000000ull), 0u); // 2^64 wraps
+   BOOST_CHECK_EQUAL(f64_to_ui64(0x4a70000000000000ull), UINT64_MAX); // 2^168 saturates
+   BOOST_CHECK_EQUAL(f64_to_ui64(inf), UINT64_MAX);
+   BOOST_CHECK_THROW(f64_to_ui64(canonical_nan), fc::exception);
+}
+
+/// Compare the cost of the soft-float operations with the multiprecision ones they replace
+BOOST_AUTO_TEST_CASE(softfloat_benchmark)
+{
+   const int count = 100000;
+   std::vector<uint64_t> values(count + 1);
+   double_generator gen;
+   for (auto& v : values)
+      v = gen.with_exponent(0x3ff - 30 + gen.rng() % 60);
+
+   auto measure = [&](const char* name, auto op) {
+      uint64_t sink = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < count; ++i)
+         sink ^= op(values[i], values[i + 1]);
+      auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      BOOST_TEST_MESSAGE(name << ": " << elapsed / count << " ns/op");
+      return sink;
+   };
+
+   BOOST_CHECK_EQUAL(measure("softfloat add", f64_add), measure("multiprecision add", reference_add));
+   BOOST_CHECK_EQUAL(measure("softfloat mul", f64_mul), measure("multiprecision mul", reference_mul));
+   BOOST_CHECK_EQUAL(measure("softfloat div", f64_div), measure("multiprecision div", reference_div));
+   measure("softfloat sqrt", [](uint64_t a, uint64_t) { return f64_sqrt(a); });
+}
+
+BOOST_AUTO_TEST_SUITE_END()